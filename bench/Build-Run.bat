@@ -0,0 +1,9 @@
+@echo off
+call Build.bat
+pause
+pushd ..
+for %%b in (bench\bin\*.exe) do (
+    echo %%b
+    %%b
+)
+popd
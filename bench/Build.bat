@@ -0,0 +1,29 @@
+@echo off
+if not exist bin\ (
+    mkdir bin 
+)
+pushd ..
+clang++ -std=c++20 -O2 -march=native -o bench/bin/gem-bench-affine.exe bench/affine.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-batch.exe bench/batch.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-bulk.exe bench/bulk.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -o bench/bin/gem-bench-bvh.exe bench/bvh.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-color.exe bench/color.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-expr.exe bench/expr.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-fast.exe bench/fast.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -o bench/bin/gem-bench-frustum.exe bench/frustum.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -o bench/bin/gem-bench-grid.exe bench/grid.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -o bench/bin/gem-bench-multiply.exe bench/multiply.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -o bench/bin/gem-bench-overlap.exe bench/overlap.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -o bench/bin/gem-bench-parallel.exe bench/parallel.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-precision.exe bench/precision.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-quaternion.exe bench/quaternion.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-raycast.exe bench/raycast.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-rotation.exe bench/rotation.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-simd.exe bench/simd.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -DGEM_NO_SIMD -o bench/bin/gem-bench-simd-scalar.exe bench/simd.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -o bench/bin/gem-bench-skinning.exe bench/skinning.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -ffp-contract=off -o bench/bin/gem-bench-srgb.exe bench/srgb.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -o bench/bin/gem-bench-suite.exe bench/suite.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -DGEM_NO_SIMD -o bench/bin/gem-bench-suite-scalar.exe bench/suite.cpp -Iinclude
+clang++ -std=c++20 -O2 -o bench/bin/gem-bench-compile-time.exe bench/compile_time.cpp
+popd
@@ -0,0 +1,102 @@
+// affine3 against mat4 for scene graph style transforms
+#include <gem_math.hpp>
+#include "bench.hpp"
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdio>
+
+static double max_difference(const gem::mat4<float>& a, const gem::mat4<float>& b)
+{
+    double worst = 0.0;
+    for (int i = 0; i < 16; i++)
+        worst = std::fmax(worst, std::abs(a.elements[i] - b.elements[i]));
+    return worst;
+}
+
+int main()
+{
+    const std::size_t count = 1 << 14;
+    const int iterations = 50;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> scale_dist(0.5f, 2.0f);
+
+    // Scale, then rotation, then translation
+    std::vector<gem::affine3<float>> affines(count), affine_out(count);
+    std::vector<gem::mat4<float>> mats(count), mat_out(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        gem::vec3<float> axis = gem::vec3<float>(dist(rng), dist(rng), dist(rng)).normalized();
+        gem::vec3<float> scale(scale_dist(rng), scale_dist(rng), scale_dist(rng));
+        gem::vec3<float> translation(dist(rng) * 10.0f, dist(rng) * 10.0f, dist(rng) * 10.0f);
+        float angle = dist(rng) * 180.0f;
+
+        affines[i] = gem::affine3<float>::scale(scale) * gem::affine3<float>::rotation(axis, angle) * gem::affine3<float>::translate(translation);
+        mats[i] = affines[i].to_mat4();
+    }
+
+    // Correctness against the full mat4 path
+    double product_error = 0.0, inverse_error = 0.0, scaled_error = 0.0;
+    bool roundtrip = true;
+    for (std::size_t i = 0; i + 1 < count; i++)
+    {
+        product_error = std::fmax(product_error, max_difference((affines[i] * affines[i + 1]).to_mat4(), mats[i] * mats[i + 1]));
+        inverse_error = std::fmax(inverse_error, max_difference(affines[i].inverse().to_mat4(), mats[i].inverse()));
+        scaled_error = std::fmax(scaled_error, max_difference(affines[i].inverse_scaled().to_mat4(), mats[i].inverse()));
+        if (gem::affine3<float>(mats[i]) != affines[i])
+            roundtrip = false;
+    }
+    std::printf("product max difference: %g\n", product_error);
+    std::printf("inverse max difference: %g\n", inverse_error);
+    std::printf("inverse_scaled max difference: %g\n", scaled_error);
+    std::printf("mat4 round trip: %s\n", roundtrip ? "exact" : "FAILED");
+
+    double ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i + 1 < count; i++)
+            mat_out[i] = mats[i] * mats[i + 1];
+        bench::do_not_optimize(mat_out);
+    });
+    bench::report("mat4 product", ns, count - 1);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i + 1 < count; i++)
+            affine_out[i] = affines[i] * affines[i + 1];
+        bench::do_not_optimize(affine_out);
+    });
+    bench::report("affine3 product", ns, count - 1);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            mat_out[i] = mats[i].inverse();
+        bench::do_not_optimize(mat_out);
+    });
+    bench::report("mat4 inverse", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            affine_out[i] = affines[i].inverse();
+        bench::do_not_optimize(affine_out);
+    });
+    bench::report("affine3 inverse", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            affine_out[i] = affines[i].inverse_scaled();
+        bench::do_not_optimize(affine_out);
+    });
+    bench::report("affine3 inverse_scaled", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            affine_out[i] = affines[i].inverse_orthonormal();
+        bench::do_not_optimize(affine_out);
+    });
+    bench::report("affine3 inverse_orthonormal", ns, count);
+
+    std::printf("sizeof mat4<float>: %zu, sizeof affine3<float>: %zu\n", sizeof(gem::mat4<float>), sizeof(gem::affine3<float>));
+
+    return product_error < 1e-3 && inverse_error < 1e-3 && scaled_error < 1e-3 && roundtrip ? 0 : 1;
+}
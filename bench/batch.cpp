@@ -0,0 +1,90 @@
+// Batch transform throughput, compares gem_batch.hpp against the per-element loop
+// Build with and without GEM_NO_SIMD to compare the SIMD kernels against the scalar fallback
+#include <gem_batch.hpp>
+#include "bench.hpp"
+
+#include <vector>
+#include <cstdio>
+
+int main()
+{
+    const std::size_t count = 1 << 20;
+    const int iterations = 20;
+
+    gem::mat4<float> mat = gem::mat4<float>::translate<float>({ 1.0f, 2.5f, -3.0f });
+    mat *= gem::mat4<float>::scale({ 2.0f, 0.5f, 1.5f });
+
+    std::vector<gem::vec4<float>> aos(count);
+    std::vector<gem::vec4<float>> aos_out(count);
+    std::vector<gem::vec3<float>> points(count);
+    std::vector<gem::vec3<float>> points_out(count);
+    std::vector<float> x(count), y(count), z(count), w(count);
+    std::vector<float> ox(count), oy(count), oz(count), ow(count);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        float f = static_cast<float>(i) * 0.001f;
+        aos[i] = gem::vec4<float>(f, f * 2.0f, -f, 1.0f);
+        points[i] = gem::vec3<float>(f, f * 2.0f, -f);
+        x[i] = f; y[i] = f * 2.0f; z[i] = -f; w[i] = 1.0f;
+    }
+
+    double ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            aos_out[i] = mat * aos[i];
+        bench::do_not_optimize(aos_out);
+    });
+    bench::report("vec4 per-element mat4 * vec4", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::transform(mat, aos, aos_out);
+        bench::do_not_optimize(aos_out);
+    });
+    bench::report("vec4 AoS gem::transform", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            gem::vec4<float> p = mat * gem::vec4<float>(points[i].x, points[i].y, points[i].z, 1.0f);
+            points_out[i] = gem::vec3<float>(p.x, p.y, p.z);
+        }
+        bench::do_not_optimize(points_out);
+    });
+    bench::report("vec3 per-element points", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::transform_points(mat, points, points_out);
+        bench::do_not_optimize(points_out);
+    });
+    bench::report("vec3 AoS gem::transform_points", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::transform(mat, gem::soa4<const float>{ x.data(), y.data(), z.data(), w.data(), count },
+                            gem::soa4<float>{ ox.data(), oy.data(), oz.data(), ow.data(), count });
+        bench::do_not_optimize(ox);
+    });
+    bench::report("vec4 SoA gem::transform", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::transform_points(mat, gem::soa3<const float>{ x.data(), y.data(), z.data(), count },
+                                   gem::soa3<float>{ ox.data(), oy.data(), oz.data(), count });
+        bench::do_not_optimize(ox);
+    });
+    bench::report("vec3 SoA gem::transform_points", ns, count);
+
+    // Check the batch results against the per-element reference
+    std::size_t mismatches = 0;
+    gem::transform(mat, aos, aos_out);
+    gem::transform_points(mat, points, points_out);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        gem::vec4<float> ref = mat * aos[i];
+        if (ref != aos_out[i] || ox[i] != ref.x || oy[i] != ref.y || oz[i] != ref.z)
+            mismatches++;
+        if (points_out[i] != gem::vec3<float>(ref.x, ref.y, ref.z))
+            mismatches++;
+    }
+    std::printf("mismatches against per-element loop: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_BENCH_HPP
+#define GEM_BENCH_HPP
+
+// Tiny timing helpers and the input generator shared by the benchmarks
+#include <gem_math.hpp>
+
+// std
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+namespace bench {
+
+    // Deterministic values in [-1, 1], the same sequence for a seed whatever T (24-bit steps, exact in float)
+    template<typename T>
+    struct lcg
+    {
+        std::uint32_t state;
+
+        T next()
+        {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<T>(state >> 8) / static_cast<T>(8388608) - static_cast<T>(1);
+        }
+
+        gem::vec2<T> next2(T scale) { return gem::vec2<T>(next() * scale, next() * scale); }
+        gem::vec3<T> next3(T scale) { return gem::vec3<T>(next() * scale, next() * scale, next() * scale); }
+    };
+
+    // Keeps the optimizer from discarding a result
+    template<typename T>
+    inline void do_not_optimize(const T& value)
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    // Runs fn `iterations` times and returns the best time in nanoseconds
+    template<typename Fn>
+    double best_of(int iterations, Fn&& fn)
+    {
+        double best = 1e300;
+        for (int i = 0; i < iterations; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            auto end = std::chrono::steady_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(end - start).count();
+            if (ns < best)
+                best = ns;
+        }
+        return best;
+    }
+
+    inline void report(const char* name, double ns, std::size_t elements)
+    {
+        std::printf("%-40s %10.3f ns/elem %10.2f M elem/s\n", name, ns / elements, elements / ns * 1e3);
+    }
+
+    // Same with the memory traffic, bytes read and written per element
+    inline void report_bandwidth(const char* name, double ns, std::size_t elements, std::size_t bytes)
+    {
+        std::printf("%-40s %10.3f ns/elem %10.2f GB/s\n", name, ns / elements, static_cast<double>(elements * bytes) / ns);
+    }
+
+    // Time stamp counter ticks per nanosecond, measured once against steady_clock, 0 without a counter
+    // Current x86 cores tick at a fixed reference rate, so ticks are close to core cycles but not equal under turbo
+    inline double ticks_per_ns()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        static const double ratio = [] {
+            auto start = std::chrono::steady_clock::now();
+            std::uint64_t ticks = __rdtsc();
+            double ns = 0.0;
+            while (ns < 2e7)
+                ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            return static_cast<double>(__rdtsc() - ticks) / ns;
+        }();
+        return ratio;
+#else
+        return 0.0;
+#endif
+    }
+
+}
+
+#endif // GEM_BENCH_HPP
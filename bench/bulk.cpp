@@ -0,0 +1,193 @@
+// Bulk vector algebra over 1M vec2, vec3 and vec4 in float and double, as in particle, cloth and boid updates
+// Times a plain per-element loop over the gem_math.hpp functions against gem_bulk.hpp on one thread and on every
+// hardware thread, and checks every element of every type against the loop. Build with -ffp-contract=off for the exact match
+#include <gem_bulk.hpp>
+#include "bench.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+namespace {
+
+    template<typename V>
+    constexpr int size()
+    {
+        return sizeof(V) / sizeof(V::x);
+    }
+
+    template<typename V>
+    V random_vector(bench::lcg<double>& rng, double scale)
+    {
+        V v;
+        for (int c = 0; c < size<V>(); c++)
+            (&v.x)[c] = static_cast<decltype(V::x)>(rng.next() * scale);
+        return v;
+    }
+
+    template<typename A, typename B>
+    std::size_t count_mismatches(const A& a, const B& b)
+    {
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < a.size(); i++)
+            mismatches += a[i] != b[i];
+        return mismatches;
+    }
+
+    // Times the loop, the bulk function on one thread and on every thread, returns the mismatches of both
+    template<typename Out, typename Loop, typename Bulk>
+    std::size_t measure(const char* type, const char* op, bool report, std::size_t bytes, int iterations, Out& loop_out, Out& bulk_out, Loop&& loop, Bulk&& bulk)
+    {
+        std::size_t count = loop_out.size();
+        char name[64];
+
+        double ns = bench::best_of(iterations, [&] { loop(); bench::do_not_optimize(loop_out); });
+        std::snprintf(name, sizeof(name), "%s %s loop", type, op);
+        if (report)
+            bench::report_bandwidth(name, ns, count, bytes);
+
+        ns = bench::best_of(iterations, [&] { bulk(gem::execution::seq); bench::do_not_optimize(bulk_out); });
+        std::snprintf(name, sizeof(name), "%s %s bulk", type, op);
+        if (report)
+            bench::report_bandwidth(name, ns, count, bytes);
+        std::size_t mismatches = count_mismatches(loop_out, bulk_out);
+
+        ns = bench::best_of(iterations, [&] { bulk(gem::execution::par); bench::do_not_optimize(bulk_out); });
+        std::snprintf(name, sizeof(name), "%s %s bulk threads", type, op);
+        if (report)
+            bench::report_bandwidth(name, ns, count, bytes);
+        return mismatches + count_mismatches(loop_out, bulk_out);
+    }
+
+    template<typename V>
+    std::size_t run(const char* type, std::size_t count, int iterations, bool report)
+    {
+        using T = decltype(V::x);
+
+        bench::lcg<double> rng{ 1234 };
+        std::vector<V> a(count), b(count), loop_out(count), bulk_out(count);
+        std::vector<T> loop_scalars(count), bulk_scalars(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            a[i] = random_vector<V>(rng, 100.0);
+            b[i] = random_vector<V>(rng, 1.0);
+        }
+        // Zero vectors for the normalize guard
+        for (std::size_t i = 0; i < count; i += 1001)
+            a[i] = V(T(0));
+        const T s = static_cast<T>(0.37), t = static_cast<T>(0.25);
+        const V point = random_vector<V>(rng, 10.0);
+
+        std::size_t mismatches = 0;
+        mismatches += measure(type, "axpy", report, 3 * sizeof(V), iterations, loop_out, bulk_out,
+            [&] { loop_out = b; for (std::size_t i = 0; i < count; i++) loop_out[i] += a[i] * s; },
+            [&](gem::execution::policy policy) { bulk_out = b; gem::axpy(s, a, bulk_out, policy); });
+
+        mismatches += measure(type, "scale", report, 2 * sizeof(V), iterations, loop_out, bulk_out,
+            [&] { for (std::size_t i = 0; i < count; i++) loop_out[i] = a[i] * s; },
+            [&](gem::execution::policy policy) { gem::scale(a, s, bulk_out, policy); });
+
+        mismatches += measure(type, "lerp", report, 3 * sizeof(V), iterations, loop_out, bulk_out,
+            [&] { for (std::size_t i = 0; i < count; i++) loop_out[i] = gem::lerp(a[i], b[i], t); },
+            [&](gem::execution::policy policy) { gem::lerp(a, b, t, bulk_out, policy); });
+
+        mismatches += measure(type, "normalize", report, 2 * sizeof(V), iterations, loop_out, bulk_out,
+            [&] { for (std::size_t i = 0; i < count; i++) loop_out[i] = a[i].normalized(); },
+            [&](gem::execution::policy policy) { gem::normalize(a, bulk_out, policy); });
+
+        mismatches += measure(type, "dot", report, 2 * sizeof(V) + sizeof(T), iterations, loop_scalars, bulk_scalars,
+            [&] { for (std::size_t i = 0; i < count; i++) loop_scalars[i] = gem::dot(a[i], b[i]); },
+            [&](gem::execution::policy policy) { gem::dot(a, b, bulk_scalars, policy); });
+
+        mismatches += measure(type, "distance", report, sizeof(V) + sizeof(T), iterations, loop_scalars, bulk_scalars,
+            [&] { for (std::size_t i = 0; i < count; i++) loop_scalars[i] = gem::distance(a[i], point); },
+            [&](gem::execution::policy policy) { gem::distance(a, point, bulk_scalars, policy); });
+
+        mismatches += measure(type, "distance_squared", report, sizeof(V) + sizeof(T), iterations, loop_scalars, bulk_scalars,
+            [&] { for (std::size_t i = 0; i < count; i++) loop_scalars[i] = gem::distance_squared(a[i], point); },
+            [&](gem::execution::policy policy) { gem::distance_squared(a, point, bulk_scalars, policy); });
+
+        if constexpr (size<V>() == 3)
+        {
+            mismatches += measure(type, "cross", report, 3 * sizeof(V), iterations, loop_out, bulk_out,
+                [&] { for (std::size_t i = 0; i < count; i++) loop_out[i] = gem::cross(a[i], b[i]); },
+                [&](gem::execution::policy policy) { gem::cross(a, b, bulk_out, policy); });
+        }
+
+        // In place, the output is also an input
+        loop_out = a;
+        bulk_out = a;
+        for (std::size_t i = 0; i < count; i++)
+            loop_out[i].normalize();
+        gem::normalize(bulk_out, bulk_out);
+        mismatches += count_mismatches(loop_out, bulk_out);
+
+        // Reductions, with NaN components that must be skipped
+        std::vector<V> extremes = a;
+        for (std::size_t i = 3; i < count; i += 4099)
+            (&extremes[i].x)[i % size<V>()] = std::numeric_limits<T>::quiet_NaN();
+        V lo(std::numeric_limits<T>::infinity()), hi(-std::numeric_limits<T>::infinity());
+        double ns = bench::best_of(iterations, [&] {
+            for (const V& v : extremes)
+                for (int c = 0; c < size<V>(); c++)
+                {
+                    (&lo.x)[c] = (&v.x)[c] < (&lo.x)[c] ? (&v.x)[c] : (&lo.x)[c];
+                    (&hi.x)[c] = (&v.x)[c] > (&hi.x)[c] ? (&v.x)[c] : (&hi.x)[c];
+                }
+            bench::do_not_optimize(lo);
+        });
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s min max loop", type);
+        if (report)
+            bench::report_bandwidth(name, ns, count, sizeof(V));
+
+        const gem::execution::policy policies[] = { gem::execution::seq, gem::execution::par };
+        for (const gem::execution::policy& policy : policies)
+        {
+            V bulk_lo, bulk_hi;
+            ns = bench::best_of(iterations, [&] {
+                bulk_lo = gem::min(extremes, policy);
+                bulk_hi = gem::max(extremes, policy);
+                bench::do_not_optimize(bulk_lo);
+            });
+            std::snprintf(name, sizeof(name), "%s min max bulk%s", type, policy.threads == 1 ? "" : " threads");
+            if (report)
+                bench::report_bandwidth(name, ns, count, sizeof(V));
+            mismatches += (bulk_lo != lo) + (bulk_hi != hi);
+        }
+        mismatches += gem::min(std::span<const V>()) != V(std::numeric_limits<T>::infinity());
+
+        // Short arrays, every tail length of every pack width
+        for (std::size_t n = 0; n < 20; n++)
+        {
+            std::vector<V> small(a.begin(), a.begin() + n), out(n);
+            gem::normalize(small, out);
+            for (std::size_t i = 0; i < n; i++)
+                mismatches += out[i] != small[i].normalized();
+        }
+
+        std::printf("%s mismatches: %zu\n", type, mismatches);
+        return mismatches;
+    }
+
+}
+
+int main()
+{
+    const std::size_t count = 1 << 20;
+    const int iterations = 10;
+
+    std::size_t mismatches = 0;
+    mismatches += run<gem::vec2<float>>("vec2<float>", count, iterations, false);
+    mismatches += run<gem::vec3<float>>("vec3<float>", count, iterations, true);
+    mismatches += run<gem::vec4<float>>("vec4<float>", count, iterations, false);
+    mismatches += run<gem::vec2<double>>("vec2<double>", count, iterations, false);
+    mismatches += run<gem::vec3<double>>("vec3<double>", count, iterations, true);
+    mismatches += run<gem::vec4<double>>("vec4<double>", count, iterations, false);
+
+    std::printf("mismatches against the loops: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+// BVH build and query throughput over 200k spheres, compared against linear scans
+// Reports build time on one thread and on every hardware thread, refit against rebuild, and checks
+// ray, overlap and nearest queries against brute force
+#include <gem_bvh.hpp>
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    gem::aabb bounds_of(const gem::sphere& sphere)
+    {
+        gem::vec3<float> r(sphere.radius);
+        return { sphere.position - r, sphere.position + r };
+    }
+
+}
+
+int main()
+{
+    const std::size_t count = 200000;
+    const std::size_t queries = 2000;
+    const int iterations = 5;
+
+    bench::lcg<float> rng{ 31337 };
+    std::vector<gem::sphere> spheres(count);
+    std::vector<gem::aabb> bounds(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        spheres[i] = { (rng.next() + 1.0f) * 0.5f + 0.1f, rng.next3(200.0f) };
+        bounds[i] = bounds_of(spheres[i]);
+    }
+
+    gem::bvh tree;
+    double ns = bench::best_of(iterations, [&] { tree.build(bounds, gem::execution::seq); });
+    std::printf("%-40s %10.3f ms\n", "build, 1 thread", ns * 1e-6);
+    ns = bench::best_of(iterations, [&] { tree.build(bounds); });
+    std::printf("%-40s %10.3f ms\n", "build, all threads", ns * 1e-6);
+    std::printf("nodes: %zu (%zu bytes each)\n", tree.nodes().size(), sizeof(gem::bvh::node));
+
+    std::size_t mismatches = 0;
+
+    // The parallel build splits the same way as the serial one, the layouts must match
+    gem::bvh serial(bounds, gem::execution::seq);
+    gem::bvh parallel(bounds, gem::execution::parallel_policy{ 8 });
+    mismatches += serial.nodes().size() != parallel.nodes().size();
+    for (std::size_t i = 0; i < serial.nodes().size() && i < parallel.nodes().size(); i++)
+    {
+        const gem::bvh::node& a = serial.nodes()[i];
+        const gem::bvh::node& b = parallel.nodes()[i];
+        mismatches += a.index != b.index || a.count != b.count || a.bounds.min != b.bounds.min || a.bounds.max != b.bounds.max;
+        mismatches += a.count > gem::bvh::max_leaf_size;
+    }
+
+    std::vector<gem::ray> rays(queries);
+    std::vector<gem::sphere> probes(queries);
+    for (std::size_t q = 0; q < queries; q++)
+    {
+        rays[q] = gem::ray(rng.next3(200.0f), rng.next3(1.0f));
+        probes[q] = { 5.0f, rng.next3(200.0f) };
+    }
+
+    // Closest ray hit
+    auto ray_sphere = [&](const gem::ray& ray, std::uint32_t i, float& t) {
+        float hit;
+        if (gem::raycast(ray, spheres[i], hit) && hit < t)
+        {
+            t = hit;
+            return true;
+        }
+        return false;
+    };
+
+    std::vector<std::uint32_t> tree_hits(queries), linear_hits(queries);
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t q = 0; q < queries; q++)
+        {
+            float t = std::numeric_limits<float>::infinity();
+            tree_hits[q] = tree.raycast(rays[q], t, [&](std::uint32_t i, float& t) { return ray_sphere(rays[q], i, t); });
+        }
+        bench::do_not_optimize(tree_hits);
+    });
+    bench::report("bvh::raycast", ns, queries);
+
+    ns = bench::best_of(1, [&] {
+        for (std::size_t q = 0; q < queries; q++)
+        {
+            float t = std::numeric_limits<float>::infinity();
+            linear_hits[q] = gem::bvh::invalid;
+            for (std::uint32_t i = 0; i < count; i++)
+            {
+                if (ray_sphere(rays[q], i, t))
+                    linear_hits[q] = i;
+            }
+        }
+        bench::do_not_optimize(linear_hits);
+    });
+    bench::report("linear raycast", ns, queries);
+    for (std::size_t q = 0; q < queries; q++)
+        mismatches += tree_hits[q] != linear_hits[q];
+
+    // Overlap, counted
+    std::vector<std::size_t> tree_counts(queries), linear_counts(queries);
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t q = 0; q < queries; q++)
+        {
+            tree_counts[q] = 0;
+            tree.overlap(probes[q], [&](std::uint32_t i) { tree_counts[q] += gem::sphere_in_sphere(probes[q], spheres[i]); });
+        }
+        bench::do_not_optimize(tree_counts);
+    });
+    bench::report("bvh::overlap(sphere)", ns, queries);
+
+    ns = bench::best_of(1, [&] {
+        for (std::size_t q = 0; q < queries; q++)
+        {
+            linear_counts[q] = 0;
+            for (std::uint32_t i = 0; i < count; i++)
+                linear_counts[q] += gem::sphere_in_sphere(probes[q], spheres[i]);
+        }
+        bench::do_not_optimize(linear_counts);
+    });
+    bench::report("linear sphere_in_sphere", ns, queries);
+    for (std::size_t q = 0; q < queries; q++)
+        mismatches += tree_counts[q] != linear_counts[q];
+
+    // Nearest sphere center
+    std::vector<float> tree_nearest(queries), linear_nearest(queries);
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t q = 0; q < queries; q++)
+        {
+            float d = std::numeric_limits<float>::infinity();
+            tree.nearest(probes[q].position, d, [&](std::uint32_t i) { return gem::distance_squared(probes[q].position, spheres[i].position); });
+            tree_nearest[q] = d;
+        }
+        bench::do_not_optimize(tree_nearest);
+    });
+    bench::report("bvh::nearest", ns, queries);
+
+    for (std::size_t q = 0; q < queries; q++)
+    {
+        float d = std::numeric_limits<float>::infinity();
+        for (std::uint32_t i = 0; i < count; i++)
+            d = std::min(d, gem::distance_squared(probes[q].position, spheres[i].position));
+        linear_nearest[q] = d;
+        mismatches += tree_nearest[q] != linear_nearest[q];
+    }
+
+    // Move everything a little, refit and query again
+    for (std::size_t i = 0; i < count; i++)
+    {
+        spheres[i].position = spheres[i].position + rng.next3(2.0f);
+        bounds[i] = bounds_of(spheres[i]);
+    }
+    ns = bench::best_of(iterations, [&] { tree.refit(bounds); });
+    std::printf("%-40s %10.3f ms\n", "refit", ns * 1e-6);
+
+    for (std::size_t q = 0; q < queries; q += 10)
+    {
+        std::size_t tree_count = 0, linear_count = 0;
+        tree.overlap(probes[q], [&](std::uint32_t i) { tree_count += gem::sphere_in_sphere(probes[q], spheres[i]); });
+        for (std::uint32_t i = 0; i < count; i++)
+            linear_count += gem::sphere_in_sphere(probes[q], spheres[i]);
+        mismatches += tree_count != linear_count;
+    }
+
+    std::printf("mismatches against linear scans: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+// Color batches over a 1024 x 1024 texture, as in runtime recoloring of textures and vertex colors
+// Reports the memory traffic of every batch next to a memcpy of the same bytes, and checks every pixel
+// against the scalar functions of gem_math.hpp. Build with -ffp-contract=off for the HSV exact match
+#include <gem_color.hpp>
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+    template<typename T>
+    std::size_t run_hsv(const char* type, std::size_t count, int iterations)
+    {
+        bench::lcg<double> rng{ 4242 };
+        std::vector<gem::vec4<T>> rgb(count), hsv(count), back(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            // A few exact grays and primaries among the random colors, for the delta == 0 and sector edge lanes
+            T r = static_cast<T>(rng.next() * 0.5 + 0.5), g = static_cast<T>(rng.next() * 0.5 + 0.5), b = static_cast<T>(rng.next() * 0.5 + 0.5);
+            if (i % 17 == 0)
+                g = b = r;
+            if (i % 23 == 0)
+                g = b = 0;
+            rgb[i] = gem::vec4<T>(r, g, b, static_cast<T>(rng.next() * 0.5 + 0.5));
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s rgb_to_hsv scalar", type);
+        double ns = bench::best_of(iterations, [&] {
+            for (std::size_t i = 0; i < count; i++)
+                hsv[i] = gem::rgb_to_hsv(rgb[i]);
+            bench::do_not_optimize(hsv);
+        });
+        bench::report_bandwidth(name, ns, count, 2 * sizeof(gem::vec4<T>));
+
+        std::snprintf(name, sizeof(name), "%s rgb_to_hsv batch", type);
+        ns = bench::best_of(iterations, [&] {
+            gem::rgb_to_hsv(rgb, hsv);
+            bench::do_not_optimize(hsv);
+        });
+        bench::report_bandwidth(name, ns, count, 2 * sizeof(gem::vec4<T>));
+
+        std::snprintf(name, sizeof(name), "%s hsv_to_rgb scalar", type);
+        ns = bench::best_of(iterations, [&] {
+            for (std::size_t i = 0; i < count; i++)
+                back[i] = gem::hsv_to_rgb(hsv[i]);
+            bench::do_not_optimize(back);
+        });
+        bench::report_bandwidth(name, ns, count, 2 * sizeof(gem::vec4<T>));
+
+        std::snprintf(name, sizeof(name), "%s hsv_to_rgb batch", type);
+        ns = bench::best_of(iterations, [&] {
+            gem::hsv_to_rgb(hsv, back);
+            bench::do_not_optimize(back);
+        });
+        bench::report_bandwidth(name, ns, count, 2 * sizeof(gem::vec4<T>));
+
+        std::size_t mismatches = 0;
+        double round_trip = 0.0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            mismatches += hsv[i] != gem::rgb_to_hsv(rgb[i]);
+            mismatches += back[i] != gem::hsv_to_rgb(hsv[i]);
+            for (int c = 0; c < 4; c++)
+            {
+                double d = static_cast<double>((&back[i].x)[c]) - static_cast<double>((&rgb[i].x)[c]);
+                round_trip = round_trip > (d < 0 ? -d : d) ? round_trip : (d < 0 ? -d : d);
+            }
+        }
+        std::printf("%s max round trip error: %g\n", type, round_trip);
+        return mismatches;
+    }
+
+}
+
+int main()
+{
+    const std::size_t width = 1024, height = 1024, count = width * height;
+    const int iterations = 20;
+
+    bench::lcg<double> rng{ 4242 };
+    std::vector<gem::u8vec4> pixels(count), packed(count);
+    std::vector<gem::vec4<float>> colors(count), hsv(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        auto byte = [&] { return static_cast<gem::uint8>(static_cast<std::uint32_t>((rng.next() + 1.0) * 128.0) & 0xff); };
+        pixels[i] = gem::u8vec4(byte(), byte(), byte(), byte());
+    }
+
+    // Bandwidth ceiling, the bytes one RGBA8 <-> float conversion reads and writes
+    double ns = bench::best_of(iterations, [&] {
+        std::memcpy(hsv.data(), colors.data(), count * sizeof(gem::vec4<float>));
+        bench::do_not_optimize(hsv);
+    });
+    bench::report_bandwidth("memcpy float pixels", ns, count, 2 * sizeof(gem::vec4<float>));
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            colors[i] = gem::rgb_to_normalized(pixels[i]);
+        bench::do_not_optimize(colors);
+    });
+    bench::report_bandwidth("rgb_to_normalized scalar", ns, count, sizeof(gem::u8vec4) + sizeof(gem::vec4<float>));
+
+    ns = bench::best_of(iterations, [&] {
+        gem::to_normalized(pixels, colors);
+        bench::do_not_optimize(colors);
+    });
+    bench::report_bandwidth("to_normalized", ns, count, sizeof(gem::u8vec4) + sizeof(gem::vec4<float>));
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            packed[i] = gem::normalized_to_rgb(colors[i]);
+        bench::do_not_optimize(packed);
+    });
+    bench::report_bandwidth("normalized_to_rgb scalar", ns, count, sizeof(gem::u8vec4) + sizeof(gem::vec4<float>));
+
+    ns = bench::best_of(iterations, [&] {
+        gem::to_rgba8(colors, packed);
+        bench::do_not_optimize(packed);
+    });
+    bench::report_bandwidth("to_rgba8", ns, count, sizeof(gem::u8vec4) + sizeof(gem::vec4<float>));
+
+    ns = bench::best_of(iterations, [&] {
+        gem::rgb_to_hsv(pixels, hsv);
+        bench::do_not_optimize(hsv);
+    });
+    bench::report_bandwidth("rgb_to_hsv RGBA8", ns, count, sizeof(gem::u8vec4) + sizeof(gem::vec4<float>));
+
+    ns = bench::best_of(iterations, [&] {
+        gem::hsv_to_rgb(hsv, packed);
+        bench::do_not_optimize(packed);
+    });
+    bench::report_bandwidth("hsv_to_rgb RGBA8", ns, count, sizeof(gem::u8vec4) + sizeof(gem::vec4<float>));
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        mismatches += colors[i] != gem::rgb_to_normalized(pixels[i]);
+        mismatches += hsv[i] != gem::rgb_to_hsv(gem::rgb_to_normalized(pixels[i]));
+        mismatches += packed[i] != gem::normalized_to_rgb(gem::hsv_to_rgb(hsv[i]));
+        mismatches += packed[i] != pixels[i];
+    }
+
+    // Out of range, NaN and halfway values, the rounding and clamping of the packs against the scalar function
+    const float edges[] = { -1.0f, -0.0f, 0.0f, 0.5f / 255.0f, 1.5f / 255.0f, 127.5f / 255.0f, 1.0f, 2.0f, NAN, INFINITY, -INFINITY, 0.25f };
+    std::vector<gem::vec4<float>> edge_colors;
+    for (float a : edges)
+        for (float b : edges)
+            edge_colors.push_back(gem::vec4<float>(a, b, b, a));
+    std::vector<gem::u8vec4> edge_packed(edge_colors.size());
+    gem::to_rgba8(edge_colors, edge_packed);
+    for (std::size_t i = 0; i < edge_colors.size(); i++)
+        mismatches += edge_packed[i] != gem::normalized_to_rgb(edge_colors[i]);
+
+    // A 1000 x 1000 region of the texture through image views, rows keep the 1024 pixel stride
+    std::vector<gem::vec4<float>> region(count);
+    gem::image_view<const gem::u8vec4> source{ pixels.data(), 1000, 1000, width };
+    gem::image_view<gem::vec4<float>> target{ region.data(), 1000, 1000, width };
+    gem::rgb_to_hsv(source, target);
+    for (std::size_t y = 0; y < height; y++)
+        for (std::size_t x = 0; x < width; x++)
+            mismatches += region[y * width + x] != (x < 1000 && y < 1000 ? hsv[y * width + x] : gem::vec4<float>());
+
+    mismatches += run_hsv<float>("float", count, iterations);
+    mismatches += run_hsv<double>("double", count, iterations);
+
+    std::printf("mismatches against scalar references: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+# Runs the SIMD and the GEM_NO_SIMD build of a benchmark and fails unless both print the same checksum line
+# cmake -DSIMD=<executable> -DSCALAR=<executable> -P compare_checksum.cmake
+
+foreach(build SIMD SCALAR)
+    execute_process(COMMAND ${${build}} OUTPUT_VARIABLE output RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${${build}} exited with ${result}")
+    endif()
+    string(REGEX MATCH "checksum: [^\n]*" ${build}_CHECKSUM "${output}")
+    if(NOT ${build}_CHECKSUM)
+        message(FATAL_ERROR "${${build}} printed no checksum")
+    endif()
+endforeach()
+
+if(NOT SIMD_CHECKSUM STREQUAL SCALAR_CHECKSUM)
+    message(FATAL_ERROR "SIMD ${SIMD_CHECKSUM}, scalar ${SCALAR_CHECKSUM}")
+endif()
+message(STATUS "${SIMD_CHECKSUM} in both builds")
@@ -0,0 +1,87 @@
+// Per translation unit compile cost of the different ways to consume gem
+// Usage: gem-bench-compile-time [compiler] [extra flags...], run from the repository root
+// The compiler defaults to $CXX, then clang++
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// Code that instantiates the commonly used members
+static const char* usage = R"(
+float use(const gem::vec3<float>& a, const gem::vec3<float>& b, const gem::mat4<float>& m, const gem::quaternion<float>& q)
+{
+    gem::vec3<float> c = (a + b) * 2.0f - a.normalized();
+    gem::mat4<float> n = (m * q.to_mat4()).inverse();
+    gem::vec4<float> v = n * gem::vec4<float>(c.x, c.y, c.z, 1.0f);
+    return v.magnitude() + gem::dot(a, b) + n.determinant();
+}
+)";
+
+struct translation_unit
+{
+    const char* name;
+    std::string source;
+};
+
+static double compile(const std::string& command, int runs)
+{
+    double best = 1e300;
+    for (int i = 0; i < runs; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (std::system(command.c_str()) != 0)
+            return -1.0;
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    const char* env = std::getenv("CXX");
+    std::string compiler = argc > 1 ? argv[1] : (env ? env : "clang++");
+    std::string flags = " -std=c++20 -O2 -c -Iinclude";
+    for (int i = 2; i < argc; i++)
+        flags += std::string(" ") + argv[i];
+
+    const int runs = 5;
+    fs::path dir = fs::temp_directory_path() / "gem-compile-time";
+    fs::create_directories(dir);
+
+    translation_unit units[] = {
+        { "empty translation unit", "int unused;\n" },
+        { "gem_fwd.hpp, declarations only", "#include <gem_fwd.hpp>\nfloat use(const gem::vec3<float>&, const gem::vec3<float>&, const gem::mat4<float>&, const gem::quaternion<float>&);\n" },
+        { "gem_math.hpp, include only", "#include <gem_math.hpp>\n" },
+        { "gem_math.hpp, implicit instantiation", std::string("#include <gem_math.hpp>\n") + usage },
+        { "gem_math.hpp, GEM_EXTERN_TEMPLATES", std::string("#define GEM_EXTERN_TEMPLATES\n#include <gem_math.hpp>\n") + usage },
+        { "gem_io.hpp, include only", "#include <gem_io.hpp>\n" },
+        { "gem_math.hpp, GEM_IMPLEMENTATION", "#define GEM_IMPLEMENTATION\n#include <gem_math.hpp>\n" },
+    };
+
+    std::printf("%-40s %10s\n", "translation unit", "ms");
+    int index = 0;
+    for (const translation_unit& unit : units)
+    {
+        fs::path source = dir / ("tu" + std::to_string(index) + ".cpp");
+        fs::path object = dir / ("tu" + std::to_string(index) + ".o");
+        std::ofstream(source) << unit.source;
+        index++;
+
+        double ms = compile(compiler + flags + " " + source.string() + " -o " + object.string(), runs);
+        if (ms < 0.0)
+        {
+            std::printf("%-40s %10s\n", unit.name, "failed");
+            continue;
+        }
+        std::printf("%-40s %10.1f\n", unit.name, ms);
+    }
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+// Expression templates over 1M particles: a chain of componentwise operations evaluated per element with the
+// eager operators, with the eager operators over whole arrays (one temporary array per operation), and as one
+// gem::expr expression. Checks every element of every expression against the eager loop
+// Build with -ffp-contract=off for the exact match
+#include <gem_expr.hpp>
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    // Element by element, op(a, b) into a new array, the way whole-array code without expressions does it
+    template<typename A, typename B, typename Op>
+    auto each(const A& a, const B& b, Op op)
+    {
+        std::vector<decltype(op(a[0], b[0]))> result(a.size());
+        for (std::size_t i = 0; i < a.size(); i++)
+            result[i] = op(a[i], b[i]);
+        return result;
+    }
+
+    template<typename T>
+    std::size_t run(const char* type, std::size_t count, int iterations)
+    {
+        using vec = gem::vec3<T>;
+
+        bench::lcg<double> rng{ 4242 };
+        auto random = [&] { return static_cast<T>(rng.next()); };
+        std::vector<vec> positions(count), velocities(count), forces(count);
+        std::vector<T> masses(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            positions[i] = vec(random(), random(), random()) * T(100);
+            velocities[i] = vec(random(), random(), random());
+            forces[i] = vec(random(), random(), random());
+            masses[i] = random() * T(0.5) + T(1);
+        }
+        const T dt = T(1) / T(60), drag = T(0.98);
+        const vec gravity(T(0), T(-9.81), T(0));
+
+        // next = p * 2 - previous + (f / m + g) * dt * dt, a Verlet step with the previous positions in velocities
+        std::vector<vec> eager(count), temporaries(count), fused(count);
+        char name[64];
+
+        std::snprintf(name, sizeof(name), "%s verlet eager loop", type);
+        double ns = bench::best_of(iterations, [&] {
+            for (std::size_t i = 0; i < count; i++)
+                eager[i] = positions[i] * T(2) - velocities[i] + (forces[i] / masses[i] + gravity) * dt * dt;
+            bench::do_not_optimize(eager);
+        });
+        bench::report_bandwidth(name, ns, count, 4 * sizeof(vec) + sizeof(T));
+
+        std::snprintf(name, sizeof(name), "%s verlet temporaries", type);
+        ns = bench::best_of(iterations, [&] {
+            auto twice = each(positions, positions, [](const vec& p, const vec&) { return p * T(2); });
+            auto moved = each(twice, velocities, [](const vec& a, const vec& b) { return a - b; });
+            auto accelerations = each(forces, masses, [](const vec& f, T m) { return f / m; });
+            auto pulled = each(accelerations, accelerations, [&](const vec& a, const vec&) { return a + gravity; });
+            auto scaled = each(pulled, pulled, [&](const vec& a, const vec&) { return a * dt * dt; });
+            temporaries = each(moved, scaled, [](const vec& a, const vec& b) { return a + b; });
+            bench::do_not_optimize(temporaries);
+        });
+        bench::report_bandwidth(name, ns, count, 4 * sizeof(vec) + sizeof(T));
+
+        std::snprintf(name, sizeof(name), "%s verlet gem::expr", type);
+        ns = bench::best_of(iterations, [&] {
+            using gem::expr::lazy;
+            lazy(fused) = lazy(positions) * T(2) - lazy(velocities) + (lazy(forces) / lazy(masses) + gravity) * dt * dt;
+            bench::do_not_optimize(fused);
+        });
+        bench::report_bandwidth(name, ns, count, 4 * sizeof(vec) + sizeof(T));
+
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < count; i++)
+            mismatches += (temporaries[i] != eager[i]) + (fused[i] != eager[i]);
+
+        // In place, v = v * drag + f * dt then p += v * dt, the destination is also an operand
+        std::vector<vec> eager_positions = positions, eager_velocities = velocities;
+        std::snprintf(name, sizeof(name), "%s euler in place eager loop", type);
+        ns = bench::best_of(iterations, [&] {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                eager_velocities[i] = eager_velocities[i] * drag + forces[i] * dt;
+                eager_positions[i] += eager_velocities[i] * dt;
+            }
+            bench::do_not_optimize(eager_positions);
+        });
+        bench::report_bandwidth(name, ns, count, 5 * sizeof(vec));
+
+        std::vector<vec> fused_positions = positions, fused_velocities = velocities;
+        std::snprintf(name, sizeof(name), "%s euler in place gem::expr", type);
+        ns = bench::best_of(iterations, [&] {
+            using gem::expr::lazy;
+            lazy(fused_velocities) = lazy(fused_velocities) * drag + lazy(forces) * dt;
+            lazy(fused_positions) += lazy(fused_velocities) * dt;
+            bench::do_not_optimize(fused_positions);
+        });
+        bench::report_bandwidth(name, ns, count, 5 * sizeof(vec));
+
+        for (std::size_t i = 0; i < count; i++)
+            mismatches += (fused_velocities[i] != eager_velocities[i]) + (fused_positions[i] != eager_positions[i]);
+
+        // Double literals, converted to the component type before the operation as the eager vecN<T> operators do.
+        // A literal on the left of a product is the same product as on the right
+        std::vector<vec> literal(count);
+        {
+            using gem::expr::lazy;
+            lazy(literal) = lazy(positions) * 0.1 + lazy(velocities) / 3.0 - 0.7 + 0.3 * lazy(forces);
+        }
+        for (std::size_t i = 0; i < count; i++)
+            mismatches += literal[i] != positions[i] * 0.1 + velocities[i] / 3.0 - 0.7 + forces[i] * 0.3;
+
+        std::printf("%s mismatches: %zu\n", type, mismatches);
+        return mismatches;
+    }
+
+    // Unnormalized blend of two orientation tracks, a * (1 - t) + b * t, a quaternion expression with a weight array
+    std::size_t run_blend(std::size_t count, int iterations)
+    {
+        using quat = gem::quaternion<float>;
+
+        bench::lcg<double> rng{ 4242 };
+        auto random = [&] { return static_cast<float>(rng.next()); };
+        std::vector<quat> a(count), b(count), eager(count), fused(count);
+        std::vector<float> weights(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            a[i] = quat(random(), random(), random(), random());
+            b[i] = quat(random(), random(), random(), random());
+            weights[i] = random() * 0.5f + 0.5f;
+        }
+
+        double ns = bench::best_of(iterations, [&] {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                quat left = a[i], right = b[i];
+                float keep = 1.0f - weights[i];
+                left.x *= keep; left.y *= keep; left.z *= keep; left.w *= keep;
+                right.x *= weights[i]; right.y *= weights[i]; right.z *= weights[i]; right.w *= weights[i];
+                eager[i] = left + right;
+            }
+            bench::do_not_optimize(eager);
+        });
+        bench::report_bandwidth("float quaternion blend eager loop", ns, count, 3 * sizeof(quat) + sizeof(float));
+
+        ns = bench::best_of(iterations, [&] {
+            using gem::expr::lazy;
+            lazy(fused) = lazy(a) * (1.0f - lazy(weights)) + lazy(b) * lazy(weights);
+            bench::do_not_optimize(fused);
+        });
+        bench::report_bandwidth("float quaternion blend gem::expr", ns, count, 3 * sizeof(quat) + sizeof(float));
+
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < count; i++)
+            mismatches += fused[i].x != eager[i].x || fused[i].y != eager[i].y || fused[i].z != eager[i].z || fused[i].w != eager[i].w;
+        std::printf("quaternion mismatches: %zu\n", mismatches);
+        return mismatches;
+    }
+
+}
+
+int main()
+{
+    const std::size_t count = 1 << 20;
+    const int iterations = 20;
+
+    // Expressions without arrays are constant expressions
+    constexpr gem::vec3<float> folded = gem::expr::evaluate(gem::expr::lazy(gem::vec3<float>(1.0f, 2.0f, 3.0f)) * 2.0f - 1.0f);
+    static_assert(folded == gem::vec3<float>(1.0f, 3.0f, 5.0f));
+
+    std::size_t mismatches = 0;
+    mismatches += run<float>("float", count, iterations);
+    mismatches += run<double>("double", count, iterations);
+    mismatches += run_blend(count, iterations);
+
+    std::printf("mismatches against eager operators: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
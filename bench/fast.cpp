@@ -0,0 +1,242 @@
+// Accuracy and throughput of the gem::fast tier against <cmath>
+// For every function and accuracy level reports the max error against a long double reference (in float
+// or double ulp and absolute, relative for rsqrt and rcp), ns per call for the pack kernels and for the std::
+// function, and checks that the SIMD lanes give the same values as the scalar overloads. Build with
+// -ffp-contract=off so the compiler does not fuse the scalar overloads differently from the packs
+#include <gem_math.hpp>
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    using gem::fast::accuracy;
+
+    template<typename T>
+    double ulp(long double reference)
+    {
+        T rounded = std::abs(static_cast<T>(reference));
+        return static_cast<double>(std::nextafter(rounded, static_cast<T>(INFINITY)) - rounded);
+    }
+
+    // fast(P x, P y) is the pack kernel, exact(T x, T y) the std:: function and reference(long double x, long double y)
+    // the exact value, unary functions ignore y
+    template<typename T, typename Fast, typename Exact, typename Reference>
+    std::size_t run(const char* name, const std::vector<T>& x, const std::vector<T>& y, bool relative, int iterations,
+                    Fast&& fast, Exact&& exact, Reference&& reference)
+    {
+        std::size_t count = x.size();
+        std::vector<T> out(count), expected(count);
+
+        double fast_ns = bench::best_of(iterations, [&] {
+            gem::simd::for_each_block<T>(count, [&]<typename P>(std::size_t i) {
+                fast(P::load(&x[i]), P::load(&y[i])).store(&out[i]);
+            });
+            bench::do_not_optimize(out);
+        });
+        double exact_ns = bench::best_of(iterations, [&] {
+            for (std::size_t i = 0; i < count; i++)
+                expected[i] = exact(x[i], y[i]);
+            bench::do_not_optimize(expected);
+        });
+
+        double max_ulp = 0.0, max_error = 0.0;
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            long double r = reference(static_cast<long double>(x[i]), static_cast<long double>(y[i]));
+            long double difference = std::abs(static_cast<long double>(out[i]) - r);
+            max_ulp = std::max(max_ulp, static_cast<double>(difference / ulp<T>(r)));
+            max_error = std::max(max_error, static_cast<double>(relative ? difference / std::abs(r) : difference));
+
+            T lane = fast(gem::simd::scalar<T>{ x[i] }, gem::simd::scalar<T>{ y[i] }).v;
+            mismatches += lane != out[i];
+        }
+
+        std::printf("%-24s %10.3g ulp %10.2e %-4s %8.3f ns/op %8.3f ns/op std\n", name, max_ulp, max_error, relative ? "rel" : "abs",
+                    fast_ns / count, exact_ns / count);
+        return mismatches;
+    }
+
+    template<typename T, accuracy A>
+    std::size_t run_all(const char* type, std::size_t count, int iterations)
+    {
+        bench::lcg<double> rng{ 2024 };
+        const char* level = A == accuracy::high ? "high" : "low";
+        const double range = sizeof(T) == 4 ? 8192.0 : 1.0e6;
+
+        // Half of the angles in [-pi, pi], the other half over the whole supported range
+        std::vector<T> angles(count), unit(count), positive(count), signed_positive(count), ax(count), ay(count), exponents(count), bases(count), powers(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            angles[i] = static_cast<T>(rng.next() * (i % 2 == 0 ? 3.14159265358979323846 : range));
+            unit[i] = static_cast<T>(rng.next());
+            positive[i] = static_cast<T>(std::ldexp(1.5 + rng.next() * 0.5, static_cast<int>(rng.next() * 40)));
+            signed_positive[i] = i % 2 == 0 ? positive[i] : -positive[i];
+            double scale = std::ldexp(1.0, static_cast<int>(rng.next() * 20));
+            ax[i] = static_cast<T>(rng.next() * scale);
+            ay[i] = static_cast<T>(rng.next() * scale);
+            exponents[i] = static_cast<T>(rng.next() * 100.0);
+            bases[i] = static_cast<T>(1.0 + rng.next());
+            powers[i] = static_cast<T>(rng.next() * 4.0);
+        }
+
+        char name[64];
+        std::size_t mismatches = 0;
+
+        std::snprintf(name, sizeof(name), "%s rsqrt %s", type, level);
+        mismatches += run<T>(name, positive, positive, true, iterations,
+            []<typename P>(P x, P) { return gem::fast::rsqrt<A>(x); },
+            [](T x, T) { return 1 / std::sqrt(x); },
+            [](long double x, long double) { return 1 / std::sqrt(x); });
+
+        std::snprintf(name, sizeof(name), "%s rcp %s", type, level);
+        mismatches += run<T>(name, signed_positive, signed_positive, true, iterations,
+            []<typename P>(P x, P) { return gem::fast::rcp<A>(x); },
+            [](T x, T) { return 1 / x; },
+            [](long double x, long double) { return 1 / x; });
+
+        std::snprintf(name, sizeof(name), "%s sin %s", type, level);
+        mismatches += run<T>(name, angles, angles, false, iterations,
+            []<typename P>(P x, P) { return gem::fast::sin<A>(x); },
+            [](T x, T) { return std::sin(x); },
+            [](long double x, long double) { return std::sin(x); });
+
+        std::snprintf(name, sizeof(name), "%s cos %s", type, level);
+        mismatches += run<T>(name, angles, angles, false, iterations,
+            []<typename P>(P x, P) { return gem::fast::cos<A>(x); },
+            [](T x, T) { return std::cos(x); },
+            [](long double x, long double) { return std::cos(x); });
+
+        std::snprintf(name, sizeof(name), "%s atan2 %s", type, level);
+        mismatches += run<T>(name, ay, ax, false, iterations,
+            []<typename P>(P y, P x) { return gem::fast::atan2<A>(y, x); },
+            [](T y, T x) { return std::atan2(y, x); },
+            [](long double y, long double x) { return std::atan2(y, x); });
+
+        std::snprintf(name, sizeof(name), "%s acos %s", type, level);
+        mismatches += run<T>(name, unit, unit, false, iterations,
+            []<typename P>(P x, P) { return gem::fast::acos<A>(x); },
+            [](T x, T) { return std::acos(x); },
+            [](long double x, long double) { return std::acos(x); });
+
+        std::snprintf(name, sizeof(name), "%s log2 %s", type, level);
+        mismatches += run<T>(name, positive, positive, false, iterations,
+            []<typename P>(P x, P) { return gem::fast::log2<A>(x); },
+            [](T x, T) { return std::log2(x); },
+            [](long double x, long double) { return std::log2(x); });
+
+        std::snprintf(name, sizeof(name), "%s exp2 %s", type, level);
+        mismatches += run<T>(name, exponents, exponents, true, iterations,
+            []<typename P>(P x, P) { return gem::fast::exp2<A>(x); },
+            [](T x, T) { return std::exp2(x); },
+            [](long double x, long double) { return std::exp2(x); });
+
+        // Bases in [0, 2] and powers in [-4, 4], the range of gamma curves and the sRGB transfer functions
+        std::snprintf(name, sizeof(name), "%s pow %s", type, level);
+        mismatches += run<T>(name, bases, powers, true, iterations,
+            []<typename P>(P x, P y) { return gem::fast::pow<A>(x, y); },
+            [](T x, T y) { return std::pow(x, y); },
+            [](long double x, long double y) { return std::pow(x, y); });
+
+        return mismatches;
+    }
+
+}
+
+int main()
+{
+    const std::size_t count = 1 << 20;
+    const int iterations = 10;
+
+    std::size_t mismatches = run_all<float, accuracy::high>("float", count, iterations);
+    mismatches += run_all<float, accuracy::low>("float", count, iterations);
+    mismatches += run_all<double, accuracy::high>("double", count, iterations);
+    mismatches += run_all<double, accuracy::low>("double", count, iterations);
+
+    // Helpers built on the tier, against their exact counterparts
+    bench::lcg<double> rng{ 2024 };
+    std::vector<gem::vec3<float>> a(count), b(count), normalized(count);
+    std::vector<gem::vec3<float>> euler(count);
+    std::vector<float> angles(count), fast_angles(count);
+    std::vector<gem::quaternion<float>> rotations(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        a[i] = gem::vec3<float>(rng.next(), rng.next(), rng.next()) * 10.0f;
+        b[i] = gem::vec3<float>(rng.next(), rng.next(), rng.next()) * 10.0f;
+        euler[i] = gem::vec3<float>(rng.next(), rng.next(), rng.next()) * 3.14159265f;
+    }
+
+    double ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            normalized[i] = a[i].normalized();
+        bench::do_not_optimize(normalized);
+    });
+    bench::report("vec3::normalized", ns, count);
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            normalized[i] = gem::normalize_fast(a[i]);
+        bench::do_not_optimize(normalized);
+    });
+    bench::report("normalize_fast", ns, count);
+
+    double normalize_error = 0.0;
+    for (std::size_t i = 0; i < count; i++)
+        normalize_error = std::max(normalize_error, static_cast<double>(gem::distance(normalized[i], a[i].normalized())));
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            angles[i] = gem::angle(a[i], b[i]);
+        bench::do_not_optimize(angles);
+    });
+    bench::report("angle", ns, count);
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            fast_angles[i] = gem::angle_fast(a[i], b[i]);
+        bench::do_not_optimize(fast_angles);
+    });
+    bench::report("angle_fast", ns, count);
+
+    // Both against the angle computed in double, most of the error comes from the float dot products near parallel vectors
+    double angle_error = 0.0, fast_angle_error = 0.0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        double d = static_cast<double>(a[i].x) * b[i].x + static_cast<double>(a[i].y) * b[i].y + static_cast<double>(a[i].z) * b[i].z;
+        double la = std::sqrt(static_cast<double>(a[i].x) * a[i].x + static_cast<double>(a[i].y) * a[i].y + static_cast<double>(a[i].z) * a[i].z);
+        double lb = std::sqrt(static_cast<double>(b[i].x) * b[i].x + static_cast<double>(b[i].y) * b[i].y + static_cast<double>(b[i].z) * b[i].z);
+        double expected = std::acos(std::clamp(d / (la * lb), -1.0, 1.0));
+        angle_error = std::max(angle_error, std::abs(angles[i] - expected));
+        fast_angle_error = std::max(fast_angle_error, std::abs(fast_angles[i] - expected));
+    }
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            rotations[i] = gem::quaternion<float>::from_euler_angles(euler[i]);
+        bench::do_not_optimize(rotations);
+    });
+    bench::report("from_euler_angles", ns, count);
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            rotations[i] = gem::quaternion<float>::from_euler_angles_fast(euler[i]);
+        bench::do_not_optimize(rotations);
+    });
+    bench::report("from_euler_angles_fast", ns, count);
+
+    double euler_error = 0.0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        gem::quaternion<float> q = gem::quaternion<float>::from_euler_angles(euler[i]);
+        euler_error = std::max({ euler_error, static_cast<double>(std::abs(q.x - rotations[i].x)), static_cast<double>(std::abs(q.y - rotations[i].y)),
+                                 static_cast<double>(std::abs(q.z - rotations[i].z)), static_cast<double>(std::abs(q.w - rotations[i].w)) });
+    }
+
+    std::printf("max error, normalize_fast: %g, angle: %g rad, angle_fast: %g rad, from_euler_angles_fast: %g\n", normalize_error, angle_error,
+                fast_angle_error, euler_error);
+    std::printf("mismatches between SIMD lanes and scalar overloads: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+// Frustum culling throughput, 1M spheres and boxes against a perspective view projection
+// Compares the batched gem::cull_spheres / gem::cull_aabbs against per-object tests
+#include <gem_frustum.hpp>
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+int main()
+{
+    const std::size_t count = 1 << 20;
+    const int iterations = 20;
+
+    // Camera at (0, 0, -50) looking down +z
+    gem::mat4<float> view = gem::mat4<float>::translate<float>({ 0.0f, 0.0f, 50.0f });
+    gem::mat4<float> projection = gem::mat4<float>::perspective(60.0f, 16.0f / 9.0f, 0.1f, 200.0f);
+    gem::frustum<float> frustum(view * projection);
+
+    bench::lcg<float> rng{ 4242 };
+    std::vector<gem::sphere> spheres(count);
+    std::vector<float> x(count), y(count), z(count), radius(count);
+    std::vector<float> max_x(count), max_y(count), max_z(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        float r = (rng.next() + 1.0f) * 2.0f;
+        gem::vec3<float> center(rng.next() * 150.0f, rng.next() * 150.0f, rng.next() * 150.0f);
+        if (i % 1009 == 0)
+            center.x = std::numeric_limits<float>::quiet_NaN(); // culled by the per-object tests and the kernels alike
+        spheres[i] = { r, center };
+        x[i] = center.x; y[i] = center.y; z[i] = center.z; radius[i] = r;
+        max_x[i] = center.x + r; max_y[i] = center.y + r; max_z[i] = center.z + r;
+    }
+
+    std::vector<std::uint32_t> visible(count), reference(count);
+    std::size_t reference_count = 0;
+    std::size_t visible_count = 0;
+
+    double ns = bench::best_of(iterations, [&] {
+        reference_count = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (frustum.intersects(spheres[i]))
+                reference[reference_count++] = static_cast<std::uint32_t>(i);
+        }
+        bench::do_not_optimize(reference);
+    });
+    bench::report("per-object frustum::intersects(sphere)", ns, count);
+
+    gem::soa4<const float> sphere_view = { x.data(), y.data(), z.data(), radius.data(), count };
+    ns = bench::best_of(iterations, [&] {
+        visible_count = gem::cull_spheres(frustum, sphere_view, visible);
+        bench::do_not_optimize(visible);
+    });
+    bench::report("gem::cull_spheres", ns, count);
+
+    std::size_t mismatches = visible_count != reference_count;
+    for (std::size_t i = 0; i < visible_count && i < reference_count; i++)
+        mismatches += visible[i] != reference[i];
+
+    // Boxes bounding the same spheres, min corner reuses the center streams shifted by the radius
+    std::vector<float> min_x(count), min_y(count), min_z(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        min_x[i] = x[i] - radius[i]; min_y[i] = y[i] - radius[i]; min_z[i] = z[i] - radius[i];
+    }
+
+    ns = bench::best_of(iterations, [&] {
+        reference_count = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (frustum.intersects_aabb({ min_x[i], min_y[i], min_z[i] }, { max_x[i], max_y[i], max_z[i] }))
+                reference[reference_count++] = static_cast<std::uint32_t>(i);
+        }
+        bench::do_not_optimize(reference);
+    });
+    bench::report("per-object frustum::intersects_aabb", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        visible_count = gem::cull_aabbs(frustum, gem::soa3<const float>{ min_x.data(), min_y.data(), min_z.data(), count },
+                                        gem::soa3<const float>{ max_x.data(), max_y.data(), max_z.data(), count }, visible);
+        bench::do_not_optimize(visible);
+    });
+    bench::report("gem::cull_aabbs", ns, count);
+
+    mismatches += visible_count != reference_count;
+    for (std::size_t i = 0; i < visible_count && i < reference_count; i++)
+        mismatches += visible[i] != reference[i];
+
+    std::printf("visible boxes: %zu of %zu, mismatches against per-object tests: %zu\n", visible_count, count, mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
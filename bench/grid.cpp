@@ -0,0 +1,148 @@
+// Spatial grid build and radius query throughput over 1M points, compared against linear scans
+// Reports build time on one thread and on every hardware thread, incremental updates against a
+// rebuild, and checks radius queries in 2D and 3D against point_in_circle / point_in_sphere
+#include <gem_grid.hpp>
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    // Sorted grid results against a linear scan with the scalar overlap test
+    template<typename Grid, typename Inside>
+    std::size_t check(const Grid& grid, const typename Grid::vec_type& center, float radius, Inside&& inside)
+    {
+        std::vector<std::uint32_t> found, expected;
+        grid.query(center, radius, [&](std::uint32_t i) { found.push_back(i); });
+        std::sort(found.begin(), found.end());
+
+        std::span<const typename Grid::vec_type> points = grid.points();
+        for (std::uint32_t i = 0; i < points.size(); i++)
+        {
+            if (inside(points[i]))
+                expected.push_back(i);
+        }
+        return found != expected;
+    }
+
+}
+
+int main()
+{
+    const std::size_t count = 1000000;
+    const std::size_t queries = 10000;
+    const int iterations = 5;
+    const float extent = 100.0f;
+    const float radius = 2.0f;
+
+    bench::lcg<float> rng{ 4242 };
+    std::vector<gem::vec3<float>> points(count);
+    for (gem::vec3<float>& p : points)
+        p = rng.next3(extent);
+
+    gem::grid3<float> grid(radius);
+    double ns = bench::best_of(iterations, [&] { grid.build(points, gem::execution::seq); });
+    std::printf("%-40s %10.3f ms\n", "build, 1 thread", ns * 1e-6);
+    ns = bench::best_of(iterations, [&] { grid.build(points); });
+    std::printf("%-40s %10.3f ms\n", "build, all threads", ns * 1e-6);
+    // Per thread storage does not grow with the point count, asking for far more threads than cores costs little
+    ns = bench::best_of(iterations, [&] { grid.build(points, gem::execution::parallel_policy{ 64 }); });
+    std::printf("%-40s %10.3f ms\n", "build, 64 threads", ns * 1e-6);
+
+    std::size_t mismatches = 0;
+
+    // The parallel build keeps point order inside buckets, queries report in the same order
+    gem::grid3<float> serial(radius), parallel(radius), wide(radius);
+    serial.build(points, gem::execution::seq);
+    parallel.build(points, gem::execution::parallel_policy{ 8 });
+    wide.build(points, gem::execution::parallel_policy{ 64 });
+
+    std::vector<gem::vec3<float>> centers(queries);
+    for (gem::vec3<float>& c : centers)
+        c = rng.next3(extent);
+
+    for (std::size_t q = 0; q < queries; q += 100)
+    {
+        std::vector<std::uint32_t> a, b;
+        serial.query(centers[q], radius, [&](std::uint32_t i) { a.push_back(i); });
+        parallel.query(centers[q], radius, [&](std::uint32_t i) { b.push_back(i); });
+        mismatches += a != b;
+        b.clear();
+        wide.query(centers[q], radius, [&](std::uint32_t i) { b.push_back(i); });
+        mismatches += a != b;
+    }
+
+    std::size_t total = 0;
+    ns = bench::best_of(iterations, [&] {
+        total = 0;
+        for (std::size_t q = 0; q < queries; q++)
+            grid.query(centers[q], radius, [&](std::uint32_t) { total++; });
+        bench::do_not_optimize(total);
+    });
+    bench::report("grid3::query", ns, queries);
+    std::printf("average hits per query: %.2f\n", static_cast<double>(total) / queries);
+
+    for (std::size_t q = 0; q < queries; q += 100)
+    {
+        gem::sphere probe = { radius, centers[q] };
+        mismatches += check(grid, centers[q], radius, [&](const gem::vec3<float>& p) { return gem::point_in_sphere(p, probe); });
+    }
+
+    // A small step per frame, most points stay in their cell
+    std::vector<gem::vec3<float>> stepped(count);
+    for (std::size_t i = 0; i < count; i++)
+        stepped[i] = points[i] + rng.next3(0.001f);
+    ns = bench::best_of(iterations, [&] { grid.update(stepped); });
+    std::printf("%-40s %10.3f ms\n", "update, small steps", ns * 1e-6);
+
+    for (std::size_t q = 0; q < queries; q += 100)
+    {
+        gem::sphere probe = { radius, centers[q] };
+        mismatches += check(grid, centers[q], radius, [&](const gem::vec3<float>& p) { return gem::point_in_sphere(p, probe); });
+    }
+
+    // Larger steps, enough points change cell to trigger a rebuild
+    for (std::size_t i = 0; i < count; i++)
+        stepped[i] = points[i] + rng.next3(0.5f);
+    ns = bench::best_of(iterations, [&] { grid.update(stepped); });
+    std::printf("%-40s %10.3f ms\n", "update, large steps", ns * 1e-6);
+
+    for (std::size_t q = 0; q < queries; q += 100)
+    {
+        gem::sphere probe = { radius, centers[q] };
+        mismatches += check(grid, centers[q], radius, [&](const gem::vec3<float>& p) { return gem::point_in_sphere(p, probe); });
+    }
+
+    // A few points teleporting, they go through the overflow list
+    grid.build(points, gem::execution::seq);
+    for (std::uint32_t i = 0; i < 500; i++)
+        grid.update(i * 1999, rng.next3(extent));
+    for (std::size_t q = 0; q < queries; q += 100)
+    {
+        gem::sphere probe = { radius, centers[q] };
+        mismatches += check(grid, centers[q], radius, [&](const gem::vec3<float>& p) { return gem::point_in_sphere(p, probe); });
+    }
+
+    // 2D
+    std::vector<gem::vec2<float>> points2(count);
+    for (gem::vec2<float>& p : points2)
+        p = rng.next2(extent);
+
+    gem::grid2<float> grid2(radius * 0.25f);
+    ns = bench::best_of(iterations, [&] { grid2.build(points2); });
+    std::printf("%-40s %10.3f ms\n", "grid2 build, all threads", ns * 1e-6);
+
+    for (std::size_t q = 0; q < queries; q += 100)
+    {
+        gem::vec2<float> center = rng.next2(extent);
+        gem::circle probe = { radius, center };
+        mismatches += check(grid2, center, radius, [&](const gem::vec2<float>& p) { return gem::point_in_circle(p, probe); });
+    }
+
+    std::printf("mismatches against linear scans: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// mat4 product throughput, checked against a double precision oracle
+#include <gem_batch.hpp>
+#include "bench.hpp"
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdio>
+
+// Reference product in double, same convention as mat4::product
+static void oracle(const gem::mat4<float>& a, const gem::mat4<float>& b, double* out)
+{
+    for (int y = 0; y < 4; y++)
+        for (int x = 0; x < 4; x++)
+        {
+            double sum = 0.0;
+            for (int e = 0; e < 4; e++)
+                sum += static_cast<double>(a.elements[x + e * 4]) * b.elements[e + y * 4];
+            out[x + y * 4] = sum;
+        }
+}
+
+// Error relative to the magnitude of the reference
+static double error(const gem::mat4<float>& m, const double* ref)
+{
+    double worst = 0.0;
+    for (int i = 0; i < 16; i++)
+    {
+        double err = std::abs(m.elements[i] - ref[i]) / (std::abs(ref[i]) + 1.0);
+        if (err > worst)
+            worst = err;
+    }
+    return worst;
+}
+
+int main()
+{
+    const std::size_t count = 1 << 14;
+    const int iterations = 50;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+
+    std::vector<gem::mat4<float>> a(count), b(count), c(count), out(count);
+    for (std::size_t i = 0; i < count; i++)
+        for (int e = 0; e < 16; e++)
+        {
+            a[i].elements[e] = dist(rng);
+            b[i].elements[e] = dist(rng);
+            c[i].elements[e] = dist(rng);
+        }
+
+    // Correctness
+    double worst = 0.0;
+    bool chain_ok = true;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        double ref[16];
+        oracle(a[i], b[i], ref);
+        double err = error(a[i] * b[i], ref);
+        if (err > worst)
+            worst = err;
+
+        // In place multiply with itself must not alias
+        gem::mat4<float> self = a[i];
+        self *= self;
+        oracle(a[i], a[i], ref);
+        err = error(self, ref);
+        if (err > worst)
+            worst = err;
+
+        gem::mat4<float> chain = gem::mat4<float>::concat(a[i], b[i], c[i]);
+        gem::mat4<float> list[3] = { a[i], b[i], c[i] };
+        if (chain != (a[i] * b[i]) * c[i] || chain != gem::mat4<float>::multiply_chain(list))
+            chain_ok = false;
+
+        // left * right applies left first
+        gem::vec4<float> v(dist(rng), dist(rng), dist(rng), 1.0f);
+        gem::vec4<float> composed = (a[i] * b[i]) * v;
+        gem::vec4<float> stepwise = b[i] * (a[i] * v);
+        if ((composed - stepwise).magnitude() > 1e-3f * (stepwise.magnitude() + 1.0f))
+            chain_ok = false;
+    }
+    std::printf("max relative error vs double oracle: %g\n", worst);
+    std::printf("chain and composition order: %s\n", chain_ok ? "ok" : "FAILED");
+
+    // Throughput
+    double ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = a[i] * b[i];
+        bench::do_not_optimize(out);
+    });
+    bench::report("mat4 operator*", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            out[i] = a[i];
+            out[i] *= b[i];
+        }
+        bench::do_not_optimize(out);
+    });
+    bench::report("mat4 operator*=", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = gem::mat4<float>::concat(a[i], b[i], c[i]);
+        bench::do_not_optimize(out);
+    });
+    bench::report("mat4 concat (3 matrices)", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::concat(a, b[0], out);
+        bench::do_not_optimize(out);
+    });
+    bench::report("gem::concat models * view_projection", ns, count);
+
+    return worst < 1e-5 && chain_ok ? 0 : 1;
+}
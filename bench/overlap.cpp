@@ -0,0 +1,128 @@
+// Sphere and circle overlap throughput, one query against 1M packed bounds and 2k x 2k pairs
+// Compares the batch kernels against the per-pair tests, with and without the sqrt in distance()
+#include <gem_batch.hpp>
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+int main()
+{
+    const std::size_t count = 1 << 20;
+    const std::size_t pair_count = 2048;
+    const int iterations = 20;
+
+    bench::lcg<float> rng{ 99 };
+    std::vector<gem::sphere> spheres(count);
+    std::vector<gem::circle> circles(count);
+    std::vector<float> x(count), y(count), z(count), radius(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        x[i] = rng.next() * 100.0f; y[i] = rng.next() * 100.0f; z[i] = rng.next() * 100.0f;
+        radius[i] = (rng.next() + 1.0f) * 2.0f;
+        spheres[i] = { radius[i], { x[i], y[i], z[i] } };
+        circles[i] = { radius[i], { x[i], y[i] } };
+    }
+    gem::soa4<const float> sphere_view = { x.data(), y.data(), z.data(), radius.data(), count };
+    gem::soa3<const float> circle_view = { x.data(), y.data(), radius.data(), count };
+
+    gem::sphere query = { 20.0f, { 10.0f, -5.0f, 3.0f } };
+    gem::circle query_circle = { 5.0f, { 10.0f, -5.0f } };
+    std::vector<std::uint32_t> hits(count), reference(count);
+    std::vector<std::uint64_t> mask((count + 63) / 64);
+    std::size_t hit_count = 0, reference_count = 0;
+
+    double ns = bench::best_of(iterations, [&] {
+        reference_count = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (gem::distance(query.position, spheres[i].position) <= query.radius + spheres[i].radius)
+                reference[reference_count++] = static_cast<std::uint32_t>(i);
+        }
+        bench::do_not_optimize(reference);
+    });
+    bench::report("per-pair distance() <= r", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        reference_count = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (gem::sphere_in_sphere(query, spheres[i]))
+                reference[reference_count++] = static_cast<std::uint32_t>(i);
+        }
+        bench::do_not_optimize(reference);
+    });
+    bench::report("per-pair gem::sphere_in_sphere", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        hit_count = gem::sphere_in_spheres(query, sphere_view, hits);
+        bench::do_not_optimize(hits);
+    });
+    bench::report("gem::sphere_in_spheres hit list", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::sphere_in_spheres(query, sphere_view, mask);
+        bench::do_not_optimize(mask);
+    });
+    bench::report("gem::sphere_in_spheres bitmask", ns, count);
+
+    // Hit lists are sorted, walk them next to the per-pair test
+    std::size_t mismatches = hit_count != reference_count;
+    for (std::size_t h = 0, i = 0; i < count; i++)
+    {
+        bool hit = h < hit_count && hits[h] == i;
+        h += hit;
+        mismatches += hit != gem::sphere_in_sphere(query, spheres[i]);
+        mismatches += static_cast<bool>((mask[i / 64] >> (i % 64)) & 1) != hit;
+    }
+
+    ns = bench::best_of(iterations, [&] {
+        hit_count = gem::circle_in_circles(query_circle, circle_view, hits);
+        bench::do_not_optimize(hits);
+    });
+    bench::report("gem::circle_in_circles hit list", ns, count);
+    for (std::size_t h = 0, i = 0; i < count; i++)
+    {
+        bool hit = h < hit_count && hits[h] == i;
+        h += hit;
+        mismatches += hit != gem::circle_in_circle(query_circle, circles[i]);
+    }
+
+    gem::point_in_spheres(query.position, sphere_view, mask);
+    for (std::size_t i = 0; i < count; i++)
+        mismatches += static_cast<bool>((mask[i / 64] >> (i % 64)) & 1) != gem::point_in_sphere(query.position, spheres[i]);
+    gem::point_in_circles(query_circle.position, circle_view, mask);
+    for (std::size_t i = 0; i < count; i++)
+        mismatches += static_cast<bool>((mask[i / 64] >> (i % 64)) & 1) != gem::point_in_circle(query_circle.position, circles[i]);
+
+    // Pairwise, the first pair_count bounds against the next pair_count
+    gem::soa4<const float> a = { x.data(), y.data(), z.data(), radius.data(), pair_count };
+    gem::soa4<const float> b = { x.data() + pair_count, y.data() + pair_count, z.data() + pair_count, radius.data() + pair_count, pair_count };
+    std::vector<gem::index_pair> pairs(pair_count * 16);
+    std::size_t pair_hits = 0;
+    ns = bench::best_of(iterations, [&] {
+        pair_hits = gem::sphere_pairs(a, b, pairs);
+        bench::do_not_optimize(pairs);
+    });
+    bench::report("gem::sphere_pairs", ns, pair_count * pair_count);
+
+    std::size_t reference_pairs = 0;
+    for (std::size_t i = 0; i < pair_count; i++)
+    {
+        for (std::size_t j = 0; j < pair_count; j++)
+        {
+            if (gem::sphere_in_sphere(spheres[i], spheres[pair_count + j]))
+            {
+                if (reference_pairs < pairs.size())
+                    mismatches += pairs[reference_pairs].first != i || pairs[reference_pairs].second != j;
+                reference_pairs++;
+            }
+        }
+    }
+    mismatches += reference_pairs != pair_hits;
+
+    std::printf("sphere hits: %zu, pairs: %zu, mismatches against per-pair tests: %zu\n", reference_count, pair_hits, mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+// Job system scaling, 2M elements through bulk normalize, transform_points, srgb_to_linear and cull_spheres on
+// 1, 2, 4, ... threads up to the hardware thread count (at least 4), reported as time and speedup over seq.
+// Checks every policy against seq, that uneven work is spread by stealing, and that batches started from inside
+// a job or from several threads at once finish with the same results
+#include <gem_bulk.hpp>
+#include <gem_batch.hpp>
+#include <gem_color.hpp>
+#include <gem_frustum.hpp>
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    std::vector<std::uint32_t> thread_counts()
+    {
+        std::uint32_t most = std::max(4u, std::thread::hardware_concurrency());
+        std::vector<std::uint32_t> counts;
+        for (std::uint32_t threads = 1; threads < most; threads *= 2)
+            counts.push_back(threads);
+        counts.push_back(most);
+        return counts;
+    }
+
+    // Times batch(seq) and batch(par with each thread count), returns the mismatches of every run against seq
+    template<typename Result, typename Batch>
+    std::size_t scale(const char* name, int iterations, Result& out, Batch&& batch)
+    {
+        double seq = bench::best_of(iterations, [&] { batch(gem::execution::seq); bench::do_not_optimize(out); });
+        std::printf("%-32s seq %10.3f ms\n", name, seq * 1e-6);
+        const Result expected = out;
+
+        std::size_t mismatches = 0;
+        for (std::uint32_t threads : thread_counts())
+        {
+            std::fill(out.begin(), out.end(), typename Result::value_type{});
+            double ns = bench::best_of(iterations, [&] { batch(gem::execution::parallel_policy{ threads }); bench::do_not_optimize(out); });
+            std::printf("%-32s %3u threads %10.3f ms %6.2fx\n", name, threads, ns * 1e-6, seq / ns);
+            for (std::size_t i = 0; i < out.size(); i++)
+                mismatches += out[i] != expected[i];
+        }
+        return mismatches;
+    }
+
+    // Work proportional to the item, the last chunks cost far more than the first ones
+    float uneven(std::size_t item)
+    {
+        float sum = 0.0f;
+        for (std::size_t k = 0; k < item * 16; k++)
+            sum += std::sqrt(static_cast<float>(k));
+        return sum;
+    }
+
+}
+
+int main()
+{
+    const std::size_t count = 1 << 21;
+    const int iterations = 10;
+
+    bench::lcg<float> rng{ 2718 };
+    std::vector<gem::vec3<float>> points(count), moved(count);
+    std::vector<gem::vec4<float>> colors(count), linear(count);
+    std::vector<float> x(count), y(count), z(count), radius(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        points[i] = gem::vec3<float>(rng.next(), rng.next(), rng.next()) * 100.0f;
+        colors[i] = gem::vec4<float>(rng.next() * 0.5f + 0.5f, rng.next() * 0.5f + 0.5f, rng.next() * 0.5f + 0.5f, 1.0f);
+        x[i] = points[i].x; y[i] = points[i].y; z[i] = points[i].z;
+        radius[i] = rng.next() + 1.0f;
+    }
+    const gem::mat4<float> model = gem::mat4<float>::translate<float>({ 1.0f, 2.0f, 3.0f }) * gem::mat4<float>::rotation({ 0.0f, 1.0f, 0.0f }, 30.0f);
+    const gem::frustum<float> frustum(gem::mat4<float>::translate<float>({ 0.0f, 0.0f, 50.0f }) * gem::mat4<float>::perspective(60.0f, 16.0f / 9.0f, 0.1f, 200.0f));
+    const gem::soa4<const float> spheres = { x.data(), y.data(), z.data(), radius.data(), count };
+
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+
+    std::size_t mismatches = 0;
+    mismatches += scale("bulk normalize vec3<float>", iterations, moved, [&](gem::execution::policy policy) { gem::normalize(points, moved, policy); });
+    mismatches += scale("transform_points vec3<float>", iterations, moved, [&](gem::execution::policy policy) { gem::transform_points(model, points, moved, policy); });
+    mismatches += scale("srgb_to_linear float", iterations, linear, [&](gem::execution::policy policy) { gem::srgb_to_linear(colors, linear, policy); });
+
+    // The hit list must come out in the same order, whatever the chunks. Past the returned count visible holds
+    // whatever the chunks left there, it is cleared for the comparison
+    std::vector<std::uint32_t> visible(count);
+    std::size_t visible_count = 0;
+    mismatches += scale("cull_spheres", iterations, visible, [&](gem::execution::policy policy) {
+        visible_count = gem::cull_spheres(frustum, spheres, visible, policy);
+        std::fill(visible.begin() + visible_count, visible.end(), 0u);
+    });
+    std::printf("visible spheres: %zu of %zu\n", visible_count, count);
+
+    // Uneven work through gem::parallel_for, every item is done once and chunks run on more than one thread
+    const std::size_t items = 4096;
+    std::vector<float> reference(items), results(items);
+    double seq = bench::best_of(3, [&] {
+        gem::parallel_for(items, 16, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++)
+                reference[i] = uneven(i);
+        }, gem::execution::seq);
+    });
+    std::printf("%-32s seq %10.3f ms\n", "uneven parallel_for", seq * 1e-6);
+
+    std::uint32_t most = thread_counts().back();
+    std::mutex mutex;
+    std::set<std::thread::id> workers;
+    double ns = bench::best_of(3, [&] {
+        std::fill(results.begin(), results.end(), -1.0f);
+        gem::parallel_for(items, 16, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++)
+                results[i] = uneven(i);
+            std::lock_guard<std::mutex> lock(mutex);
+            workers.insert(std::this_thread::get_id());
+        }, gem::execution::parallel_unsequenced_policy{ most });
+        bench::do_not_optimize(results);
+    });
+    std::printf("%-32s %3u threads %10.3f ms %6.2fx, %zu ran chunks\n", "uneven parallel_for", most, ns * 1e-6, seq / ns, workers.size());
+    mismatches += results != reference;
+    mismatches += workers.size() < 2;
+
+    // Batches started inside a job run inline on that participant
+    std::vector<gem::vec3<float>> nested(count), expected(count);
+    gem::normalize(points, expected, gem::execution::seq);
+    gem::parallel_for(count, count / 8, [&](std::size_t begin, std::size_t end) {
+        std::span<const gem::vec3<float>> in(points.data() + begin, end - begin);
+        gem::normalize(in, std::span<gem::vec3<float>>(nested.data() + begin, end - begin), gem::execution::parallel_policy{ most });
+    }, gem::execution::parallel_policy{ most });
+    mismatches += nested != expected;
+
+    // Several threads at once, one of them gets the workers and the others run inline
+    std::vector<std::vector<gem::vec3<float>>> outputs(3, std::vector<gem::vec3<float>>(count));
+    gem::transform_points(model, points, expected, gem::execution::seq);
+    std::vector<std::thread> callers;
+    for (std::vector<gem::vec3<float>>& output : outputs)
+    {
+        callers.emplace_back([&] {
+            for (int repeat = 0; repeat < 4; repeat++)
+                gem::transform_points(model, points, output, gem::execution::parallel_policy{ most });
+        });
+    }
+    for (std::thread& caller : callers)
+        caller.join();
+    for (const std::vector<gem::vec3<float>>& output : outputs)
+        mismatches += output != expected;
+
+    // SoA transform with null w streams (w taken as 0 and not written), every chunk must keep them null
+    std::vector<float> seq_x(count), seq_y(count), seq_z(count), par_x(count), par_y(count), par_z(count);
+    const gem::soa4<const float> directions = { x.data(), y.data(), z.data(), nullptr, count };
+    gem::transform(model, directions, gem::soa4<float>{ seq_x.data(), seq_y.data(), seq_z.data(), nullptr, count }, gem::execution::seq);
+    gem::transform(model, directions, gem::soa4<float>{ par_x.data(), par_y.data(), par_z.data(), nullptr, count }, gem::execution::parallel_policy{ most });
+    mismatches += seq_x != par_x || seq_y != par_y || seq_z != par_z;
+
+    // Nothing to do, fewer items than a chunk
+    std::size_t calls = 0;
+    gem::parallel_for(0, 16, [&](std::size_t, std::size_t) { calls++; }, gem::execution::parallel_policy{ most });
+    gem::parallel_for(5, 16, [&](std::size_t begin, std::size_t end) { calls += begin == 0 && end == 5 ? 10 : 100; }, gem::execution::parallel_policy{ most });
+    mismatches += calls != 10;
+
+    std::printf("mismatches against seq: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+// Float against double throughput for the batch kernels, and camera relative rebasing
+// Every double kernel is checked against a plain scalar loop with the same operation order, build with
+// -ffp-contract=off so the compiler does not fuse the scalar reference
+#include <gem_batch.hpp>
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    template<typename T>
+    T lane(const T* row, T x, T y, T z, T w)
+    {
+        return row[0] * x + row[1] * y + row[2] * z + row[3] * w;
+    }
+
+    template<typename T>
+    std::size_t run(const char* type, std::size_t count, int iterations)
+    {
+        bench::lcg<double> rng{ 777 };
+        gem::mat4<T> mat = gem::mat4<T>::rotation(gem::vec3<T>(0, 0, 1), static_cast<T>(30)) * gem::mat4<T>::translate(gem::vec3<T>(1, 2, 3));
+
+        std::vector<gem::vec4<T>> aos(count), aos_out(count);
+        std::vector<gem::vec3<T>> points(count), points_out(count);
+        std::vector<T> x(count), y(count), z(count), ox(count), oy(count), oz(count);
+        std::vector<gem::mat4<T>> mats(count), mats_out(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            x[i] = static_cast<T>(rng.next() * 100);
+            y[i] = static_cast<T>(rng.next() * 100);
+            z[i] = static_cast<T>(rng.next() * 100);
+            aos[i] = gem::vec4<T>(x[i], y[i], z[i], 1);
+            points[i] = gem::vec3<T>(x[i], y[i], z[i]);
+            mats[i] = gem::mat4<T>::translate(points[i]);
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s vec4 AoS transform", type);
+        double ns = bench::best_of(iterations, [&] {
+            gem::transform(mat, aos, aos_out);
+            bench::do_not_optimize(aos_out);
+        });
+        bench::report(name, ns, count);
+
+        std::snprintf(name, sizeof(name), "%s vec3 AoS transform_points", type);
+        ns = bench::best_of(iterations, [&] {
+            gem::transform_points(mat, points, points_out);
+            bench::do_not_optimize(points_out);
+        });
+        bench::report(name, ns, count);
+
+        std::snprintf(name, sizeof(name), "%s vec3 SoA transform_points", type);
+        ns = bench::best_of(iterations, [&] {
+            gem::transform_points(mat, gem::soa3<const T>{ x.data(), y.data(), z.data(), count }, gem::soa3<T>{ ox.data(), oy.data(), oz.data(), count });
+            bench::do_not_optimize(ox);
+        });
+        bench::report(name, ns, count);
+
+        std::snprintf(name, sizeof(name), "%s mat4 product", type);
+        ns = bench::best_of(iterations, [&] {
+            for (std::size_t i = 0; i < count; i++)
+                mats_out[i] = mats[i] * mat;
+            bench::do_not_optimize(mats_out);
+        });
+        bench::report(name, ns, count);
+
+        // Scalar references
+        std::size_t mismatches = 0;
+        const T* m = mat.elements;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            gem::vec4<T> v = aos[i];
+            gem::vec4<T> r(lane(m, v.x, v.y, v.z, v.w), lane(m + 4, v.x, v.y, v.z, v.w), lane(m + 8, v.x, v.y, v.z, v.w), lane(m + 12, v.x, v.y, v.z, v.w));
+            mismatches += aos_out[i] != r;
+            mismatches += mat * v != r;
+
+            gem::vec3<T> p(lane(m, x[i], y[i], z[i], T(1)), lane(m + 4, x[i], y[i], z[i], T(1)), lane(m + 8, x[i], y[i], z[i], T(1)));
+            mismatches += points_out[i] != p;
+            mismatches += ox[i] != p.x || oy[i] != p.y || oz[i] != p.z;
+
+            const T* a = mats[i].elements;
+            for (int j = 0; j < 4; j++)
+            {
+                for (int y = 0; y < 4; y++)
+                {
+                    T e = a[j] * m[y * 4] + a[j + 4] * m[y * 4 + 1] + a[j + 8] * m[y * 4 + 2] + a[j + 12] * m[y * 4 + 3];
+                    mismatches += mats_out[i].elements[j + y * 4] != e;
+                }
+            }
+        }
+        return mismatches;
+    }
+
+}
+
+int main()
+{
+    const std::size_t count = 1 << 18;
+    const int iterations = 20;
+
+    std::size_t mismatches = run<float>("float", count, iterations);
+    mismatches += run<double>("double", count, iterations);
+
+    // Camera relative rebasing, positions a few thousand kilometers out
+    bench::lcg<double> rng{ 777 };
+    gem::vec3<double> origin(4.0e6, -2.5e6, 1.0e6);
+    std::vector<gem::vec3<double>> positions(count);
+    std::vector<double> x(count), y(count), z(count);
+    std::vector<gem::mat4<double>> world(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        positions[i] = origin + gem::vec3<double>(rng.next() * 1000.0, rng.next() * 1000.0, rng.next() * 1000.0);
+        x[i] = positions[i].x;
+        y[i] = positions[i].y;
+        z[i] = positions[i].z;
+        world[i] = gem::mat4<double>::translate(positions[i]);
+    }
+
+    std::vector<gem::vec3<float>> relative(count);
+    std::vector<float> rx(count), ry(count), rz(count);
+    std::vector<gem::mat4<float>> world_relative(count);
+
+    double ns = bench::best_of(iterations, [&] {
+        gem::to_camera_relative(positions, origin, relative);
+        bench::do_not_optimize(relative);
+    });
+    bench::report("to_camera_relative AoS", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::to_camera_relative(gem::soa3<const double>{ x.data(), y.data(), z.data(), count }, origin, gem::soa3<float>{ rx.data(), ry.data(), rz.data(), count });
+        bench::do_not_optimize(rx);
+    });
+    bench::report("to_camera_relative SoA", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::to_camera_relative(world, origin, world_relative);
+        bench::do_not_optimize(world_relative);
+    });
+    bench::report("to_camera_relative mat4", ns, count);
+
+    double float_error = 0.0, rebased_error = 0.0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        gem::vec3<double> d = positions[i] - origin;
+        gem::vec3<float> expected(static_cast<float>(d.x), static_cast<float>(d.y), static_cast<float>(d.z));
+        mismatches += relative[i] != expected;
+        mismatches += rx[i] != expected.x || ry[i] != expected.y || rz[i] != expected.z;
+        mismatches += world_relative[i].elements[3] != expected.x || world_relative[i].elements[7] != expected.y || world_relative[i].elements[11] != expected.z;
+
+        // Against rounding to float first and subtracting afterwards
+        double naive = static_cast<double>(static_cast<float>(positions[i].x) - static_cast<float>(origin.x));
+        float_error = std::max(float_error, std::abs(naive - d.x));
+        rebased_error = std::max(rebased_error, std::abs(static_cast<double>(expected.x) - d.x));
+    }
+    std::printf("max error, float subtraction: %g, rebased: %g\n", float_error, rebased_error);
+
+    std::printf("mismatches against scalar references: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+// Animation blending throughput: one pose of 10k joints blended per call
+// Compares the scalar quaternion members against the batched SoA kernels, reports the angular
+// error of slerp_fast and nlerp against the exact slerp and checks multiply and to_mat4 against double
+// The exact match check needs -ffp-contract=off, FMA contraction rounds scalar and SIMD code differently
+#include <gem_batch.hpp>
+#include "bench.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    gem::quaternion<float> random_unit(bench::lcg<float>& rng)
+    {
+        gem::quaternion<float> q(rng.next(), rng.next(), rng.next(), rng.next());
+        float inv = 1.0f / std::sqrt(q.dot(q));
+        return gem::quaternion<float>(q.x * inv, q.y * inv, q.z * inv, q.w * inv);
+    }
+
+    // Angle in radians between the rotations of two unit quaternions, computed in double
+    double angle_between(const gem::quaternion<float>& a, const gem::quaternion<float>& b)
+    {
+        double d = std::abs(static_cast<double>(a.x) * b.x + static_cast<double>(a.y) * b.y +
+                            static_cast<double>(a.z) * b.z + static_cast<double>(a.w) * b.w);
+        return 2.0 * std::acos(d > 1.0 ? 1.0 : d);
+    }
+
+    struct quaternion_soa
+    {
+        std::vector<float> x, y, z, w;
+
+        explicit quaternion_soa(std::size_t count) : x(count), y(count), z(count), w(count) {}
+
+        void set(std::size_t i, const gem::quaternion<float>& q) { x[i] = q.x; y[i] = q.y; z[i] = q.z; w[i] = q.w; }
+        gem::quaternion<float> get(std::size_t i) const { return gem::quaternion<float>(x[i], y[i], z[i], w[i]); }
+
+        gem::soa4<float> view() { return { x.data(), y.data(), z.data(), w.data(), x.size() }; }
+        gem::soa4<const float> view() const { return { x.data(), y.data(), z.data(), w.data(), x.size() }; }
+    };
+
+}
+
+int main()
+{
+    const std::size_t count = 10000;
+    const int iterations = 200;
+    const float t = 0.37f;
+
+    bench::lcg<float> rng{ 12345 };
+    std::vector<gem::quaternion<float>> a(count), b(count), out(count);
+    std::vector<gem::vec3<float>> vectors(count), vectors_out(count);
+    std::vector<float> weights(count);
+    std::vector<gem::mat4<float>> palette(count);
+    quaternion_soa sa(count), sb(count), sout(count);
+    std::vector<float> vx(count), vy(count), vz(count), ox(count), oy(count), oz(count);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        a[i] = random_unit(rng);
+        b[i] = random_unit(rng);
+        sa.set(i, a[i]);
+        sb.set(i, b[i]);
+        vectors[i] = gem::vec3<float>(rng.next(), rng.next(), rng.next());
+        vx[i] = vectors[i].x; vy[i] = vectors[i].y; vz[i] = vectors[i].z;
+        weights[i] = (rng.next() + 1.0f) * 0.5f;
+    }
+
+    double ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = gem::quaternion<float>::slerp(a[i], b[i], t);
+        bench::do_not_optimize(out);
+    });
+    bench::report("scalar quaternion::slerp", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = gem::quaternion<float>::slerp_fast(a[i], b[i], t);
+        bench::do_not_optimize(out);
+    });
+    bench::report("scalar quaternion::slerp_fast", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::slerp(sa.view(), sb.view(), t, sout.view(), gem::blend_accuracy::exact);
+        bench::do_not_optimize(sout.x);
+    });
+    bench::report("SoA gem::slerp exact", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::slerp(sa.view(), sb.view(), t, sout.view(), gem::blend_accuracy::fast);
+        bench::do_not_optimize(sout.x);
+    });
+    bench::report("SoA gem::slerp fast", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::nlerp(sa.view(), sb.view(), t, sout.view());
+        bench::do_not_optimize(sout.x);
+    });
+    bench::report("SoA gem::nlerp", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = a[i] * b[i];
+        bench::do_not_optimize(out);
+    });
+    bench::report("scalar quaternion * quaternion", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::multiply(sa.view(), sb.view(), sout.view());
+        bench::do_not_optimize(sout.x);
+    });
+    bench::report("SoA gem::multiply", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            vectors_out[i] = a[i].rotate(vectors[i]);
+        bench::do_not_optimize(vectors_out);
+    });
+    bench::report("scalar quaternion::rotate", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::rotate(sa.view(), gem::soa3<const float>{ vx.data(), vy.data(), vz.data(), count },
+                    gem::soa3<float>{ ox.data(), oy.data(), oz.data(), count });
+        bench::do_not_optimize(ox);
+    });
+    bench::report("SoA gem::rotate", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            palette[i] = a[i].to_mat4();
+        bench::do_not_optimize(palette);
+    });
+    bench::report("scalar quaternion::to_mat4", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            palette[i] = a[i].to_mat4_unit();
+        bench::do_not_optimize(palette);
+    });
+    bench::report("scalar quaternion::to_mat4_unit", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::to_mat4_unit<float>(sa.view(), palette);
+        bench::do_not_optimize(palette);
+    });
+    bench::report("SoA gem::to_mat4_unit palette", ns, count);
+
+    // Accuracy against exact slerp, over a sweep of weights
+    double fast_error = 0.0;
+    double nlerp_error = 0.0;
+    for (int step = 0; step <= 20; step++)
+    {
+        float s = static_cast<float>(step) / 20.0f;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            gem::quaternion<float> exact = gem::quaternion<float>::slerp(a[i], b[i], s);
+            fast_error = std::max(fast_error, angle_between(exact, gem::quaternion<float>::slerp_fast(a[i], b[i], s)));
+            nlerp_error = std::max(nlerp_error, angle_between(exact, gem::quaternion<float>::nlerp(a[i], b[i], s)));
+        }
+    }
+    std::printf("max error slerp_fast: %.3g rad, nlerp: %.3g rad\n", fast_error, nlerp_error);
+
+    // Every batch kernel must match its scalar counterpart exactly
+    std::size_t mismatches = 0;
+    auto check = [&](auto batch, auto scalar) {
+        batch();
+        for (std::size_t i = 0; i < count; i++)
+        {
+            gem::quaternion<float> ref = scalar(i);
+            gem::quaternion<float> got = sout.get(i);
+            if (ref.x != got.x || ref.y != got.y || ref.z != got.z || ref.w != got.w)
+                mismatches++;
+        }
+    };
+    using quat = gem::quaternion<float>;
+    check([&] { gem::nlerp(sa.view(), sb.view(), t, sout.view()); }, [&](std::size_t i) { return quat::nlerp(a[i], b[i], t); });
+    check([&] { gem::slerp(sa.view(), sb.view(), t, sout.view(), gem::blend_accuracy::exact); }, [&](std::size_t i) { return quat::slerp(a[i], b[i], t); });
+    check([&] { gem::slerp(sa.view(), sb.view(), t, sout.view()); }, [&](std::size_t i) { return quat::slerp_fast(a[i], b[i], t); });
+    check([&] { gem::slerp(sa.view(), sb.view(), weights, sout.view()); }, [&](std::size_t i) { return quat::slerp_fast(a[i], b[i], weights[i]); });
+    check([&] { gem::multiply(sa.view(), sb.view(), sout.view()); }, [&](std::size_t i) { return a[i] * b[i]; });
+
+    gem::rotate(sa.view(), gem::soa3<const float>{ vx.data(), vy.data(), vz.data(), count },
+                gem::soa3<float>{ ox.data(), oy.data(), oz.data(), count });
+    for (std::size_t i = 0; i < count; i++)
+    {
+        gem::vec3<float> ref = a[i].rotate(vectors[i]);
+        if (ref != gem::vec3<float>(ox[i], oy[i], oz[i]))
+            mismatches++;
+    }
+
+    gem::to_mat4<float>(sa.view(), palette);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (palette[i] != a[i].to_mat4())
+            mismatches++;
+    }
+    gem::to_mat4_unit<float>(sa.view(), palette);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (palette[i] != a[i].to_mat4_unit())
+            mismatches++;
+    }
+    std::printf("mismatches against scalar quaternion: %zu\n", mismatches);
+
+    // Double precision reference for the product and the rotation matrix
+    double multiply_error = 0.0;
+    double matrix_error = 0.0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        gem::quaternion<double> p(a[i].x, a[i].y, a[i].z, a[i].w);
+        gem::quaternion<double> q(b[i].x, b[i].y, b[i].z, b[i].w);
+        double r[4] = {
+            p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y,
+            p.w * q.y - p.x * q.z + p.y * q.w + p.z * q.x,
+            p.w * q.z + p.x * q.y - p.y * q.x + p.z * q.w,
+            p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z,
+        };
+        quat product = a[i] * b[i];
+        const float got[4] = { product.x, product.y, product.z, product.w };
+        for (int c = 0; c < 4; c++)
+            multiply_error = std::max(multiply_error, std::abs(got[c] - r[c]));
+
+        // Columns of the reference matrix are p rotating the basis vectors
+        for (int c = 0; c < 3; c++)
+        {
+            gem::vec3<double> axis(c == 0, c == 1, c == 2);
+            gem::vec3<double> col = p.rotate(axis);
+            matrix_error = std::max(matrix_error, std::abs(palette[i].elements[0 * 4 + c] - col.x));
+            matrix_error = std::max(matrix_error, std::abs(palette[i].elements[1 * 4 + c] - col.y));
+            matrix_error = std::max(matrix_error, std::abs(palette[i].elements[2 * 4 + c] - col.z));
+        }
+    }
+    std::printf("max error against double: multiply %.3g, to_mat4 %.3g\n", multiply_error, matrix_error);
+    if (multiply_error > 1e-6 || matrix_error > 1e-5)
+        mismatches++;
+
+    return mismatches == 0 ? 0 : 1;
+}
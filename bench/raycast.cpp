@@ -0,0 +1,169 @@
+// Primitive test throughput: one ray against 1M boxes and triangles (batched against per-primitive
+// raycast calls) and the per-pair tests for the other primitives
+// The batched distances must equal the scalar ones, build with -ffp-contract=off so FMA contraction does not round them differently
+#include <gem_batch.hpp>
+#include "bench.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    struct soa3_storage
+    {
+        std::vector<float> x, y, z;
+
+        explicit soa3_storage(std::size_t count) : x(count), y(count), z(count) {}
+        void set(std::size_t i, const gem::vec3<float>& v) { x[i] = v.x; y[i] = v.y; z[i] = v.z; }
+        gem::soa3<const float> view() const { return { x.data(), y.data(), z.data(), x.size() }; }
+    };
+
+    // Times a per-primitive test and returns how many of the count calls hit
+    template<typename Fn>
+    std::size_t run(const char* name, std::size_t count, int iterations, Fn&& test)
+    {
+        std::size_t hits = 0;
+        double ns = bench::best_of(iterations, [&] {
+            hits = 0;
+            for (std::size_t i = 0; i < count; i++)
+                hits += test(i);
+            bench::do_not_optimize(hits);
+        });
+        bench::report(name, ns, count);
+        return hits;
+    }
+
+}
+
+int main()
+{
+    const std::size_t count = 1 << 20;
+    const int iterations = 10;
+
+    bench::lcg<float> rng{ 2024 };
+    gem::ray ray(gem::vec3<float>(-100.0f, -3.0f, 2.0f), gem::vec3<float>(1.0f, 0.03f, -0.02f));
+
+    std::vector<gem::aabb> boxes(count);
+    std::vector<gem::triangle> triangles(count);
+    soa3_storage box_min(count), box_max(count), ta(count), tb(count), tc(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        gem::vec3<float> center = rng.next3(100.0f);
+        gem::vec3<float> half = gem::vec3<float>(rng.next() + 1.5f, rng.next() + 1.5f, rng.next() + 1.5f);
+        boxes[i] = { center - half, center + half };
+        box_min.set(i, boxes[i].min);
+        box_max.set(i, boxes[i].max);
+
+        triangles[i] = { center, center + rng.next3(4.0f), center + rng.next3(4.0f) };
+        ta.set(i, triangles[i].a);
+        tb.set(i, triangles[i].b);
+        tc.set(i, triangles[i].c);
+    }
+
+    std::vector<float> t(count);
+    std::size_t mismatches = 0;
+
+    // Ray against boxes
+    std::size_t reference_hits = run("per-box raycast(ray, aabb)", count, iterations, [&](std::size_t i) {
+        float hit;
+        return gem::raycast(ray, boxes[i], hit);
+    });
+
+    std::size_t hits = 0;
+    double ns = bench::best_of(iterations, [&] {
+        hits = gem::raycast_aabbs(ray, box_min.view(), box_max.view(), t);
+        bench::do_not_optimize(t);
+    });
+    bench::report("gem::raycast_aabbs", ns, count);
+
+    mismatches += hits != reference_hits;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        float hit = std::numeric_limits<float>::infinity();
+        gem::raycast(ray, boxes[i], hit);
+        mismatches += hit != t[i];
+    }
+    std::printf("box hits: %zu\n", hits);
+
+    // Ray against triangles
+    reference_hits = run("per-triangle raycast(ray, triangle)", count, iterations, [&](std::size_t i) {
+        float hit;
+        return gem::raycast(ray, triangles[i], hit);
+    });
+
+    ns = bench::best_of(iterations, [&] {
+        hits = gem::raycast_triangles(ray, ta.view(), tb.view(), tc.view(), t);
+        bench::do_not_optimize(t);
+    });
+    bench::report("gem::raycast_triangles", ns, count);
+
+    mismatches += hits != reference_hits;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        float hit = std::numeric_limits<float>::infinity();
+        gem::raycast(ray, triangles[i], hit);
+        mismatches += hit != t[i];
+    }
+    std::printf("triangle hits: %zu\n", hits);
+
+    // Per-pair tests for the other primitives, reusing the boxes for their placement
+    std::vector<gem::obb> obbs(count);
+    std::vector<gem::sphere> spheres(count);
+    std::vector<gem::capsule> capsules(count);
+    std::vector<gem::plane> planes(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        gem::vec3<float> center = (boxes[i].min + boxes[i].max) * 0.5f;
+        gem::quaternion<float> q = gem::quaternion<float>(rng.next(), rng.next(), rng.next(), rng.next()).normalized();
+        obbs[i] = { center, (boxes[i].max - boxes[i].min) * 0.5f,
+                    { q.rotate({ 1.0f, 0.0f, 0.0f }), q.rotate({ 0.0f, 1.0f, 0.0f }), q.rotate({ 0.0f, 0.0f, 1.0f }) } };
+        spheres[i] = { rng.next() + 1.5f, center };
+        capsules[i] = { center, center + rng.next3(5.0f), rng.next() + 1.5f };
+        planes[i] = { rng.next3(1.0f).normalized(), rng.next() * 100.0f };
+    }
+
+    std::size_t obb_hits = run("raycast(ray, obb)", count, iterations, [&](std::size_t i) {
+        float hit;
+        return gem::raycast(ray, obbs[i], hit);
+    });
+    std::size_t sphere_hits = run("raycast(ray, sphere)", count, iterations, [&](std::size_t i) {
+        float hit;
+        return gem::raycast(ray, spheres[i], hit);
+    });
+    std::size_t plane_hits = run("raycast(ray, plane)", count, iterations, [&](std::size_t i) {
+        float hit;
+        return gem::raycast(ray, planes[i], hit);
+    });
+    gem::sphere probe = { 10.0f, { 5.0f, -5.0f, 0.0f } };
+    std::size_t capsule_hits = run("sphere_in_capsule", count, iterations, [&](std::size_t i) {
+        return gem::sphere_in_capsule(probe, capsules[i]);
+    });
+    std::size_t sphere_box_hits = run("sphere_in_aabb", count, iterations, [&](std::size_t i) {
+        return gem::sphere_in_aabb(probe, boxes[i]);
+    });
+    gem::aabb region = { { -10.0f, -10.0f, -10.0f }, { 10.0f, 10.0f, 10.0f } };
+    std::size_t box_box_hits = run("aabb_in_aabb", count, iterations, [&](std::size_t i) {
+        return gem::aabb_in_aabb(region, boxes[i]);
+    });
+    std::size_t point_obb_hits = run("point_in_obb", count, iterations, [&](std::size_t i) {
+        return gem::point_in_obb(probe.position, obbs[i]);
+    });
+    std::printf("hits obb: %zu, sphere: %zu, plane: %zu, capsule: %zu, sphere-aabb: %zu, aabb-aabb: %zu, point-obb: %zu\n",
+                obb_hits, sphere_hits, plane_hits, capsule_hits, sphere_box_hits, box_box_hits, point_obb_hits);
+
+    // An obb with the identity axes is the same box as its aabb
+    for (std::size_t i = 0; i < count; i += 97)
+    {
+        gem::obb box = { (boxes[i].min + boxes[i].max) * 0.5f, (boxes[i].max - boxes[i].min) * 0.5f };
+        float a = -1.0f, b = -1.0f;
+        bool hit_a = gem::raycast(ray, boxes[i], a);
+        bool hit_b = gem::raycast(ray, box, b);
+        mismatches += hit_a != hit_b || std::abs(a - b) > 1e-3f;
+    }
+
+    std::printf("mismatches: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
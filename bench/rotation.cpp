@@ -0,0 +1,161 @@
+// Rotation batches: 128k euler angle and axis-angle rotations built at once, as in imports and procedural placement
+// Compares the scalar builders against the SoA kernels, checks every kernel against the scalar expression with
+// gem::fast::sincos and reports the error against the exact scalar builders
+// The exact match check needs -ffp-contract=off, FMA contraction rounds scalar and SIMD code differently
+#include <gem_batch.hpp>
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    // mat4::rotation with fast::sincos
+    template<typename T>
+    gem::mat4<T> rotation_fast(const gem::vec3<T>& axis, T angle)
+    {
+        T s, c;
+        gem::fast::sincos(angle * static_cast<T>(GEM_DEG_TO_RAD), s, c);
+        T omc = 1 - c;
+        T x = axis.x, y = axis.y, z = axis.z;
+
+        gem::mat4<T> result(static_cast<T>(1));
+        result.elements[0] = x * x * omc + c;
+        result.elements[1] = x * y * omc - z * s;
+        result.elements[2] = x * z * omc + y * s;
+        result.elements[4] = y * x * omc + z * s;
+        result.elements[5] = y * y * omc + c;
+        result.elements[6] = y * z * omc - x * s;
+        result.elements[8] = x * z * omc - y * s;
+        result.elements[9] = y * z * omc + x * s;
+        result.elements[10] = z * z * omc + c;
+        return result;
+    }
+
+    template<typename T>
+    double max_difference(const gem::quaternion<T>& a, const gem::quaternion<T>& b)
+    {
+        return std::max({ std::abs(static_cast<double>(a.x - b.x)), std::abs(static_cast<double>(a.y - b.y)),
+                          std::abs(static_cast<double>(a.z - b.z)), std::abs(static_cast<double>(a.w - b.w)) });
+    }
+
+    template<typename T>
+    std::size_t run(const char* type, std::size_t count, int iterations)
+    {
+        bench::lcg<double> rng{ 31337 };
+        std::vector<gem::vec3<T>> euler(count), axes(count);
+        std::vector<T> ex(count), ey(count), ez(count), ax(count), ay(count), az(count), radians(count), degrees(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            euler[i] = gem::vec3<T>(static_cast<T>(rng.next() * 3.14159265358979323846), static_cast<T>(rng.next() * 3.14159265358979323846),
+                                    static_cast<T>(rng.next() * 3.14159265358979323846));
+            axes[i] = gem::vec3<T>(static_cast<T>(rng.next()), static_cast<T>(rng.next()), static_cast<T>(rng.next())).normalized();
+            ex[i] = euler[i].x; ey[i] = euler[i].y; ez[i] = euler[i].z;
+            ax[i] = axes[i].x; ay[i] = axes[i].y; az[i] = axes[i].z;
+            radians[i] = static_cast<T>(rng.next() * 3.14159265358979323846);
+            degrees[i] = static_cast<T>(rng.next() * 180.0);
+        }
+
+        std::vector<gem::quaternion<T>> quaternions(count);
+        std::vector<T> qx(count), qy(count), qz(count), qw(count);
+        std::vector<gem::mat4<T>> matrices(count), batch_matrices(count);
+        gem::soa3<const T> euler_soa{ ex.data(), ey.data(), ez.data(), count };
+        gem::soa3<const T> axes_soa{ ax.data(), ay.data(), az.data(), count };
+        gem::soa4<T> out{ qx.data(), qy.data(), qz.data(), qw.data(), count };
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s quaternion::from_euler_angles", type);
+        double ns = bench::best_of(iterations, [&] {
+            for (std::size_t i = 0; i < count; i++)
+                quaternions[i] = gem::quaternion<T>::from_euler_angles(euler[i]);
+            bench::do_not_optimize(quaternions);
+        });
+        bench::report(name, ns, count);
+
+        std::snprintf(name, sizeof(name), "%s SoA gem::from_euler_angles", type);
+        ns = bench::best_of(iterations, [&] {
+            gem::from_euler_angles(euler_soa, out);
+            bench::do_not_optimize(qx);
+        });
+        bench::report(name, ns, count);
+
+        std::size_t mismatches = 0;
+        double euler_error = 0.0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            gem::quaternion<T> q(qx[i], qy[i], qz[i], qw[i]);
+            gem::quaternion<T> expected = gem::quaternion<T>::from_euler_angles_fast(euler[i]);
+            mismatches += q.x != expected.x || q.y != expected.y || q.z != expected.z || q.w != expected.w;
+            euler_error = std::max(euler_error, max_difference(q, quaternions[i]));
+        }
+
+        std::snprintf(name, sizeof(name), "%s quaternion(axis, angle)", type);
+        ns = bench::best_of(iterations, [&] {
+            for (std::size_t i = 0; i < count; i++)
+                quaternions[i] = gem::quaternion<T>(axes[i], radians[i]);
+            bench::do_not_optimize(quaternions);
+        });
+        bench::report(name, ns, count);
+
+        std::snprintf(name, sizeof(name), "%s SoA gem::from_axis_angle", type);
+        ns = bench::best_of(iterations, [&] {
+            gem::from_axis_angle(axes_soa, radians, out);
+            bench::do_not_optimize(qx);
+        });
+        bench::report(name, ns, count);
+
+        double axis_angle_error = 0.0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            T s, c;
+            gem::fast::sincos(radians[i] * static_cast<T>(0.5), s, c);
+            gem::vec3<T> axis = axes[i].normalized();
+            mismatches += qx[i] != axis.x * s || qy[i] != axis.y * s || qz[i] != axis.z * s || qw[i] != c;
+            axis_angle_error = std::max(axis_angle_error, max_difference(gem::quaternion<T>(qx[i], qy[i], qz[i], qw[i]), quaternions[i]));
+        }
+
+        std::snprintf(name, sizeof(name), "%s mat4::rotation", type);
+        ns = bench::best_of(iterations, [&] {
+            for (std::size_t i = 0; i < count; i++)
+                matrices[i] = gem::mat4<T>::rotation(axes[i], degrees[i]);
+            bench::do_not_optimize(matrices);
+        });
+        bench::report(name, ns, count);
+
+        std::snprintf(name, sizeof(name), "%s gem::rotation", type);
+        ns = bench::best_of(iterations, [&] {
+            gem::rotation(axes_soa, degrees, batch_matrices);
+            bench::do_not_optimize(batch_matrices);
+        });
+        bench::report(name, ns, count);
+
+        double matrix_error = 0.0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            mismatches += batch_matrices[i] != rotation_fast(axes[i], degrees[i]);
+            for (int e = 0; e < 16; e++)
+                matrix_error = std::max(matrix_error, std::abs(static_cast<double>(batch_matrices[i].elements[e] - matrices[i].elements[e])));
+        }
+
+        std::printf("%s max error against the exact builders, euler: %g, axis-angle: %g, matrices: %g\n", type, euler_error, axis_angle_error,
+                    matrix_error);
+        return mismatches;
+    }
+
+}
+
+int main()
+{
+    const std::size_t count = 1 << 17;
+    const int iterations = 20;
+
+    std::size_t mismatches = run<float>("float", count, iterations);
+    mismatches += run<double>("double", count, iterations);
+
+    std::printf("mismatches against scalar references: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+// vec4<float> / mat4<float> kernel throughput
+// Build once as is and once with GEM_NO_SIMD, both builds must print the same checksum
+#include <gem_math.hpp>
+#include "bench.hpp"
+
+#include <vector>
+#include <cstdio>
+
+int main()
+{
+    const std::size_t count = 1 << 16;
+    const int iterations = 50;
+
+    std::vector<gem::vec4<float>> a(count), b(count), out(count);
+    std::vector<gem::mat4<float>> mats(count);
+    std::vector<float> scalars(count);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        float f = static_cast<float>(i % 1024) * 0.01f;
+        a[i] = gem::vec4<float>(f, -f, f * 0.5f, 1.0f);
+        b[i] = gem::vec4<float>(1.0f - f, f * 2.0f, 0.25f, f);
+        for (int e = 0; e < 16; e++)
+            mats[i].elements[e] = f + static_cast<float>(e);
+    }
+
+    double ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = a[i] + b[i] * 2.0f - a[i] / b[i];
+        bench::do_not_optimize(out);
+    });
+    bench::report("vec4 add/mul/sub/div", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            scalars[i] = a[i].dot(b[i]);
+        bench::do_not_optimize(scalars);
+    });
+    bench::report("vec4 dot", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = b[i].normalized();
+        bench::do_not_optimize(out);
+    });
+    bench::report("vec4 normalized", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i + 1 < count; i++)
+            mats[i].multiply(mats[i + 1]);
+        bench::do_not_optimize(mats);
+    });
+    bench::report("mat4 multiply", ns, count - 1);
+
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = mats[i] * a[i];
+        bench::do_not_optimize(out);
+    });
+    bench::report("mat4 * vec4", ns, count);
+
+    // Deterministic checksum, identical with and without GEM_NO_SIMD
+    gem::vec4<float> v(0.5f, 1.5f, -2.0f, 1.0f);
+    gem::mat4<float> m = gem::mat4<float>::translate<float>({ 1.0f, 2.0f, 3.0f });
+    double checksum = 0.0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        gem::vec4<float> r = (a[i] + v) * b[i] - v / 3.0f;
+        r.normalize();
+        gem::mat4<float> n(static_cast<float>(i % 7));
+        n.multiply(m);
+        gem::vec4<float> t = n * r;
+        checksum += r.dot(b[i]) + t.magnitude();
+    }
+    std::printf("checksum: %.17g\n", checksum);
+
+    return 0;
+}
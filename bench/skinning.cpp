@@ -0,0 +1,100 @@
+// Pose to palette throughput on one thread and on every hardware thread, compares gem::build_palette against per-joint
+// mat4::scale * quaternion::to_mat4 * mat4::translate calls followed by the parent product
+#include <gem_skinning.hpp>
+#include "bench.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+int main()
+{
+    // 128 characters of 100 joints, laid out as one joint array
+    const std::size_t characters = 128;
+    const std::size_t joints = 100;
+    const std::size_t count = characters * joints;
+    const int iterations = 100;
+
+    bench::lcg<float> rng{ 777 };
+    std::vector<float> tx(count), ty(count), tz(count);
+    std::vector<float> rx(count), ry(count), rz(count), rw(count);
+    std::vector<float> sx(count), sy(count), sz(count);
+    std::vector<gem::int32> parents(count);
+    std::vector<gem::mat4<float>> inverse_bind(count), world(count), skinning(count);
+    std::vector<gem::mat4<float>> ref_world(count), ref_skinning(count);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        std::size_t joint = i % joints;
+        // Each character is its own tree, the root has no parent
+        parents[i] = joint == 0 ? -1 : static_cast<gem::int32>(i - joint + (rng.next() + 1.0f) * 0.5f * (joint - 1));
+
+        tx[i] = rng.next(); ty[i] = rng.next(); tz[i] = rng.next();
+        gem::quaternion<float> q = gem::quaternion<float>(rng.next(), rng.next(), rng.next(), rng.next()).normalized();
+        rx[i] = q.x; ry[i] = q.y; rz[i] = q.z; rw[i] = q.w;
+        sx[i] = 1.0f + rng.next() * 0.1f; sy[i] = 1.0f + rng.next() * 0.1f; sz[i] = 1.0f + rng.next() * 0.1f;
+
+        inverse_bind[i] = gem::mat4<float>::translate<float>({ rng.next(), rng.next(), rng.next() });
+    }
+
+    gem::joint_pose<float> pose = {
+        { tx.data(), ty.data(), tz.data(), count },
+        { rx.data(), ry.data(), rz.data(), rw.data(), count },
+        { sx.data(), sy.data(), sz.data(), count },
+    };
+
+    double ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            gem::mat4<float> local = gem::mat4<float>::scale({ sx[i], sy[i], sz[i] }) *
+                                     gem::quaternion<float>(rx[i], ry[i], rz[i], rw[i]).to_mat4() *
+                                     gem::mat4<float>::translate<float>({ tx[i], ty[i], tz[i] });
+            ref_world[i] = parents[i] >= 0 ? local * ref_world[parents[i]] : local;
+            ref_skinning[i] = inverse_bind[i] * ref_world[i];
+        }
+        bench::do_not_optimize(ref_skinning);
+    });
+    bench::report("per-joint scale * rotation * translate", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::build_palette(pose, parents, inverse_bind, world, skinning, gem::execution::seq);
+        bench::do_not_optimize(skinning);
+    });
+    bench::report("gem::build_palette, 1 thread", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::build_palette(pose, parents, inverse_bind, world, skinning);
+        bench::do_not_optimize(skinning);
+    });
+    bench::report("gem::build_palette, all threads", ns, count);
+
+    ns = bench::best_of(iterations, [&] {
+        gem::build_palette(pose, parents, inverse_bind, world);
+        bench::do_not_optimize(world);
+    });
+    bench::report("gem::build_palette world only", ns, count);
+
+    // Both paths round differently (to_mat4 renormalizes), compare with a tolerance
+    gem::build_palette(pose, parents, inverse_bind, world, skinning, gem::execution::seq);
+    double max_error = 0.0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        for (int e = 0; e < 16; e++)
+        {
+            max_error = std::max(max_error, static_cast<double>(std::abs(world[i].elements[e] - ref_world[i].elements[e])));
+            max_error = std::max(max_error, static_cast<double>(std::abs(skinning[i].elements[e] - ref_skinning[i].elements[e])));
+        }
+    }
+    std::printf("max difference against per-joint matrices: %.3g\n", max_error);
+
+    // The threaded path splits the pass in three, it must give the same bits as the single pass
+    std::vector<gem::mat4<float>> split_world(count), split_skinning(count);
+    gem::build_palette(pose, parents, inverse_bind, split_world, split_skinning, gem::execution::parallel_policy{ 4 });
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < count; i++)
+        mismatches += split_world[i] != world[i] || split_skinning[i] != skinning[i];
+    std::printf("mismatches between 1 and 4 threads: %zu\n", mismatches);
+
+    return max_error < 1e-4 && mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+// sRGB <-> linear, tonemapping and premultiplied alpha over a 1024 x 1024 image, as in lightmap baking and
+// thumbnail generation. Reports the memory traffic of every batch on one thread and on every hardware thread
+// next to a memcpy and to naive per-pixel std::pow loops, checks every pixel against the scalar functions and
+// the threaded results against the single thread ones, and reports the error of the fast curves against the
+// exact ones. Build with -ffp-contract=off for the exact match
+#include <gem_color.hpp>
+#include "bench.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+    double exact_srgb_to_linear(double s)
+    {
+        return s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4);
+    }
+
+    double exact_linear_to_srgb(double l)
+    {
+        return l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+    }
+
+    // Runs batch(policy) sequentially and on every hardware thread and reports both
+    template<typename Batch>
+    void run(const char* name, std::size_t count, std::size_t bytes, int iterations, Batch&& batch)
+    {
+        char label[64];
+        std::snprintf(label, sizeof(label), "%s, 1 thread", name);
+        bench::report_bandwidth(label, bench::best_of(iterations, [&] { batch(gem::execution::seq); }), count, bytes);
+        std::snprintf(label, sizeof(label), "%s, all threads", name);
+        bench::report_bandwidth(label, bench::best_of(iterations, [&] { batch(gem::execution::par); }), count, bytes);
+    }
+
+}
+
+int main()
+{
+    const std::size_t count = 1024 * 1024;
+    const int iterations = 20;
+    const std::size_t float_bytes = 2 * sizeof(gem::vec4<float>), mixed_bytes = sizeof(gem::vec4<float>) + sizeof(gem::u8vec4);
+
+    bench::lcg<double> rng{ 8086 };
+    std::vector<gem::vec4<float>> colors(count), hdr(count), out(count), threaded(count);
+    std::vector<gem::u8vec4> pixels(count), packed(count), packed_threaded(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        float r = static_cast<float>(rng.next() * 0.5 + 0.5), g = static_cast<float>(rng.next() * 0.5 + 0.5), b = static_cast<float>(rng.next() * 0.5 + 0.5);
+        float a = i % 13 == 0 ? 0.0f : static_cast<float>(rng.next() * 0.5 + 0.5);
+        colors[i] = gem::vec4<float>(r, g, b, a);
+        hdr[i] = gem::vec4<float>(r * r * 16.0f, g * g * 16.0f, b * b * 16.0f, a);
+        pixels[i] = gem::normalized_to_rgb(colors[i]);
+    }
+
+    double ns = bench::best_of(iterations, [&] {
+        std::memcpy(out.data(), colors.data(), count * sizeof(gem::vec4<float>));
+        bench::do_not_optimize(out);
+    });
+    bench::report_bandwidth("memcpy float pixels", ns, count, float_bytes);
+
+    // The per-pixel loops the batches replace
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const gem::vec4<float>& c = colors[i];
+            out[i] = gem::vec4<float>(static_cast<float>(exact_srgb_to_linear(c.x)), static_cast<float>(exact_srgb_to_linear(c.y)),
+                                      static_cast<float>(exact_srgb_to_linear(c.z)), c.w);
+        }
+        bench::do_not_optimize(out);
+    });
+    bench::report_bandwidth("srgb_to_linear std::pow loop", ns, count, float_bytes);
+    ns = bench::best_of(iterations, [&] {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const gem::vec4<float>& c = colors[i];
+            out[i] = gem::vec4<float>(static_cast<float>(exact_linear_to_srgb(c.x)), static_cast<float>(exact_linear_to_srgb(c.y)),
+                                      static_cast<float>(exact_linear_to_srgb(c.z)), c.w);
+        }
+        bench::do_not_optimize(out);
+    });
+    bench::report_bandwidth("linear_to_srgb std::pow loop", ns, count, float_bytes);
+
+    std::size_t mismatches = 0;
+    auto check = [&](auto&& batch, auto&& expected) {
+        batch(out, gem::execution::seq);
+        batch(threaded, gem::execution::parallel_policy{ 4 });
+        for (std::size_t i = 0; i < count; i++)
+            mismatches += out[i] != expected(i) || threaded[i] != out[i];
+    };
+    auto check_packed = [&](auto&& batch, auto&& expected) {
+        batch(packed, gem::execution::seq);
+        batch(packed_threaded, gem::execution::parallel_policy{ 4 });
+        for (std::size_t i = 0; i < count; i++)
+            mismatches += packed[i] != expected(i) || packed_threaded[i] != packed[i];
+    };
+
+    run("srgb_to_linear float", count, float_bytes, iterations, [&](gem::execution::policy policy) { gem::srgb_to_linear(colors, out, policy); });
+    check([&](auto& o, gem::execution::policy p) { gem::srgb_to_linear(colors, o, p); }, [&](std::size_t i) { return gem::srgb_to_linear(colors[i]); });
+    run("srgb_to_linear float low", count, float_bytes, iterations,
+        [&](gem::execution::policy policy) { gem::srgb_to_linear<gem::fast::accuracy::low>(colors, out, policy); });
+    check([&](auto& o, gem::execution::policy p) { gem::srgb_to_linear<gem::fast::accuracy::low>(colors, o, p); },
+          [&](std::size_t i) { return gem::srgb_to_linear<gem::fast::accuracy::low>(colors[i]); });
+
+    run("linear_to_srgb float", count, float_bytes, iterations, [&](gem::execution::policy policy) { gem::linear_to_srgb(colors, out, policy); });
+    check([&](auto& o, gem::execution::policy p) { gem::linear_to_srgb(colors, o, p); }, [&](std::size_t i) { return gem::linear_to_srgb(colors[i]); });
+    run("linear_to_srgb float low", count, float_bytes, iterations,
+        [&](gem::execution::policy policy) { gem::linear_to_srgb<gem::fast::accuracy::low>(colors, out, policy); });
+    check([&](auto& o, gem::execution::policy p) { gem::linear_to_srgb<gem::fast::accuracy::low>(colors, o, p); },
+          [&](std::size_t i) { return gem::linear_to_srgb<gem::fast::accuracy::low>(colors[i]); });
+
+    run("srgb_to_linear RGBA8 table", count, mixed_bytes, iterations, [&](gem::execution::policy policy) { gem::srgb_to_linear(pixels, out, policy); });
+    check([&](auto& o, gem::execution::policy p) { gem::srgb_to_linear(pixels, o, p); }, [&](std::size_t i) { return gem::srgb_to_linear(pixels[i]); });
+
+    run("linear_to_srgb RGBA8", count, mixed_bytes, iterations, [&](gem::execution::policy policy) { gem::linear_to_srgb(colors, packed, policy); });
+    check_packed([&](auto& o, gem::execution::policy p) { gem::linear_to_srgb(colors, o, p); }, [&](std::size_t i) { return gem::linear_to_srgb8(colors[i]); });
+
+    run("tonemap_reinhard", count, float_bytes, iterations, [&](gem::execution::policy policy) { gem::tonemap_reinhard(hdr, out, 4.0f, policy); });
+    check([&](auto& o, gem::execution::policy p) { gem::tonemap_reinhard(hdr, o, 4.0f, p); }, [&](std::size_t i) { return gem::tonemap_reinhard(hdr[i], 4.0f); });
+
+    run("tonemap_aces", count, float_bytes, iterations, [&](gem::execution::policy policy) { gem::tonemap_aces(hdr, out, policy); });
+    check([&](auto& o, gem::execution::policy p) { gem::tonemap_aces(hdr, o, p); }, [&](std::size_t i) { return gem::tonemap_aces(hdr[i]); });
+
+    run("premultiply float", count, float_bytes, iterations, [&](gem::execution::policy policy) { gem::premultiply(colors, out, policy); });
+    check([&](auto& o, gem::execution::policy p) { gem::premultiply(colors, o, p); }, [&](std::size_t i) { return gem::premultiply(colors[i]); });
+
+    run("unpremultiply float", count, float_bytes, iterations, [&](gem::execution::policy policy) { gem::unpremultiply(colors, out, policy); });
+    check([&](auto& o, gem::execution::policy p) { gem::unpremultiply(colors, o, p); }, [&](std::size_t i) { return gem::unpremultiply(colors[i]); });
+
+    run("premultiply RGBA8", count, 2 * sizeof(gem::u8vec4), iterations, [&](gem::execution::policy policy) { gem::premultiply(pixels, packed, policy); });
+    check_packed([&](auto& o, gem::execution::policy p) { gem::premultiply(pixels, o, p); }, [&](std::size_t i) { return gem::premultiply(pixels[i]); });
+
+    run("unpremultiply RGBA8", count, 2 * sizeof(gem::u8vec4), iterations, [&](gem::execution::policy policy) { gem::unpremultiply(pixels, packed, policy); });
+    check_packed([&](auto& o, gem::execution::policy p) { gem::unpremultiply(pixels, o, p); }, [&](std::size_t i) { return gem::unpremultiply(pixels[i]); });
+
+    // Every 8-bit pixel pair through the packed alpha kernels, and a strided image
+    std::vector<gem::u8vec4> all(256 * 256), all_out(256 * 256);
+    for (std::size_t i = 0; i < all.size(); i++)
+        all[i] = gem::u8vec4(static_cast<gem::uint8>(i & 255), static_cast<gem::uint8>(255 - (i & 255)), static_cast<gem::uint8>(i >> 3), static_cast<gem::uint8>(i >> 8));
+    gem::premultiply(all, all_out);
+    for (std::size_t i = 0; i < all.size(); i++)
+        mismatches += all_out[i] != gem::premultiply(all[i]);
+    gem::unpremultiply(all, all_out);
+    for (std::size_t i = 0; i < all.size(); i++)
+        mismatches += all_out[i] != gem::unpremultiply(all[i]);
+
+    std::fill(out.begin(), out.end(), gem::vec4<float>());
+    gem::tonemap_aces(gem::image_view<const gem::vec4<float>>{ hdr.data(), 1000, 1000, 1024 }, gem::image_view<gem::vec4<float>>{ out.data(), 1000, 1000, 1024 },
+                      gem::execution::parallel_policy{ 4 });
+    for (std::size_t y = 0; y < 1024; y++)
+        for (std::size_t x = 0; x < 1024; x++)
+            mismatches += out[y * 1024 + x] != (x < 1000 && y < 1000 ? gem::tonemap_aces(hdr[y * 1024 + x]) : gem::vec4<float>());
+
+    // Accuracy of the fast curves over every float in [0, 1] step 2^-20
+    double decode_error[2] = {}, encode_error[2] = {};
+    for (std::uint32_t k = 0; k <= (1u << 20); k++)
+    {
+        float v = static_cast<float>(k) / static_cast<float>(1u << 20);
+        gem::vec3<float> l = gem::srgb_to_linear(gem::vec3<float>(v, v, v)), ll = gem::srgb_to_linear<gem::fast::accuracy::low>(gem::vec3<float>(v, v, v));
+        gem::vec3<float> s = gem::linear_to_srgb(gem::vec3<float>(v, v, v)), sl = gem::linear_to_srgb<gem::fast::accuracy::low>(gem::vec3<float>(v, v, v));
+        decode_error[0] = std::max(decode_error[0], std::abs(l.x - exact_srgb_to_linear(v)));
+        decode_error[1] = std::max(decode_error[1], std::abs(ll.x - exact_srgb_to_linear(v)));
+        encode_error[0] = std::max(encode_error[0], std::abs(s.x - exact_linear_to_srgb(v)));
+        encode_error[1] = std::max(encode_error[1], std::abs(sl.x - exact_linear_to_srgb(v)));
+    }
+    std::printf("max error, srgb_to_linear: %g (low %g), linear_to_srgb: %g (low %g)\n", decode_error[0], decode_error[1], encode_error[0], encode_error[1]);
+
+    // The 8-bit encode over every float in [2^-13, 1) against exact rounding, everything outside clamps
+    std::size_t encode_off = 0, encode_far = 0, encoded = 0;
+    for (std::uint32_t bits = (127 - 13) << 23; bits < 0x3f800000; bits++, encoded++)
+    {
+        float v = std::bit_cast<float>(bits);
+        int difference = gem::linear_to_srgb8(gem::vec4<float>(v, v, v, 1.0f)).x - static_cast<int>(std::lrint(exact_linear_to_srgb(v) * 255.0));
+        encode_off += difference != 0;
+        encode_far += difference < -1 || difference > 1;
+    }
+    std::printf("8-bit encodes off by one from exact rounding: %zu of %zu, off by more: %zu\n", encode_off, encoded, encode_far);
+    mismatches += encode_far;
+
+    // Out of range inputs clamp the same way in the batch
+    const float nan = std::numeric_limits<float>::quiet_NaN(), inf = std::numeric_limits<float>::infinity();
+    std::vector<gem::vec4<float>> edges = { { -1.0f, 0.0f, 1.0e-30f, nan }, { 1.0f, 2.0f, inf, -inf }, { nan, 0.00012f, 0.999999f, 1.0f },
+                                            { -0.0f, 1.0e-4f, 0.5f, 0.0f }, { 0.0031308f, 0.04045f, 0.2f, 0.7f } };
+    std::vector<gem::u8vec4> edges_out(edges.size());
+    gem::linear_to_srgb(edges, edges_out);
+    for (std::size_t i = 0; i < edges.size(); i++)
+        mismatches += edges_out[i] != gem::linear_to_srgb8(edges[i]);
+    mismatches += gem::linear_to_srgb8(edges[1]) != gem::u8vec4(255, 255, 255, 0);
+
+    std::printf("mismatches against scalar references: %zu\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
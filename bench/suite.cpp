@@ -0,0 +1,353 @@
+// Microbenchmarks of every vec, mat4, affine3 and quaternion operation and of the geometry tests, in float and double
+// Each operation runs over 1024 independent inputs that stay in cache and reports ns/op, M op/s and cycles/op
+// (time stamp counter ticks, see bench::ticks_per_ns). Results can be stored and compared against later runs:
+//   gem-bench-suite [--filter text] [--quick] [--json file] [--baseline file] [--max-regression percent]
+// --json writes the results, --baseline reads a file written by --json and prints the change of every operation,
+// --max-regression fails the run when an operation got slower than that. Passing the results of a GEM_NO_SIMD build
+// as the baseline compares the scalar and SIMD builds (the bench-check and bench-simd-vs-scalar CMake targets)
+#include <gem_math.hpp>
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+    const char* simd_level()
+    {
+#if defined(GEM_AVX2)
+        return "avx2";
+#elif defined(GEM_SSE)
+        return "sse2";
+#else
+        return "none";
+#endif
+    }
+
+    struct options
+    {
+        const char* filter = nullptr;
+        const char* json = nullptr;
+        const char* baseline = nullptr;
+        double max_regression = -1.0;   // percent, negative only reports the changes
+        bool quick = false;
+    };
+
+    struct result
+    {
+        std::string name;
+        double ns = 0.0;
+        double cycles = 0.0;
+    };
+
+    // Name and ns of every result line of a file written by write_json
+    std::map<std::string, double> read_json(const char* path)
+    {
+        std::map<std::string, double> results;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::size_t name = line.find("\"name\": \"");
+            std::size_t ns = line.find("\"ns\": ");
+            if (name == std::string::npos || ns == std::string::npos)
+                continue;
+            name += 9;
+            results[line.substr(name, line.find('"', name) - name)] = std::strtod(line.c_str() + ns + 6, nullptr);
+        }
+        return results;
+    }
+
+    bool write_json(const char* path, const std::vector<result>& results)
+    {
+        std::FILE* file = std::fopen(path, "w");
+        if (!file)
+            return false;
+
+        std::fprintf(file, "{\n  \"simd\": \"%s\",\n  \"results\": [\n", simd_level());
+        for (std::size_t i = 0; i < results.size(); i++)
+            std::fprintf(file, "    { \"name\": \"%s\", \"ns\": %.6g, \"cycles\": %.6g }%s\n", results[i].name.c_str(), results[i].ns,
+                         results[i].cycles, i + 1 < results.size() ? "," : "");
+        std::fprintf(file, "  ]\n}\n");
+        return std::fclose(file) == 0;
+    }
+
+    class suite
+    {
+    public:
+        static constexpr std::size_t count = 1024;
+
+        explicit suite(const options& opts)
+            : opts(opts)
+        {
+            if (opts.baseline)
+                baseline = read_json(opts.baseline);
+        }
+
+        // Times out[i] = op(i) over every input, bools are stored as bytes
+        template<typename Op>
+        void run(const std::string& name, Op&& op)
+        {
+            if (opts.filter && name.find(opts.filter) == std::string::npos)
+                return;
+
+            using value = decltype(op(std::size_t(0)));
+            std::vector<std::conditional_t<std::is_same_v<value, bool>, unsigned char, value>> out(count);
+            double ns = bench::best_of(opts.quick ? 2 : 200, [&] {
+                for (std::size_t i = 0; i < count; i++)
+                    out[i] = op(i);
+                bench::do_not_optimize(out);
+            }) / count;
+
+            result r{ name, ns, ns * bench::ticks_per_ns() };
+            std::printf("%-44s %9.3f ns/op %9.1f M op/s %8.2f cycles", name.c_str(), r.ns, 1e3 / r.ns, r.cycles);
+
+            auto previous = baseline.find(name);
+            if (previous != baseline.end() && previous->second > 0.0)
+            {
+                double change = (ns / previous->second - 1.0) * 100.0;
+                bool regressed = opts.max_regression >= 0.0 && change > opts.max_regression;
+                regressions += regressed;
+                std::printf(" %+8.1f%% (%.3f)%s", change, previous->second, regressed ? " REGRESSION" : "");
+            }
+            std::printf("\n");
+            results.push_back(r);
+        }
+
+        const options& opts;
+        std::map<std::string, double> baseline;
+        std::vector<result> results;
+        std::size_t regressions = 0;
+    };
+
+    // Every operation shared by vec2, vec3 and vec4
+    template<typename V, typename T>
+    void run_vector(suite& s, const std::string& kind, const std::vector<V>& a, const std::vector<V>& b, const std::vector<T>& k)
+    {
+        s.run(kind + " + vec", [&](std::size_t i) { return a[i] + b[i]; });
+        s.run(kind + " - vec", [&](std::size_t i) { return a[i] - b[i]; });
+        s.run(kind + " * vec", [&](std::size_t i) { return a[i] * b[i]; });
+        s.run(kind + " / vec", [&](std::size_t i) { return a[i] / b[i]; });
+        s.run(kind + " + scalar", [&](std::size_t i) { return a[i] + k[i]; });
+        s.run(kind + " - scalar", [&](std::size_t i) { return a[i] - k[i]; });
+        s.run(kind + " * scalar", [&](std::size_t i) { return a[i] * k[i]; });
+        s.run(kind + " / scalar", [&](std::size_t i) { return a[i] / k[i]; });
+        s.run(kind + " +=", [&](std::size_t i) { V v = a[i]; v += b[i]; return v; });
+        s.run(kind + " ==", [&](std::size_t i) { return a[i] == b[i]; });
+        s.run(kind + " magnitude", [&](std::size_t i) { return a[i].magnitude(); });
+        s.run(kind + " normalized", [&](std::size_t i) { return a[i].normalized(); });
+        s.run(kind + " normalize_fast", [&](std::size_t i) { return gem::normalize_fast(a[i]); });
+        s.run(kind + " dot", [&](std::size_t i) { return gem::dot(a[i], b[i]); });
+        s.run(kind + " distance", [&](std::size_t i) { return gem::distance(a[i], b[i]); });
+        s.run(kind + " distance_squared", [&](std::size_t i) { return gem::distance_squared(a[i], b[i]); });
+        s.run(kind + " angle", [&](std::size_t i) { return gem::angle(a[i], b[i]); });
+        s.run(kind + " angle_fast", [&](std::size_t i) { return gem::angle_fast(a[i], b[i]); });
+    }
+
+    template<typename T>
+    void run_type(suite& s, const char* type)
+    {
+        using gem::vec2;
+        using gem::vec3;
+        using gem::vec4;
+        using gem::mat4;
+        using gem::affine3;
+        using gem::quaternion;
+
+        const std::size_t count = suite::count;
+        auto name = [&](const char* kind) { return std::string(kind) + "<" + type + ">"; };
+        auto value = [](bench::lcg<double>& rng) { return static_cast<T>(rng.next()); };
+
+        bench::lcg<double> rng{ 4242 };
+        std::vector<T> k(count), t(count), degrees(count);
+        std::vector<vec2<T>> a2(count), b2(count);
+        std::vector<vec3<T>> a3(count), b3(count), c3(count);
+        std::vector<vec4<T>> a4(count), b4(count);
+        std::vector<mat4<T>> ma(count), mb(count);
+        std::vector<affine3<T>> aa(count), ab(count);
+        std::vector<quaternion<T>> qa(count), qb(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            k[i] = static_cast<T>(1.0 + rng.next() * 0.5);
+            t[i] = static_cast<T>(0.5 + rng.next() * 0.5);
+            degrees[i] = static_cast<T>(rng.next() * 180.0);
+            a2[i] = vec2<T>(value(rng), value(rng)) * 10;
+            b2[i] = vec2<T>(value(rng), value(rng)) * 10;
+            a3[i] = vec3<T>(value(rng), value(rng), value(rng)) * 10;
+            b3[i] = vec3<T>(value(rng), value(rng), value(rng)) * 10;
+            c3[i] = b3[i].normalized();
+            a4[i] = vec4<T>(value(rng), value(rng), value(rng), value(rng)) * 10;
+            b4[i] = vec4<T>(value(rng), value(rng), value(rng), value(rng)) * 10;
+            ma[i] = mat4<T>::translate(a3[i]) * mat4<T>::rotation(c3[i], degrees[i]) * mat4<T>::scale(vec3<T>(k[i]));
+            mb[i] = mat4<T>::rotation(a3[i].normalized(), degrees[i]) * mat4<T>::translate(b3[i]);
+            aa[i] = affine3<T>::translate(a3[i]) * affine3<T>::rotation(c3[i], degrees[i]);
+            ab[i] = affine3<T>::rotation(a3[i].normalized(), degrees[i]) * affine3<T>::scale(vec3<T>(k[i]));
+            qa[i] = quaternion<T>(c3[i], degrees[i] * static_cast<T>(0.0174532925199432958));
+            qb[i] = quaternion<T>(a3[i].normalized(), static_cast<T>(rng.next() * 3.14159265358979323846));
+        }
+
+        run_vector(s, name("vec2"), a2, b2, k);
+        run_vector(s, name("vec3"), a3, b3, k);
+        s.run(name("vec3") + " cross", [&](std::size_t i) { return gem::cross(a3[i], b3[i]); });
+        run_vector(s, name("vec4"), a4, b4, k);
+
+        std::string m = name("mat4");
+        s.run(m + " * mat4", [&](std::size_t i) { return ma[i] * mb[i]; });
+        s.run(m + " * vec4", [&](std::size_t i) { return ma[i] * a4[i]; });
+        s.run(m + " concat", [&](std::size_t i) { return mat4<T>::concat(ma[i], mb[i], ma[i ^ 1]); });
+        s.run(m + " determinant", [&](std::size_t i) { return ma[i].determinant(); });
+        s.run(m + " inverse", [&](std::size_t i) { return ma[i].inverse(); });
+        s.run(m + " ==", [&](std::size_t i) { return ma[i] == mb[i]; });
+        s.run(m + " translate", [&](std::size_t i) { return mat4<T>::translate(a3[i]); });
+        s.run(m + " rotation", [&](std::size_t i) { return mat4<T>::rotation(c3[i], degrees[i]); });
+        s.run(m + " scale", [&](std::size_t i) { return mat4<T>::scale(a3[i]); });
+        s.run(m + " perspective", [&](std::size_t i) { return mat4<T>::perspective(60 + degrees[i] * static_cast<T>(0.1), k[i], static_cast<T>(0.1), 100); });
+        s.run(m + " orthographic", [&](std::size_t i) { return mat4<T>::orthographic(-k[i], k[i], -t[i], t[i]); });
+
+        std::string f = name("affine3");
+        s.run(f + " * affine3", [&](std::size_t i) { return aa[i] * ab[i]; });
+        s.run(f + " * vec4", [&](std::size_t i) { return aa[i] * a4[i]; });
+        s.run(f + " transform_point", [&](std::size_t i) { return aa[i].transform_point(a3[i]); });
+        s.run(f + " transform_direction", [&](std::size_t i) { return aa[i].transform_direction(a3[i]); });
+        s.run(f + " determinant", [&](std::size_t i) { return ab[i].determinant(); });
+        s.run(f + " inverse", [&](std::size_t i) { return ab[i].inverse(); });
+        s.run(f + " inverse_orthonormal", [&](std::size_t i) { return aa[i].inverse_orthonormal(); });
+        s.run(f + " inverse_scaled", [&](std::size_t i) { return ab[i].inverse_scaled(); });
+        s.run(f + " to_mat4", [&](std::size_t i) { return aa[i].to_mat4(); });
+        s.run(f + " rotation", [&](std::size_t i) { return affine3<T>::rotation(c3[i], degrees[i]); });
+
+        std::string q = name("quaternion");
+        s.run(q + " * quaternion", [&](std::size_t i) { return qa[i] * qb[i]; });
+        s.run(q + " + quaternion", [&](std::size_t i) { return qa[i] + qb[i]; });
+        s.run(q + " - quaternion", [&](std::size_t i) { return qa[i] - qb[i]; });
+        s.run(q + " magnitude", [&](std::size_t i) { return qa[i].magnitude(); });
+        s.run(q + " normalized", [&](std::size_t i) { return qa[i].normalized(); });
+        s.run(q + " conjugated", [&](std::size_t i) { return qa[i].conjugated(); });
+        s.run(q + " dot", [&](std::size_t i) { return qa[i].dot(qb[i]); });
+        s.run(q + " rotate", [&](std::size_t i) { return qa[i].rotate(a3[i]); });
+        s.run(q + " nlerp", [&](std::size_t i) { return quaternion<T>::nlerp(qa[i], qb[i], t[i]); });
+        s.run(q + " slerp", [&](std::size_t i) { return quaternion<T>::slerp(qa[i], qb[i], t[i]); });
+        s.run(q + " slerp_fast", [&](std::size_t i) { return quaternion<T>::slerp_fast(qa[i], qb[i], t[i]); });
+        s.run(q + " to_mat4", [&](std::size_t i) { return qa[i].to_mat4(); });
+        s.run(q + " to_mat4_unit", [&](std::size_t i) { return qa[i].to_mat4_unit(); });
+        s.run(q + " (axis, angle)", [&](std::size_t i) { return quaternion<T>(c3[i], degrees[i]); });
+        s.run(q + " from_euler_angles", [&](std::size_t i) { return quaternion<T>::from_euler_angles(a3[i]); });
+        s.run(q + " from_euler_angles_fast", [&](std::size_t i) { return quaternion<T>::from_euler_angles_fast(a3[i]); });
+    }
+
+    // The primitives are float only
+    void run_geometry(suite& s)
+    {
+        using gem::vec2;
+        using gem::vec3;
+
+        const std::size_t count = suite::count;
+        bench::lcg<double> rng{ 4242 };
+        auto point = [&](double scale) {
+            return vec3<float>(static_cast<float>(rng.next() * scale), static_cast<float>(rng.next() * scale), static_cast<float>(rng.next() * scale));
+        };
+
+        std::vector<vec3<float>> points(count);
+        std::vector<vec2<float>> points2(count);
+        std::vector<gem::circle> circles(count);
+        std::vector<gem::sphere> spheres(count);
+        std::vector<gem::aabb> boxes(count);
+        std::vector<gem::obb> oriented(count);
+        std::vector<gem::plane> planes(count);
+        std::vector<gem::capsule> capsules(count);
+        std::vector<gem::triangle> triangles(count);
+        std::vector<gem::ray> rays(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            points[i] = point(10.0);
+            points2[i] = vec2<float>(points[i].x, points[i].y);
+            float radius = static_cast<float>(2.0 + rng.next());
+            circles[i] = gem::circle{ radius, vec2<float>(static_cast<float>(rng.next() * 5.0), static_cast<float>(rng.next() * 5.0)) };
+            spheres[i] = gem::sphere{ radius, point(5.0) };
+            vec3<float> center = point(5.0), extent = point(1.0) + 2.0f;
+            boxes[i] = gem::aabb{ center - extent, center + extent };
+            gem::quaternion<float> rotation(point(1.0).normalized(), static_cast<float>(rng.next() * 3.14159265358979323846));
+            oriented[i] = gem::obb{ center, extent, { rotation.rotate(vec3<float>(1.0f, 0.0f, 0.0f)), rotation.rotate(vec3<float>(0.0f, 1.0f, 0.0f)),
+                                                      rotation.rotate(vec3<float>(0.0f, 0.0f, 1.0f)) } };
+            planes[i] = gem::plane{ point(1.0).normalized(), static_cast<float>(rng.next() * 5.0) };
+            capsules[i] = gem::capsule{ point(5.0), point(5.0), radius };
+            triangles[i] = gem::triangle{ point(5.0), point(5.0), point(5.0) };
+            rays[i] = gem::ray(point(10.0), point(1.0).normalized());
+        }
+
+        s.run("geometry point_in_circle", [&](std::size_t i) { return gem::point_in_circle(points2[i], circles[i]); });
+        s.run("geometry circle_in_circle", [&](std::size_t i) { return gem::circle_in_circle(circles[i], circles[i ^ 1]); });
+        s.run("geometry point_in_sphere", [&](std::size_t i) { return gem::point_in_sphere(points[i], spheres[i]); });
+        s.run("geometry sphere_in_sphere", [&](std::size_t i) { return gem::sphere_in_sphere(spheres[i], spheres[i ^ 1]); });
+        s.run("geometry point_in_aabb", [&](std::size_t i) { return gem::point_in_aabb(points[i], boxes[i]); });
+        s.run("geometry aabb_in_aabb", [&](std::size_t i) { return gem::aabb_in_aabb(boxes[i], boxes[i ^ 1]); });
+        s.run("geometry sphere_in_aabb", [&](std::size_t i) { return gem::sphere_in_aabb(spheres[i], boxes[i]); });
+        s.run("geometry point_in_obb", [&](std::size_t i) { return gem::point_in_obb(points[i], oriented[i]); });
+        s.run("geometry signed_distance", [&](std::size_t i) { return gem::signed_distance(planes[i], points[i]); });
+        s.run("geometry point_in_capsule", [&](std::size_t i) { return gem::point_in_capsule(points[i], capsules[i]); });
+        s.run("geometry sphere_in_capsule", [&](std::size_t i) { return gem::sphere_in_capsule(spheres[i], capsules[i]); });
+
+        // Distance on a hit, -1 on a miss
+        s.run("geometry raycast aabb", [&](std::size_t i) { float t; return gem::raycast(rays[i], boxes[i], t) ? t : -1.0f; });
+        s.run("geometry raycast obb", [&](std::size_t i) { float t; return gem::raycast(rays[i], oriented[i], t) ? t : -1.0f; });
+        s.run("geometry raycast plane", [&](std::size_t i) { float t; return gem::raycast(rays[i], planes[i], t) ? t : -1.0f; });
+        s.run("geometry raycast sphere", [&](std::size_t i) { float t; return gem::raycast(rays[i], spheres[i], t) ? t : -1.0f; });
+        s.run("geometry raycast triangle", [&](std::size_t i) { float t; return gem::raycast(rays[i], triangles[i], t) ? t : -1.0f; });
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    options opts;
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--quick") == 0)
+            opts.quick = true;
+        else if (std::strcmp(argv[i], "--filter") == 0 && has_value)
+            opts.filter = argv[++i];
+        else if (std::strcmp(argv[i], "--json") == 0 && has_value)
+            opts.json = argv[++i];
+        else if (std::strcmp(argv[i], "--baseline") == 0 && has_value)
+            opts.baseline = argv[++i];
+        else if (std::strcmp(argv[i], "--max-regression") == 0 && has_value)
+            opts.max_regression = std::strtod(argv[++i], nullptr);
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--filter text] [--quick] [--json file] [--baseline file] [--max-regression percent]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    suite s(opts);
+    if (opts.baseline && s.baseline.empty())
+    {
+        std::fprintf(stderr, "no results in baseline %s\n", opts.baseline);
+        return 2;
+    }
+
+    std::printf("gem-bench-suite, SIMD: %s, %.3f ticks/ns\n", simd_level(), bench::ticks_per_ns());
+    run_type<float>(s, "float");
+    run_type<double>(s, "double");
+    run_geometry(s);
+
+    if (opts.json && !write_json(opts.json, s.results))
+    {
+        std::fprintf(stderr, "could not write %s\n", opts.json);
+        return 2;
+    }
+    if (s.regressions > 0)
+    {
+        std::printf("%zu operations regressed by more than %g%%\n", s.regressions, opts.max_regression);
+        return 1;
+    }
+    return 0;
+}
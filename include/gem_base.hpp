@@ -14,6 +14,23 @@
 	#define GEM_OTHER_PLAT
 #endif // End of platform detection
 
+// SIMD detection
+// Define GEM_NO_SIMD to force the scalar code paths
+#ifndef GEM_NO_SIMD
+	#if defined(__AVX2__)
+		#define GEM_AVX2
+	#endif
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define GEM_SSE
+	#endif
+#endif // End of SIMD detection
+
+#if defined(GEM_AVX2)
+	#include <immintrin.h>
+#elif defined(GEM_SSE)
+	#include <emmintrin.h>
+#endif
+
 namespace gem {
 
     typedef char                int8;
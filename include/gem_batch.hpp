@@ -0,0 +1,1048 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_BATCH_HPP
+#define GEM_BATCH_HPP
+
+#include "gem_math.hpp"
+#include "gem_simd.hpp"
+#include "gem_parallel.hpp"
+
+// std
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+// Batch transforms
+// Every kernel computes exactly what mat4::multiply(vec4) computes for each element,
+// the SIMD paths (AVX2 / SSE, chosen at compile time, for float and double) use the same
+// operation order as the scalar fallback so results match when floating point contraction is disabled
+// Batches that write one result per element take an execution policy last (gem_parallel.hpp) and split large
+// arrays over the job system. Overlap queries, raycasts and hit lists stay on the calling thread, their output is ordered
+namespace gem {
+
+    // Structure of arrays views, every stream holds count elements
+    template<typename T>
+    struct soa3
+    {
+        T* x = nullptr;
+        T* y = nullptr;
+        T* z = nullptr;
+        std::size_t count = 0;
+
+        operator soa3<const T>() const requires (!std::is_const_v<T>)
+        {
+            return { x, y, z, count };
+        }
+    };
+
+    template<typename T>
+    struct soa4
+    {
+        T* x = nullptr;
+        T* y = nullptr;
+        T* z = nullptr;
+        T* w = nullptr;
+        std::size_t count = 0;
+
+        operator soa4<const T>() const requires (!std::is_const_v<T>)
+        {
+            return { x, y, z, w, count };
+        }
+    };
+
+    namespace detail {
+
+        // Slices are multiples of this many elements, so every slice but the last one has no scalar tail
+        inline constexpr std::size_t batch_granularity = 64;
+
+        // function(begin, end) over [0, count) elements, item_bytes read and written per element
+        template<typename Function>
+        void batch_for(std::size_t count, std::size_t item_bytes, execution::policy policy, Function&& function)
+        {
+            parallel_batch(count, item_bytes, batch_granularity, policy, function);
+        }
+
+        // kernel.template operator()<P>(i) on element blocks of [begin, end), see simd::for_each_block
+        template<typename T, typename Kernel>
+        void range_blocks(std::size_t begin, std::size_t end, Kernel&& kernel)
+        {
+            simd::for_each_block<T>(end - begin, [&]<typename P>(std::size_t i) { kernel.template operator()<P>(begin + i); });
+        }
+
+        // Same over [0, count), split like batch_for
+        template<typename T, typename Kernel>
+        void batch_blocks(std::size_t count, std::size_t item_bytes, execution::policy policy, Kernel&& kernel)
+        {
+            batch_for(count, item_bytes, policy, [&](std::size_t begin, std::size_t end) { range_blocks<T>(begin, end, kernel); });
+        }
+
+        // One output component, same order of operations as mat4::multiply(vec4)
+        template<typename T>
+        inline T transform_lane(const T* row, T x, T y, T z, T w)
+        {
+            return row[0] * x + row[1] * y + row[2] * z + row[3] * w;
+        }
+
+        // SoA kernel, if w is null every element uses w_value instead
+        // If ow is null the w component is not written
+        template<typename T>
+        void transform_soa(const T* m, const T* x, const T* y, const T* z, const T* w, T w_value,
+                           T* ox, T* oy, T* oz, T* ow, std::size_t count)
+        {
+            std::size_t i = 0;
+
+            if constexpr (std::is_same_v<T, float>)
+            {
+#if defined(GEM_AVX2)
+                __m256 r[16];
+                for (int32 e = 0; e < 16; e++)
+                    r[e] = _mm256_set1_ps(m[e]);
+                const __m256 wc = _mm256_set1_ps(w_value);
+
+                for (; i + 8 <= count; i += 8)
+                {
+                    __m256 vx = _mm256_loadu_ps(x + i);
+                    __m256 vy = _mm256_loadu_ps(y + i);
+                    __m256 vz = _mm256_loadu_ps(z + i);
+                    __m256 vw = w ? _mm256_loadu_ps(w + i) : wc;
+
+                    __m256 out[4];
+                    for (int32 c = 0; c < 4; c++)
+                    {
+                        __m256 acc = _mm256_add_ps(_mm256_mul_ps(r[c * 4 + 0], vx), _mm256_mul_ps(r[c * 4 + 1], vy));
+                        acc = _mm256_add_ps(acc, _mm256_mul_ps(r[c * 4 + 2], vz));
+                        out[c] = _mm256_add_ps(acc, _mm256_mul_ps(r[c * 4 + 3], vw));
+                    }
+
+                    _mm256_storeu_ps(ox + i, out[0]);
+                    _mm256_storeu_ps(oy + i, out[1]);
+                    _mm256_storeu_ps(oz + i, out[2]);
+                    if (ow)
+                        _mm256_storeu_ps(ow + i, out[3]);
+                }
+#endif
+#if defined(GEM_SSE)
+                __m128 q[16];
+                for (int32 e = 0; e < 16; e++)
+                    q[e] = _mm_set1_ps(m[e]);
+                const __m128 qwc = _mm_set1_ps(w_value);
+
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m128 vx = _mm_loadu_ps(x + i);
+                    __m128 vy = _mm_loadu_ps(y + i);
+                    __m128 vz = _mm_loadu_ps(z + i);
+                    __m128 vw = w ? _mm_loadu_ps(w + i) : qwc;
+
+                    __m128 out[4];
+                    for (int32 c = 0; c < 4; c++)
+                    {
+                        __m128 acc = _mm_add_ps(_mm_mul_ps(q[c * 4 + 0], vx), _mm_mul_ps(q[c * 4 + 1], vy));
+                        acc = _mm_add_ps(acc, _mm_mul_ps(q[c * 4 + 2], vz));
+                        out[c] = _mm_add_ps(acc, _mm_mul_ps(q[c * 4 + 3], vw));
+                    }
+
+                    _mm_storeu_ps(ox + i, out[0]);
+                    _mm_storeu_ps(oy + i, out[1]);
+                    _mm_storeu_ps(oz + i, out[2]);
+                    if (ow)
+                        _mm_storeu_ps(ow + i, out[3]);
+                }
+#endif
+            }
+            else if constexpr (std::is_same_v<T, double> && simd::pack<T>::width > 1)
+            {
+                // 4 (AVX2) or 2 (SSE) doubles per register
+                using P = simd::pack<T>;
+                P r[16];
+                for (int32 e = 0; e < 16; e++)
+                    r[e] = P::broadcast(m[e]);
+
+                for (; i + P::width <= count; i += P::width)
+                {
+                    P vx = P::load(x + i), vy = P::load(y + i), vz = P::load(z + i);
+                    P vw = w ? P::load(w + i) : P::broadcast(w_value);
+
+                    (r[0] * vx + r[1] * vy + r[2] * vz + r[3] * vw).store(ox + i);
+                    (r[4] * vx + r[5] * vy + r[6] * vz + r[7] * vw).store(oy + i);
+                    (r[8] * vx + r[9] * vy + r[10] * vz + r[11] * vw).store(oz + i);
+                    if (ow)
+                        (r[12] * vx + r[13] * vy + r[14] * vz + r[15] * vw).store(ow + i);
+                }
+            }
+
+            // Scalar fallback and tail
+            for (; i < count; i++)
+            {
+                T vx = x[i], vy = y[i], vz = z[i];
+                T vw = w ? w[i] : w_value;
+                ox[i] = transform_lane(m + 0, vx, vy, vz, vw);
+                oy[i] = transform_lane(m + 4, vx, vy, vz, vw);
+                oz[i] = transform_lane(m + 8, vx, vy, vz, vw);
+                if (ow)
+                    ow[i] = transform_lane(m + 12, vx, vy, vz, vw);
+            }
+        }
+
+#if defined(GEM_SSE)
+        // Matrix columns as used by the AoS kernels, out = x * c[0] + y * c[1] + z * c[2] + w * c[3]
+        inline void load_transposed(const float* m, __m128 c[4])
+        {
+            for (int32 j = 0; j < 4; j++)
+                c[j] = _mm_setr_ps(m[j], m[j + 4], m[j + 8], m[j + 12]);
+        }
+#endif
+
+        // AoS vec3 kernel, w_value is 1 for points and 0 for directions
+        template<typename T>
+        void transform_aos3(const T* m, const vec3<T>* in, vec3<T>* out, T w_value, std::size_t count)
+        {
+            std::size_t i = 0;
+
+            if constexpr (std::is_same_v<T, float>)
+            {
+#if defined(GEM_SSE)
+                __m128 q[16];
+                for (int32 e = 0; e < 16; e++)
+                    q[e] = _mm_set1_ps(m[e]);
+                const __m128 vw = _mm_set1_ps(w_value);
+
+                // 4 vec3 per iteration, deinterleaved to x, y, z lanes
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m128 vx, vy, vz;
+                    simd::load_vec3x4(&in[i].x, vx, vy, vz);
+
+                    __m128 o[3];
+                    for (int32 c = 0; c < 3; c++)
+                    {
+                        __m128 acc = _mm_add_ps(_mm_mul_ps(q[c * 4 + 0], vx), _mm_mul_ps(q[c * 4 + 1], vy));
+                        acc = _mm_add_ps(acc, _mm_mul_ps(q[c * 4 + 2], vz));
+                        o[c] = _mm_add_ps(acc, _mm_mul_ps(q[c * 4 + 3], vw));
+                    }
+
+                    simd::store_vec3x4(&out[i].x, o[0], o[1], o[2]);
+                }
+#endif
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+#if defined(GEM_AVX2)
+                __m256d q[16];
+                for (int32 e = 0; e < 16; e++)
+                    q[e] = _mm256_set1_pd(m[e]);
+                const __m256d vw = _mm256_set1_pd(w_value);
+
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m256d vx, vy, vz;
+                    simd::load_vec3x4(&in[i].x, vx, vy, vz);
+
+                    __m256d o[3];
+                    for (int32 c = 0; c < 3; c++)
+                    {
+                        __m256d acc = _mm256_add_pd(_mm256_mul_pd(q[c * 4 + 0], vx), _mm256_mul_pd(q[c * 4 + 1], vy));
+                        acc = _mm256_add_pd(acc, _mm256_mul_pd(q[c * 4 + 2], vz));
+                        o[c] = _mm256_add_pd(acc, _mm256_mul_pd(q[c * 4 + 3], vw));
+                    }
+
+                    simd::store_vec3x4(&out[i].x, o[0], o[1], o[2]);
+                }
+#endif
+            }
+
+            for (; i < count; i++)
+            {
+                vec3<T> v = in[i];
+                out[i].x = transform_lane(m + 0, v.x, v.y, v.z, w_value);
+                out[i].y = transform_lane(m + 4, v.x, v.y, v.z, w_value);
+                out[i].z = transform_lane(m + 8, v.x, v.y, v.z, w_value);
+            }
+        }
+
+        // AoS vec4 kernel
+        template<typename T>
+        void transform_aos4(const T* m, const vec4<T>* in, vec4<T>* out, std::size_t count)
+        {
+            std::size_t i = 0;
+
+            if constexpr (std::is_same_v<T, float>)
+            {
+#if defined(GEM_SSE)
+                __m128 c[4];
+                load_transposed(m, c);
+#endif
+#if defined(GEM_AVX2)
+                // Two vec4 per register, each 128-bit lane broadcasts its own components
+                __m256 c8[4];
+                for (int32 j = 0; j < 4; j++)
+                    c8[j] = _mm256_set_m128(c[j], c[j]);
+
+                for (; i + 2 <= count; i += 2)
+                {
+                    __m256 v = _mm256_loadu_ps(&in[i].x);
+                    __m256 acc = _mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(v, 0x00), c8[0]),
+                                               _mm256_mul_ps(_mm256_permute_ps(v, 0x55), c8[1]));
+                    acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_permute_ps(v, 0xAA), c8[2]));
+                    acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_permute_ps(v, 0xFF), c8[3]));
+                    _mm256_storeu_ps(&out[i].x, acc);
+                }
+#endif
+#if defined(GEM_SSE)
+                for (; i < count; i++)
+                {
+                    __m128 v = _mm_loadu_ps(&in[i].x);
+                    __m128 acc = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(v, v, 0x00), c[0]),
+                                            _mm_mul_ps(_mm_shuffle_ps(v, v, 0x55), c[1]));
+                    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0xAA), c[2]));
+                    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0xFF), c[3]));
+                    _mm_storeu_ps(&out[i].x, acc);
+                }
+#endif
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+#if defined(GEM_AVX2)
+                // One vec4 per register
+                __m256d c[4];
+                for (int32 j = 0; j < 4; j++)
+                    c[j] = _mm256_setr_pd(m[j], m[j + 4], m[j + 8], m[j + 12]);
+
+                for (; i < count; i++)
+                {
+                    __m256d v = _mm256_loadu_pd(&in[i].x);
+                    __m256d acc = _mm256_add_pd(_mm256_mul_pd(_mm256_permute4x64_pd(v, 0x00), c[0]),
+                                                _mm256_mul_pd(_mm256_permute4x64_pd(v, 0x55), c[1]));
+                    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_permute4x64_pd(v, 0xAA), c[2]));
+                    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_permute4x64_pd(v, 0xFF), c[3]));
+                    _mm256_storeu_pd(&out[i].x, acc);
+                }
+#endif
+            }
+
+            for (; i < count; i++)
+            {
+                vec4<T> v = in[i];
+                out[i].x = transform_lane(m + 0, v.x, v.y, v.z, v.w);
+                out[i].y = transform_lane(m + 4, v.x, v.y, v.z, v.w);
+                out[i].z = transform_lane(m + 8, v.x, v.y, v.z, v.w);
+                out[i].w = transform_lane(m + 12, v.x, v.y, v.z, v.w);
+            }
+        }
+
+    }
+
+    // AoS
+    // in and out may be the same span, the smaller of both sizes is processed
+    template<typename T>
+    void transform(const mat4<T>& mat, std::type_identity_t<std::span<const vec4<T>>> in, std::type_identity_t<std::span<vec4<T>>> out,
+                   execution::policy policy = execution::par)
+    {
+        std::size_t count = in.size() < out.size() ? in.size() : out.size();
+        detail::batch_for(count, 2 * sizeof(vec4<T>), policy, [&](std::size_t begin, std::size_t end) {
+            detail::transform_aos4(mat.elements, in.data() + begin, out.data() + begin, end - begin);
+        });
+    }
+
+    // Positions, w is taken as 1 and no perspective divide is done
+    template<typename T>
+    void transform_points(const mat4<T>& mat, std::type_identity_t<std::span<const vec3<T>>> in, std::type_identity_t<std::span<vec3<T>>> out,
+                          execution::policy policy = execution::par)
+    {
+        std::size_t count = in.size() < out.size() ? in.size() : out.size();
+        detail::batch_for(count, 2 * sizeof(vec3<T>), policy, [&](std::size_t begin, std::size_t end) {
+            detail::transform_aos3(mat.elements, in.data() + begin, out.data() + begin, static_cast<T>(1), end - begin);
+        });
+    }
+
+    // Directions, w is taken as 0 so translation is ignored
+    template<typename T>
+    void transform_directions(const mat4<T>& mat, std::type_identity_t<std::span<const vec3<T>>> in, std::type_identity_t<std::span<vec3<T>>> out,
+                              execution::policy policy = execution::par)
+    {
+        std::size_t count = in.size() < out.size() ? in.size() : out.size();
+        detail::batch_for(count, 2 * sizeof(vec3<T>), policy, [&](std::size_t begin, std::size_t end) {
+            detail::transform_aos3(mat.elements, in.data() + begin, out.data() + begin, static_cast<T>(0), end - begin);
+        });
+    }
+
+    // SoA
+    // out streams may alias the in streams, in.count elements are processed
+    template<typename T>
+    void transform(const mat4<T>& mat, const std::type_identity_t<soa4<const T>>& in, const std::type_identity_t<soa4<T>>& out,
+                   execution::policy policy = execution::par)
+    {
+        detail::batch_for(in.count, 8 * sizeof(T), policy, [&](std::size_t b, std::size_t e) {
+            // Null w streams stay null in every chunk
+            detail::transform_soa(mat.elements, in.x + b, in.y + b, in.z + b, in.w ? in.w + b : nullptr, T{}, out.x + b, out.y + b, out.z + b,
+                                  out.w ? out.w + b : nullptr, e - b);
+        });
+    }
+
+    template<typename T>
+    void transform_points(const mat4<T>& mat, const std::type_identity_t<soa3<const T>>& in, const std::type_identity_t<soa3<T>>& out,
+                          execution::policy policy = execution::par)
+    {
+        detail::batch_for(in.count, 6 * sizeof(T), policy, [&](std::size_t b, std::size_t e) {
+            detail::transform_soa<T>(mat.elements, in.x + b, in.y + b, in.z + b, nullptr, static_cast<T>(1), out.x + b, out.y + b, out.z + b, nullptr, e - b);
+        });
+    }
+
+    template<typename T>
+    void transform_directions(const mat4<T>& mat, const std::type_identity_t<soa3<const T>>& in, const std::type_identity_t<soa3<T>>& out,
+                              execution::policy policy = execution::par)
+    {
+        detail::batch_for(in.count, 6 * sizeof(T), policy, [&](std::size_t b, std::size_t e) {
+            detail::transform_soa<T>(mat.elements, in.x + b, in.y + b, in.z + b, nullptr, static_cast<T>(0), out.x + b, out.y + b, out.z + b, nullptr, e - b);
+        });
+    }
+
+    // Camera relative rebasing
+    // Large worlds keep positions in double and render in float around a nearby origin (usually the camera):
+    // out = float(position - origin). The subtraction is done in double, so only the final rounding to
+    // float is lost and positions close to origin keep full float precision wherever origin is
+    namespace detail {
+
+        inline void rebase_stream(const double* in, double origin, float* out, std::size_t count)
+        {
+            std::size_t i = 0;
+#if defined(GEM_AVX2)
+            const __m256d o = _mm256_set1_pd(origin);
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(out + i, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(in + i), o)));
+#elif defined(GEM_SSE)
+            const __m128d o = _mm_set1_pd(origin);
+            for (; i + 2 <= count; i += 2)
+                _mm_storel_pi(reinterpret_cast<__m64*>(out + i), _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(in + i), o)));
+#endif
+            for (; i < count; i++)
+                out[i] = static_cast<float>(in[i] - origin);
+        }
+
+        inline void rebase_aos(const vec3<double>* positions, const vec3<double>& origin, vec3<float>* out, std::size_t count)
+        {
+            std::size_t i = 0;
+#if defined(GEM_AVX2)
+            const __m256d ox = _mm256_set1_pd(origin.x), oy = _mm256_set1_pd(origin.y), oz = _mm256_set1_pd(origin.z);
+            for (; i + 4 <= count; i += 4)
+            {
+                __m256d x, y, z;
+                simd::load_vec3x4(&positions[i].x, x, y, z);
+                simd::store_vec3x4(&out[i].x, _mm256_cvtpd_ps(_mm256_sub_pd(x, ox)), _mm256_cvtpd_ps(_mm256_sub_pd(y, oy)),
+                                   _mm256_cvtpd_ps(_mm256_sub_pd(z, oz)));
+            }
+#endif
+            for (; i < count; i++)
+            {
+                out[i] = vec3<float>(static_cast<float>(positions[i].x - origin.x), static_cast<float>(positions[i].y - origin.y),
+                                     static_cast<float>(positions[i].z - origin.z));
+            }
+        }
+
+    }
+
+    // AoS, the smaller of both sizes is processed
+    inline void to_camera_relative(std::span<const vec3<double>> positions, const vec3<double>& origin, std::span<vec3<float>> out,
+                                   execution::policy policy = execution::par)
+    {
+        std::size_t count = positions.size() < out.size() ? positions.size() : out.size();
+        detail::batch_for(count, sizeof(vec3<double>) + sizeof(vec3<float>), policy, [&](std::size_t begin, std::size_t end) {
+            detail::rebase_aos(positions.data() + begin, origin, out.data() + begin, end - begin);
+        });
+    }
+
+    // SoA, positions.count elements are processed
+    inline void to_camera_relative(const soa3<const double>& positions, const vec3<double>& origin, const soa3<float>& out,
+                                   execution::policy policy = execution::par)
+    {
+        detail::batch_for(positions.count, 3 * (sizeof(double) + sizeof(float)), policy, [&](std::size_t begin, std::size_t end) {
+            detail::rebase_stream(positions.x + begin, origin.x, out.x + begin, end - begin);
+            detail::rebase_stream(positions.y + begin, origin.y, out.y + begin, end - begin);
+            detail::rebase_stream(positions.z + begin, origin.z, out.z + begin, end - begin);
+        });
+    }
+
+    // Affine world matrices (last row 0, 0, 0, 1), the translation is rebased and the rest rounded to float
+    inline void to_camera_relative(std::span<const mat4<double>> world, const vec3<double>& origin, std::span<mat4<float>> out,
+                                   execution::policy policy = execution::par)
+    {
+        std::size_t count = world.size() < out.size() ? world.size() : out.size();
+        detail::batch_for(count, sizeof(mat4<double>) + sizeof(mat4<float>), policy, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++)
+            {
+                const double* in = world[i].elements;
+                for (int32 e = 0; e < 16; e++)
+                    out[i].elements[e] = static_cast<float>(in[e]);
+
+                out[i].elements[3] = static_cast<float>(in[3] - origin.x);
+                out[i].elements[7] = static_cast<float>(in[7] - origin.y);
+                out[i].elements[11] = static_cast<float>(in[11] - origin.z);
+            }
+        });
+    }
+
+    // Quaternion batches
+    // Quaternions are SoA soa4 views (x, y, z, w streams, w is the real part), vectors are soa3 views
+    // Each function computes exactly what the matching quaternion member computes for every element,
+    // float and double run on the widest SIMD pack available (8 or 4 float lanes, 4 or 2 double lanes)
+    enum class blend_accuracy
+    {
+        fast,  // quaternion::slerp_fast, fully SIMD
+        exact, // quaternion::slerp, the acos/sin per lane are scalar
+    };
+
+    namespace detail {
+
+        // a * wa + b * wb, normalized, written to out at i
+        template<typename P>
+        void blend_quaternions(P ax, P ay, P az, P aw, P bx, P by, P bz, P bw, P wa, P wb, const soa4<typename P::value_type>& out, std::size_t i)
+        {
+            P rx = ax * wa + bx * wb;
+            P ry = ay * wa + by * wb;
+            P rz = az * wa + bz * wb;
+            P rw = aw * wa + bw * wb;
+            P inv = P::broadcast(1) / sqrt(rx * rx + ry * ry + rz * rz + rw * rw);
+
+            (rx * inv).store(out.x + i);
+            (ry * inv).store(out.y + i);
+            (rz * inv).store(out.z + i);
+            (rw * inv).store(out.w + i);
+        }
+
+        enum class interpolation { nlerp, slerp_fast, slerp };
+
+        // weights is either null (every element uses weight) or holds one weight per element
+        template<typename T>
+        void interpolate_soa(const soa4<const T>& a, const soa4<const T>& b, const T* weights, T weight, const soa4<T>& out, interpolation mode,
+                             execution::policy policy)
+        {
+            std::size_t item_bytes = (weights ? 13 : 12) * sizeof(T);
+            batch_blocks<T>(a.count, item_bytes, policy, [&]<typename P>(std::size_t i) {
+                using V = typename P::value_type;
+
+                P ax = P::load(a.x + i), ay = P::load(a.y + i), az = P::load(a.z + i), aw = P::load(a.w + i);
+                P bx = P::load(b.x + i), by = P::load(b.y + i), bz = P::load(b.z + i), bw = P::load(b.w + i);
+                P t = weights ? P::load(weights + i) : P::broadcast(weight);
+
+                P d = ax * bx + ay * by + az * bz + aw * bw;
+                P sign = select(d < P::broadcast(0), P::broadcast(-1), P::broadcast(1));
+                d = d * sign;
+
+                P wa, wb;
+                if (mode == interpolation::nlerp)
+                {
+                    wa = P::broadcast(1) - t;
+                    wb = t;
+                }
+                else if (mode == interpolation::slerp_fast)
+                {
+                    P ft = slerp_fast_weight(t, d);
+                    wa = P::broadcast(1) - ft;
+                    wb = ft;
+                }
+                else
+                {
+                    V dl[P::width], tl[P::width], wal[P::width], wbl[P::width];
+                    d.store(dl);
+                    t.store(tl);
+                    for (std::size_t l = 0; l < P::width; l++)
+                    {
+                        wal[l] = 1 - tl[l];
+                        wbl[l] = tl[l];
+                        if (dl[l] < static_cast<V>(0.9995))
+                        {
+                            V theta = std::acos(dl[l]);
+                            V inv_sin = 1 / std::sin(theta);
+                            wal[l] = std::sin(wal[l] * theta) * inv_sin;
+                            wbl[l] = std::sin(tl[l] * theta) * inv_sin;
+                        }
+                    }
+                    wa = P::load(wal);
+                    wb = P::load(wbl);
+                }
+
+                blend_quaternions(ax, ay, az, aw, bx, by, bz, bw, wa, wb * sign, out, i);
+            });
+        }
+
+    }
+
+    // out[i] = nlerp(a[i], b[i], t)
+    template<typename T>
+    void nlerp(const std::type_identity_t<soa4<const T>>& a, const std::type_identity_t<soa4<const T>>& b, T t, const soa4<T>& out,
+               execution::policy policy = execution::par)
+    {
+        detail::interpolate_soa<T>(a, b, nullptr, t, out, detail::interpolation::nlerp, policy);
+    }
+
+    // out[i] = slerp(a[i], b[i], t) or slerp_fast(a[i], b[i], t)
+    template<typename T>
+    void slerp(const std::type_identity_t<soa4<const T>>& a, const std::type_identity_t<soa4<const T>>& b, T t, const soa4<T>& out,
+               blend_accuracy accuracy = blend_accuracy::fast, execution::policy policy = execution::par)
+    {
+        detail::interpolate_soa<T>(a, b, nullptr, t, out, accuracy == blend_accuracy::fast ? detail::interpolation::slerp_fast : detail::interpolation::slerp,
+                                   policy);
+    }
+
+    // Same with one weight per element
+    template<typename T>
+    void slerp(const std::type_identity_t<soa4<const T>>& a, const std::type_identity_t<soa4<const T>>& b, std::type_identity_t<std::span<const T>> t,
+               const soa4<T>& out, blend_accuracy accuracy = blend_accuracy::fast, execution::policy policy = execution::par)
+    {
+        detail::interpolate_soa<T>(a, b, t.data(), T{}, out, accuracy == blend_accuracy::fast ? detail::interpolation::slerp_fast : detail::interpolation::slerp,
+                                   policy);
+    }
+
+    // out[i] = a[i] * b[i], Hamilton product
+    template<typename T>
+    void multiply(const std::type_identity_t<soa4<const T>>& a, const std::type_identity_t<soa4<const T>>& b, const soa4<T>& out,
+                  execution::policy policy = execution::par)
+    {
+        detail::batch_blocks<T>(a.count, 12 * sizeof(T), policy, [&]<typename P>(std::size_t i) {
+            P ax = P::load(a.x + i), ay = P::load(a.y + i), az = P::load(a.z + i), aw = P::load(a.w + i);
+            P bx = P::load(b.x + i), by = P::load(b.y + i), bz = P::load(b.z + i), bw = P::load(b.w + i);
+
+            P rx = aw * bx + ax * bw + ay * bz - az * by;
+            P ry = aw * by - ax * bz + ay * bw + az * bx;
+            P rz = aw * bz + ax * by - ay * bx + az * bw;
+            P rw = aw * bw - ax * bx - ay * by - az * bz;
+
+            rx.store(out.x + i);
+            ry.store(out.y + i);
+            rz.store(out.z + i);
+            rw.store(out.w + i);
+        });
+    }
+
+    // out[i] = q[i].rotate(v[i]), quaternions must be unit
+    template<typename T>
+    void rotate(const std::type_identity_t<soa4<const T>>& q, const std::type_identity_t<soa3<const T>>& v, const soa3<T>& out,
+                execution::policy policy = execution::par)
+    {
+        detail::batch_blocks<T>(q.count, 10 * sizeof(T), policy, [&]<typename P>(std::size_t i) {
+            P x = P::load(q.x + i), y = P::load(q.y + i), z = P::load(q.z + i), w = P::load(q.w + i);
+            P vx = P::load(v.x + i), vy = P::load(v.y + i), vz = P::load(v.z + i);
+            P two = P::broadcast(2);
+
+            P tx = two * (y * vz - z * vy);
+            P ty = two * (z * vx - x * vz);
+            P tz = two * (x * vy - y * vx);
+
+            (vx + w * tx + (y * tz - z * ty)).store(out.x + i);
+            (vy + w * ty + (z * tx - x * tz)).store(out.y + i);
+            (vz + w * tz + (x * ty - y * tx)).store(out.z + i);
+        });
+    }
+
+    namespace detail {
+
+        // Rotation matrices of a block of quaternions, same expressions as quaternion::to_mat4 and to_mat4_unit
+        template<typename T>
+        void quaternions_to_mat4(const soa4<const T>& q, std::span<mat4<T>> out, bool normalize, execution::policy policy)
+        {
+            batch_blocks<T>(q.count, 4 * sizeof(T) + sizeof(mat4<T>), policy, [&]<typename P>(std::size_t i) {
+                P x = P::load(q.x + i), y = P::load(q.y + i), z = P::load(q.z + i), w = P::load(q.w + i);
+                if (normalize)
+                {
+                    P mag = sqrt(x * x + y * y + z * z + w * w);
+                    P inv = P::broadcast(1) / mag;
+                    typename P::mask_type valid = mag > P::broadcast(0);
+                    x = select(valid, x * inv, x);
+                    y = select(valid, y * inv, y);
+                    z = select(valid, z * inv, z);
+                    w = select(valid, w * inv, w);
+                }
+
+                P one = P::broadcast(1), two = P::broadcast(2);
+                P xx = x * x, xy = x * y, xz = x * z, xw = x * w;
+                P yy = y * y, yz = y * z, yw = y * w;
+                P zz = z * z, zw = z * w;
+
+                // Rows of each matrix, written straight from the packs
+                P zero = P::broadcast(0);
+                T* first = out[i].elements;
+                P::store_interleaved4(first + 0, 16, one - two * (yy + zz), two * (xy - zw), two * (xz + yw), zero);
+                P::store_interleaved4(first + 4, 16, two * (xy + zw), one - two * (xx + zz), two * (yz - xw), zero);
+                P::store_interleaved4(first + 8, 16, two * (xz - yw), two * (yz + xw), one - two * (xx + yy), zero);
+                P::store_interleaved4(first + 12, 16, zero, zero, zero, one);
+            });
+        }
+
+    }
+
+    // Matrix palette, out[i] = q[i].to_mat4(), out must hold q.count matrices
+    template<typename T>
+    void to_mat4(const std::type_identity_t<soa4<const T>>& q, std::span<mat4<T>> out, execution::policy policy = execution::par)
+    {
+        detail::quaternions_to_mat4<T>(q, out, true, policy);
+    }
+
+    // Same for unit quaternions, out[i] = q[i].to_mat4_unit()
+    template<typename T>
+    void to_mat4_unit(const std::type_identity_t<soa4<const T>>& q, std::span<mat4<T>> out, execution::policy policy = execution::par)
+    {
+        detail::quaternions_to_mat4<T>(q, out, false, policy);
+    }
+
+    // Rotation batches
+    // Rotations built from angles, for imports and procedural placement that create many at once. The sines
+    // and cosines come from gem::fast::sincos over the widest SIMD pack, the rest uses the same expressions as
+    // the matching scalar function, so every element equals that function with fast::sincos<A> in place of sin and cos
+
+    // out[i] = quaternion<T>::from_euler_angles_fast<A>(euler[i]), angles in radians
+    template<fast::accuracy A = fast::accuracy::high, typename T>
+    void from_euler_angles(const std::type_identity_t<soa3<const T>>& euler, const soa4<T>& out, execution::policy policy = execution::par)
+    {
+        detail::batch_blocks<T>(euler.count, 7 * sizeof(T), policy, [&]<typename P>(std::size_t i) {
+            P half = P::broadcast(static_cast<T>(0.5));
+            P sx, sy, sz, cx, cy, cz;
+            fast::sincos<A>(P::load(euler.x + i) * half, sx, cx);
+            fast::sincos<A>(P::load(euler.y + i) * half, sy, cy);
+            fast::sincos<A>(P::load(euler.z + i) * half, sz, cz);
+
+            (sx * cy * cz - cx * sy * sz).store(out.x + i);
+            (cx * sy * cz + sx * cy * sz).store(out.y + i);
+            (cx * cy * sz - sx * sy * cz).store(out.z + i);
+            (cx * cy * cz + sx * sy * sz).store(out.w + i);
+        });
+    }
+
+    // out[i] = quaternion<T>(axes[i], angles[i]), angles in radians, axes are normalized like the constructor does
+    template<fast::accuracy A = fast::accuracy::high, typename T>
+    void from_axis_angle(const std::type_identity_t<soa3<const T>>& axes, std::type_identity_t<std::span<const T>> angles, const soa4<T>& out,
+                         execution::policy policy = execution::par)
+    {
+        detail::batch_blocks<T>(axes.count, 8 * sizeof(T), policy, [&]<typename P>(std::size_t i) {
+            P s, c;
+            fast::sincos<A>(P::load(angles.data() + i) * P::broadcast(static_cast<T>(0.5)), s, c);
+
+            P x = P::load(axes.x + i), y = P::load(axes.y + i), z = P::load(axes.z + i);
+            P mag = sqrt(x * x + y * y + z * z);
+            P inv = P::broadcast(1) / mag;
+            typename P::mask_type valid = mag > P::broadcast(0);
+            x = select(valid, x * inv, x);
+            y = select(valid, y * inv, y);
+            z = select(valid, z * inv, z);
+
+            (x * s).store(out.x + i);
+            (y * s).store(out.y + i);
+            (z * s).store(out.z + i);
+            c.store(out.w + i);
+        });
+    }
+
+    // out[i] = mat4<T>::rotation(axes[i], angles[i]), angles in degrees and axes unit like mat4::rotation
+    // out must hold axes.count matrices
+    template<fast::accuracy A = fast::accuracy::high, typename T>
+    void rotation(const soa3<const T>& axes, std::type_identity_t<std::span<const T>> angles, std::type_identity_t<std::span<mat4<T>>> out,
+                  execution::policy policy = execution::par)
+    {
+        detail::batch_blocks<T>(axes.count, 4 * sizeof(T) + sizeof(mat4<T>), policy, [&]<typename P>(std::size_t i) {
+            P s, c;
+            fast::sincos<A>(P::load(angles.data() + i) * P::broadcast(static_cast<T>(GEM_DEG_TO_RAD)), s, c);
+            P omc = P::broadcast(1) - c;
+
+            P x = P::load(axes.x + i), y = P::load(axes.y + i), z = P::load(axes.z + i);
+            P zero = P::broadcast(0), one = P::broadcast(1);
+            T* first = out[i].elements;
+            P::store_interleaved4(first + 0, 16, x * x * omc + c, x * y * omc - z * s, x * z * omc + y * s, zero);
+            P::store_interleaved4(first + 4, 16, y * x * omc + z * s, y * y * omc + c, y * z * omc - x * s, zero);
+            P::store_interleaved4(first + 8, 16, x * z * omc - y * s, y * z * omc + x * s, z * z * omc + c, zero);
+            P::store_interleaved4(first + 12, 16, zero, zero, zero, one);
+        });
+    }
+
+    // Overlap batches
+    // One query against N packed circles (x, y, radius) or spheres (x, y, z, radius), or every pair of two sets
+    // Same tests as point_in_circle, circle_in_circle, point_in_sphere and sphere_in_sphere, without sqrt or branches
+    // Results are either hit lists (increasing indices, the span must hold one index per element, the count is returned)
+    // or bitmasks (bit i % 64 of word i / 64, the span must hold (count + 63) / 64 words)
+    struct index_pair
+    {
+        std::uint32_t first;
+        std::uint32_t second;
+    };
+
+    namespace detail {
+
+        // Appends first + lane for every set bit of mask
+        inline std::size_t append_indices(int32 mask, std::size_t first, std::uint32_t* out)
+        {
+            std::size_t count = 0;
+            for (std::uint32_t bits = static_cast<std::uint32_t>(mask); bits != 0; bits &= bits - 1)
+                out[count++] = static_cast<std::uint32_t>(first + std::countr_zero(bits));
+            return count;
+        }
+
+        // Sink for overlap kernels, collects lane masks as indices or bits
+        struct hit_list
+        {
+            std::uint32_t* out;
+            std::size_t count = 0;
+
+            void operator()(std::size_t first, int32 mask) { count += append_indices(mask, first, out + count); }
+        };
+
+        struct hit_mask
+        {
+            std::uint64_t* out;
+
+            // Blocks never straddle a word, their first index is a multiple of the pack width
+            void operator()(std::size_t first, int32 mask) { out[first / 64] |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(mask)) << (first % 64); }
+        };
+
+        // sink(i, mask) for each block of elements within radius of (px, py, pz), dimensions = 2 ignores z
+        // The test is |p - c|^2 <= (radius + r)^2, radius is 0 for point queries
+        template<int32 dimensions, typename Sink>
+        void overlap_soa(float px, float py, float pz, float radius, const float* x, const float* y, const float* z, const float* r,
+                         std::size_t count, Sink& sink)
+        {
+            simd::for_each_block<float>(count, [&]<typename P>(std::size_t i) {
+                P dx = P::broadcast(px) - P::load(x + i);
+                P dy = P::broadcast(py) - P::load(y + i);
+                P d2 = dx * dx + dy * dy;
+                if constexpr (dimensions == 3)
+                {
+                    P dz = P::broadcast(pz) - P::load(z + i);
+                    d2 = d2 + dz * dz;
+                }
+
+                P reach = P::broadcast(radius) + P::load(r + i);
+                sink(i, bits(d2 <= reach * reach));
+            });
+        }
+
+        inline void clear_mask(std::span<std::uint64_t> mask, std::size_t count)
+        {
+            for (std::size_t i = 0; i < (count + 63) / 64; i++)
+                mask[i] = 0;
+        }
+
+    }
+
+    // Circles as x, y = center and z = radius
+    inline std::size_t point_in_circles(const vec2<float>& point, const soa3<const float>& circles, std::span<std::uint32_t> hits)
+    {
+        detail::hit_list sink{ hits.data() };
+        detail::overlap_soa<2>(point.x, point.y, 0.0f, 0.0f, circles.x, circles.y, nullptr, circles.z, circles.count, sink);
+        return sink.count;
+    }
+
+    inline void point_in_circles(const vec2<float>& point, const soa3<const float>& circles, std::span<std::uint64_t> mask)
+    {
+        detail::clear_mask(mask, circles.count);
+        detail::hit_mask sink{ mask.data() };
+        detail::overlap_soa<2>(point.x, point.y, 0.0f, 0.0f, circles.x, circles.y, nullptr, circles.z, circles.count, sink);
+    }
+
+    inline std::size_t circle_in_circles(const circle& query, const soa3<const float>& circles, std::span<std::uint32_t> hits)
+    {
+        detail::hit_list sink{ hits.data() };
+        detail::overlap_soa<2>(query.position.x, query.position.y, 0.0f, query.radius, circles.x, circles.y, nullptr, circles.z, circles.count, sink);
+        return sink.count;
+    }
+
+    inline void circle_in_circles(const circle& query, const soa3<const float>& circles, std::span<std::uint64_t> mask)
+    {
+        detail::clear_mask(mask, circles.count);
+        detail::hit_mask sink{ mask.data() };
+        detail::overlap_soa<2>(query.position.x, query.position.y, 0.0f, query.radius, circles.x, circles.y, nullptr, circles.z, circles.count, sink);
+    }
+
+    // Spheres as x, y, z = center and w = radius
+    inline std::size_t point_in_spheres(const vec3<float>& point, const soa4<const float>& spheres, std::span<std::uint32_t> hits)
+    {
+        detail::hit_list sink{ hits.data() };
+        detail::overlap_soa<3>(point.x, point.y, point.z, 0.0f, spheres.x, spheres.y, spheres.z, spheres.w, spheres.count, sink);
+        return sink.count;
+    }
+
+    inline void point_in_spheres(const vec3<float>& point, const soa4<const float>& spheres, std::span<std::uint64_t> mask)
+    {
+        detail::clear_mask(mask, spheres.count);
+        detail::hit_mask sink{ mask.data() };
+        detail::overlap_soa<3>(point.x, point.y, point.z, 0.0f, spheres.x, spheres.y, spheres.z, spheres.w, spheres.count, sink);
+    }
+
+    inline std::size_t sphere_in_spheres(const sphere& query, const soa4<const float>& spheres, std::span<std::uint32_t> hits)
+    {
+        const vec3<float>& c = query.position;
+        detail::hit_list sink{ hits.data() };
+        detail::overlap_soa<3>(c.x, c.y, c.z, query.radius, spheres.x, spheres.y, spheres.z, spheres.w, spheres.count, sink);
+        return sink.count;
+    }
+
+    inline void sphere_in_spheres(const sphere& query, const soa4<const float>& spheres, std::span<std::uint64_t> mask)
+    {
+        const vec3<float>& c = query.position;
+        detail::clear_mask(mask, spheres.count);
+        detail::hit_mask sink{ mask.data() };
+        detail::overlap_soa<3>(c.x, c.y, c.z, query.radius, spheres.x, spheres.y, spheres.z, spheres.w, spheres.count, sink);
+    }
+
+    // Every overlapping (i, j) with i in a and j in b, ordered by i then j
+    // Returns the number of overlapping pairs, only the first pairs.size() of them are written
+    inline std::size_t circle_pairs(const soa3<const float>& a, const soa3<const float>& b, std::span<index_pair> pairs)
+    {
+        std::size_t total = 0;
+        std::uint32_t hits[simd::f32xN::width];
+        for (std::size_t i = 0; i < a.count; i++)
+        {
+            auto sink = [&](std::size_t first, int32 mask) {
+                std::size_t count = detail::append_indices(mask, first, hits);
+                for (std::size_t h = 0; h < count; h++, total++)
+                {
+                    if (total < pairs.size())
+                        pairs[total] = { static_cast<std::uint32_t>(i), hits[h] };
+                }
+            };
+            detail::overlap_soa<2>(a.x[i], a.y[i], 0.0f, a.z[i], b.x, b.y, nullptr, b.z, b.count, sink);
+        }
+        return total;
+    }
+
+    inline std::size_t sphere_pairs(const soa4<const float>& a, const soa4<const float>& b, std::span<index_pair> pairs)
+    {
+        std::size_t total = 0;
+        std::uint32_t hits[simd::f32xN::width];
+        for (std::size_t i = 0; i < a.count; i++)
+        {
+            auto sink = [&](std::size_t first, int32 mask) {
+                std::size_t count = detail::append_indices(mask, first, hits);
+                for (std::size_t h = 0; h < count; h++, total++)
+                {
+                    if (total < pairs.size())
+                        pairs[total] = { static_cast<std::uint32_t>(i), hits[h] };
+                }
+            };
+            detail::overlap_soa<3>(a.x[i], a.y[i], a.z[i], a.w[i], b.x, b.y, b.z, b.w, b.count, sink);
+        }
+        return total;
+    }
+
+    // Raycast batches
+    // t[i] is the distance to primitive i as computed by raycast(ray, primitive, t), or infinity on a miss
+    // t must hold one value per primitive, the number of hits is returned
+    namespace detail {
+
+        template<typename P>
+        struct vec3_pack
+        {
+            P x, y, z;
+
+            static vec3_pack load(const soa3<const float>& v, std::size_t i) { return { P::load(v.x + i), P::load(v.y + i), P::load(v.z + i) }; }
+            static vec3_pack broadcast(const vec3<float>& v) { return { P::broadcast(v.x), P::broadcast(v.y), P::broadcast(v.z) }; }
+
+            friend vec3_pack operator-(const vec3_pack& a, const vec3_pack& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+            P dot(const vec3_pack& other) const { return x * other.x + y * other.y + z * other.z; }
+            vec3_pack cross(const vec3_pack& other) const { return { y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x }; }
+        };
+
+        template<typename P>
+        std::size_t store_hits(typename P::mask_type hit, P t, float* out)
+        {
+            select(hit, t, P::broadcast(std::numeric_limits<float>::infinity())).store(out);
+            return static_cast<std::size_t>(std::popcount(static_cast<std::uint32_t>(bits(hit))));
+        }
+
+    }
+
+    // Boxes given by their min and max corners, slab method
+    inline std::size_t raycast_aabbs(const ray& ray, const soa3<const float>& box_min, const soa3<const float>& box_max, std::span<float> t)
+    {
+        std::size_t hits = 0;
+        simd::for_each_block<float>(box_min.count, [&]<typename P>(std::size_t i) {
+            using V = detail::vec3_pack<P>;
+            V origin = V::broadcast(ray.origin);
+            V inv = V::broadcast(ray.inverse_direction);
+            V lo = V::load(box_min, i);
+            V hi = V::load(box_max, i);
+
+            P t0 = (lo.x - origin.x) * inv.x;
+            P t1 = (hi.x - origin.x) * inv.x;
+            P t_near = min(t0, t1);
+            P t_far = max(t0, t1);
+
+            t0 = (lo.y - origin.y) * inv.y;
+            t1 = (hi.y - origin.y) * inv.y;
+            t_near = max(min(t0, t1), t_near);
+            t_far = min(max(t0, t1), t_far);
+
+            t0 = (lo.z - origin.z) * inv.z;
+            t1 = (hi.z - origin.z) * inv.z;
+            t_near = max(min(t0, t1), t_near);
+            t_far = min(max(t0, t1), t_far);
+
+            t_near = max(t_near, P::broadcast(0.0f));
+            hits += detail::store_hits(t_far >= t_near, t_near, t.data() + i);
+        });
+        return hits;
+    }
+
+    // Triangles given by their a, b and c corners, Möller-Trumbore
+    inline std::size_t raycast_triangles(const ray& ray, const soa3<const float>& a, const soa3<const float>& b, const soa3<const float>& c,
+                                         std::span<float> t)
+    {
+        std::size_t hits = 0;
+        simd::for_each_block<float>(a.count, [&]<typename P>(std::size_t i) {
+            using V = detail::vec3_pack<P>;
+            const P epsilon = P::broadcast(1e-8f);
+            const P zero = P::broadcast(0.0f);
+            const P one = P::broadcast(1.0f);
+
+            V origin = V::broadcast(ray.origin);
+            V direction = V::broadcast(ray.direction);
+            V va = V::load(a, i);
+            V e1 = V::load(b, i) - va;
+            V e2 = V::load(c, i) - va;
+
+            V p = direction.cross(e2);
+            P det = e1.dot(p);
+            P inv_det = one / det;
+            V s = origin - va;
+            P u = s.dot(p) * inv_det;
+            V q = s.cross(e1);
+            P v = direction.dot(q) * inv_det;
+            P hit = e2.dot(q) * inv_det;
+
+            typename P::mask_type valid = (det >= epsilon) | (det <= -epsilon);
+            valid = valid & (u >= zero) & (u <= one) & (v >= zero) & (u + v <= one) & (hit >= zero);
+            hits += detail::store_hits(valid, hit, t.data() + i);
+        });
+        return hits;
+    }
+
+    // Matrix chains
+    // out[i] = left[i] * right, e.g. every model matrix times a shared view-projection
+    template<typename T>
+    void concat(std::type_identity_t<std::span<const mat4<T>>> left, const mat4<T>& right, std::type_identity_t<std::span<mat4<T>>> out,
+                execution::policy policy = execution::par)
+    {
+        std::size_t count = left.size() < out.size() ? left.size() : out.size();
+        detail::batch_for(count, 2 * sizeof(mat4<T>), policy, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++)
+                out[i] = mat4<T>::product(left[i], right);
+        });
+    }
+
+    // out[i] = left * right[i]
+    template<typename T>
+    void concat(const mat4<T>& left, std::type_identity_t<std::span<const mat4<T>>> right, std::type_identity_t<std::span<mat4<T>>> out,
+                execution::policy policy = execution::par)
+    {
+        std::size_t count = right.size() < out.size() ? right.size() : out.size();
+        detail::batch_for(count, 2 * sizeof(mat4<T>), policy, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++)
+                out[i] = mat4<T>::product(left, right[i]);
+        });
+    }
+
+}
+
+#endif // GEM_BATCH_HPP
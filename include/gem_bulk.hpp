@@ -0,0 +1,391 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_BULK_HPP
+#define GEM_BULK_HPP
+
+#include "gem_math.hpp"
+#include "gem_simd.hpp"
+#include "gem_parallel.hpp"
+
+// std
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+// Bulk vector algebra
+// axpy, scale, lerp, normalize, dot, cross, distance and min / max over arrays of vec2, vec3 and vec4 in float or
+// double. Arguments are contiguous ranges (std::span, std::vector, std::array, C arrays), the smaller of all sizes
+// is processed and an output may be the same array as an input, but not a partially overlapping one.
+// Every element equals the matching scalar function of gem_math.hpp, build with -ffp-contract=off for bit identical results.
+// Componentwise operations run over the components as one flat array, the others load whole packs of records
+// (8 vec3<float> in 6 loads with AVX2) and split them into x, y and z lanes, so the 12 and 24 byte vec3 strides cost
+// a few shuffles per pack instead of scalar loads
+// Every operation takes an execution policy last (gem_parallel.hpp), large arrays are split over the job system in
+// cache sized runs of elements, small ones always run on the calling thread
+namespace gem {
+
+    namespace detail {
+
+        template<typename V>
+        struct bulk_traits
+        {
+            static constexpr bool enabled = false;
+        };
+
+        template<std::floating_point T>
+        struct bulk_traits<vec2<T>>
+        {
+            static constexpr bool enabled = true;
+            static constexpr int32 size = 2;
+            using scalar = T;
+        };
+
+        template<std::floating_point T>
+        struct bulk_traits<vec3<T>>
+        {
+            static constexpr bool enabled = true;
+            static constexpr int32 size = 3;
+            using scalar = T;
+        };
+
+        template<std::floating_point T>
+        struct bulk_traits<vec4<T>>
+        {
+            static constexpr bool enabled = true;
+            static constexpr int32 size = 4;
+            using scalar = T;
+        };
+
+        template<typename R>
+        using bulk_element = std::remove_cvref_t<std::ranges::range_reference_t<R>>;
+
+        template<typename R>
+        concept bulk_input = std::ranges::contiguous_range<R> && std::ranges::sized_range<R> && bulk_traits<bulk_element<R>>::enabled;
+
+        template<typename R>
+        concept bulk_output = bulk_input<R> && !std::is_const_v<std::remove_reference_t<std::ranges::range_reference_t<R>>>;
+
+        // Scalar outputs (dot, distance)
+        template<typename R, typename T>
+        concept bulk_scalar_output = std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&
+                                     std::is_same_v<std::ranges::range_reference_t<R>, T&>;
+
+        template<typename R>
+        using bulk_scalar = typename bulk_traits<bulk_element<R>>::scalar;
+
+        // Slices are multiples of this many elements, so every slice but the last one has no scalar tail
+        inline constexpr std::size_t bulk_granularity = 64;
+
+        template<typename R>
+        auto bulk_data(R&& range)
+        {
+            return std::ranges::data(range);
+        }
+
+        // The components of a range as one flat array
+        template<typename R>
+        auto bulk_flat(R&& range)
+        {
+            auto* data = std::ranges::data(range);
+            return data ? &data->x : nullptr;
+        }
+
+        template<typename... R>
+        std::size_t bulk_count(const R&... ranges)
+        {
+            std::size_t count = std::numeric_limits<std::size_t>::max();
+            ((count = std::min<std::size_t>(count, std::ranges::size(ranges))), ...);
+            return count;
+        }
+
+        // Width records of N components from src into N packs, and back
+        template<int32 N, typename P>
+        void load_records(const typename P::value_type* src, P (&c)[N])
+        {
+            if constexpr (N == 2)
+                P::load_interleaved2(src, c[0], c[1]);
+            else if constexpr (N == 3)
+                P::load_interleaved3(src, c[0], c[1], c[2]);
+            else
+                P::load_interleaved4(src, 4, c[0], c[1], c[2], c[3]);
+        }
+
+        template<int32 N, typename P>
+        void store_records(typename P::value_type* dst, const P (&c)[N])
+        {
+            if constexpr (N == 2)
+                P::store_interleaved2(dst, c[0], c[1]);
+            else if constexpr (N == 3)
+                P::store_interleaved3(dst, c[0], c[1], c[2]);
+            else
+                P::store_interleaved4(dst, 4, c[0], c[1], c[2], c[3]);
+        }
+
+        // ((c0 * d0 + c1 * d1) + c2 * d2) + c3 * d3, the order of vecN::dot
+        template<int32 N, typename P>
+        P dot_records(const P (&a)[N], const P (&b)[N])
+        {
+            P sum = a[0] * b[0];
+            for (int32 c = 1; c < N; c++)
+                sum = sum + a[c] * b[c];
+            return sum;
+        }
+
+        // function(begin, end) over [0, count) elements, item_bytes read and written per element
+        template<typename Function>
+        void bulk_for(std::size_t count, std::size_t item_bytes, execution::policy policy, Function&& function)
+        {
+            parallel_batch(count, item_bytes, bulk_granularity, policy, function);
+        }
+
+        // kernel.template operator()<P>(i) on element blocks of [begin, end), see simd::for_each_block
+        template<typename T, typename Kernel>
+        void bulk_blocks(std::size_t begin, std::size_t end, Kernel&& kernel)
+        {
+            simd::for_each_block<T>(end - begin, [&]<typename P>(std::size_t i) { kernel.template operator()<P>(begin + i); });
+        }
+
+        // Componentwise kernels see elements [begin, end) as N times as many scalars
+        template<typename V, typename Kernel>
+        void bulk_components(std::size_t count, std::size_t item_bytes, execution::policy policy, Kernel&& kernel)
+        {
+            using T = typename bulk_traits<V>::scalar;
+            constexpr std::size_t N = bulk_traits<V>::size;
+            bulk_for(count, item_bytes, policy, [&](std::size_t begin, std::size_t end) {
+                bulk_blocks<T>(begin * N, end * N, kernel);
+            });
+        }
+
+        // Per element kernels over a range of elements
+        template<typename V, typename Kernel>
+        void bulk_elements(std::size_t count, std::size_t item_bytes, execution::policy policy, Kernel&& kernel)
+        {
+            using T = typename bulk_traits<V>::scalar;
+            bulk_for(count, item_bytes, policy, [&](std::size_t begin, std::size_t end) {
+                bulk_blocks<T>(begin, end, kernel);
+            });
+        }
+
+        // Componentwise min (is_min) or max of every element, NaN components are skipped
+        template<bool is_min, typename V>
+        V bulk_extreme(const V* data, std::size_t count, execution::policy policy)
+        {
+            using T = typename bulk_traits<V>::scalar;
+            constexpr int32 N = bulk_traits<V>::size;
+            constexpr T start = is_min ? std::numeric_limits<T>::infinity() : -std::numeric_limits<T>::infinity();
+
+            // min(value, result) keeps result when value is NaN, for the packs and for scalar<T>
+            auto pick = [](auto value, auto result) { if constexpr (is_min) return min(value, result); else return max(value, result); };
+
+            V result;
+            for (int32 c = 0; c < N; c++)
+                (&result.x)[c] = start;
+
+            std::mutex mutex;
+            bulk_for(count, sizeof(V), policy, [&](std::size_t begin, std::size_t end) {
+                using P = simd::pack<T>;
+                P lanes[N];
+                for (int32 c = 0; c < N; c++)
+                    lanes[c] = P::broadcast(start);
+                simd::scalar<T> tail[N];
+                for (int32 c = 0; c < N; c++)
+                    tail[c] = simd::scalar<T>::broadcast(start);
+
+                bulk_blocks<T>(begin, end, [&]<typename B>(std::size_t i) {
+                    B v[N];
+                    load_records<N>(&data[i].x, v);
+                    if constexpr (std::is_same_v<B, P>)
+                    {
+                        for (int32 c = 0; c < N; c++)
+                            lanes[c] = pick(v[c], lanes[c]);
+                    }
+                    else
+                    {
+                        for (int32 c = 0; c < N; c++)
+                            tail[c] = pick(v[c], tail[c]);
+                    }
+                });
+
+                T values[P::width];
+                std::lock_guard<std::mutex> lock(mutex);
+                for (int32 c = 0; c < N; c++)
+                {
+                    lanes[c].store(values);
+                    simd::scalar<T> slice = tail[c];
+                    for (std::size_t l = 0; l < P::width; l++)
+                        slice = pick(simd::scalar<T>{ values[l] }, slice);
+                    (&result.x)[c] = pick(slice, simd::scalar<T>{ (&result.x)[c] }).v;
+                }
+            });
+            return result;
+        }
+
+    }
+
+    // y[i] = y[i] + x[i] * a
+    template<detail::bulk_input X, detail::bulk_output Y>
+    requires std::is_same_v<detail::bulk_element<X>, detail::bulk_element<Y>>
+    void axpy(detail::bulk_scalar<X> a, const X& x, Y&& y, execution::policy policy = execution::par)
+    {
+        using T = detail::bulk_scalar<X>;
+        const T* px = detail::bulk_flat(x);
+        T* py = detail::bulk_flat(y);
+        detail::bulk_components<detail::bulk_element<X>>(detail::bulk_count(x, y), 3 * sizeof(detail::bulk_element<X>), policy, [&]<typename P>(std::size_t i) {
+            (P::load(py + i) + P::load(px + i) * P::broadcast(a)).store(py + i);
+        });
+    }
+
+    // out[i] = in[i] * s
+    template<detail::bulk_input In, detail::bulk_output Out>
+    requires std::is_same_v<detail::bulk_element<In>, detail::bulk_element<Out>>
+    void scale(const In& in, detail::bulk_scalar<In> s, Out&& out, execution::policy policy = execution::par)
+    {
+        using T = detail::bulk_scalar<In>;
+        const T* src = detail::bulk_flat(in);
+        T* dst = detail::bulk_flat(out);
+        detail::bulk_components<detail::bulk_element<In>>(detail::bulk_count(in, out), 2 * sizeof(detail::bulk_element<In>), policy, [&]<typename P>(std::size_t i) {
+            (P::load(src + i) * P::broadcast(s)).store(dst + i);
+        });
+    }
+
+    // out[i] = lerp(a[i], b[i], t)
+    template<detail::bulk_input A, detail::bulk_input B, detail::bulk_output Out>
+    requires std::is_same_v<detail::bulk_element<A>, detail::bulk_element<B>> && std::is_same_v<detail::bulk_element<A>, detail::bulk_element<Out>>
+    void lerp(const A& a, const B& b, detail::bulk_scalar<A> t, Out&& out, execution::policy policy = execution::par)
+    {
+        using T = detail::bulk_scalar<A>;
+        const T* pa = detail::bulk_flat(a);
+        const T* pb = detail::bulk_flat(b);
+        T* dst = detail::bulk_flat(out);
+        detail::bulk_components<detail::bulk_element<A>>(detail::bulk_count(a, b, out), 3 * sizeof(detail::bulk_element<A>), policy, [&]<typename P>(std::size_t i) {
+            P va = P::load(pa + i);
+            (va + (P::load(pb + i) - va) * P::broadcast(t)).store(dst + i);
+        });
+    }
+
+    // out[i] = in[i].normalized(), zero vectors stay zero
+    template<detail::bulk_input In, detail::bulk_output Out>
+    requires std::is_same_v<detail::bulk_element<In>, detail::bulk_element<Out>>
+    void normalize(const In& in, Out&& out, execution::policy policy = execution::par)
+    {
+        using V = detail::bulk_element<In>;
+        constexpr int32 N = detail::bulk_traits<V>::size;
+        const V* src = detail::bulk_data(in);
+        V* dst = detail::bulk_data(out);
+        detail::bulk_elements<V>(detail::bulk_count(in, out), 2 * sizeof(V), policy, [&]<typename P>(std::size_t i) {
+            // One element, the branch of normalize() is cheaper than a bitwise select
+            if constexpr (P::width == 1)
+            {
+                dst[i] = src[i].normalized();
+            }
+            else
+            {
+                P v[N];
+                detail::load_records<N>(&src[i].x, v);
+                P magnitude = sqrt(detail::dot_records<N>(v, v));
+                P inv = P::broadcast(1) / magnitude;
+                auto positive = magnitude > P::broadcast(0);
+                for (int32 c = 0; c < N; c++)
+                    v[c] = select(positive, v[c] * inv, v[c]);
+                detail::store_records<N>(&dst[i].x, v);
+            }
+        });
+    }
+
+    // out[i] = dot(a[i], b[i])
+    template<detail::bulk_input A, detail::bulk_input B, typename Out>
+    requires std::is_same_v<detail::bulk_element<A>, detail::bulk_element<B>> && detail::bulk_scalar_output<Out, detail::bulk_scalar<A>>
+    void dot(const A& a, const B& b, Out&& out, execution::policy policy = execution::par)
+    {
+        using V = detail::bulk_element<A>;
+        constexpr int32 N = detail::bulk_traits<V>::size;
+        const V* pa = detail::bulk_data(a);
+        const V* pb = detail::bulk_data(b);
+        auto* dst = detail::bulk_data(out);
+        detail::bulk_elements<V>(detail::bulk_count(a, b, out), 2 * sizeof(V) + sizeof(*dst), policy, [&]<typename P>(std::size_t i) {
+            P va[N], vb[N];
+            detail::load_records<N>(&pa[i].x, va);
+            detail::load_records<N>(&pb[i].x, vb);
+            detail::dot_records<N>(va, vb).store(dst + i);
+        });
+    }
+
+    // out[i] = cross(a[i], b[i])
+    template<detail::bulk_input A, detail::bulk_input B, detail::bulk_output Out>
+    requires std::is_same_v<detail::bulk_element<A>, detail::bulk_element<B>> && std::is_same_v<detail::bulk_element<A>, detail::bulk_element<Out>> &&
+             (detail::bulk_traits<detail::bulk_element<A>>::size == 3)
+    void cross(const A& a, const B& b, Out&& out, execution::policy policy = execution::par)
+    {
+        using V = detail::bulk_element<A>;
+        const V* pa = detail::bulk_data(a);
+        const V* pb = detail::bulk_data(b);
+        V* dst = detail::bulk_data(out);
+        detail::bulk_elements<V>(detail::bulk_count(a, b, out), 3 * sizeof(V), policy, [&]<typename P>(std::size_t i) {
+            P u[3], v[3];
+            detail::load_records<3>(&pa[i].x, u);
+            detail::load_records<3>(&pb[i].x, v);
+            const P w[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+            detail::store_records<3>(&dst[i].x, w);
+        });
+    }
+
+    // out[i] = distance_squared(points[i], point)
+    template<detail::bulk_input Points, typename Out>
+    requires detail::bulk_scalar_output<Out, detail::bulk_scalar<Points>>
+    void distance_squared(const Points& points, const detail::bulk_element<Points>& point, Out&& out, execution::policy policy = execution::par)
+    {
+        using V = detail::bulk_element<Points>;
+        constexpr int32 N = detail::bulk_traits<V>::size;
+        const V* src = detail::bulk_data(points);
+        auto* dst = detail::bulk_data(out);
+        detail::bulk_elements<V>(detail::bulk_count(points, out), sizeof(V) + sizeof(*dst), policy, [&]<typename P>(std::size_t i) {
+            P d[N];
+            detail::load_records<N>(&src[i].x, d);
+            for (int32 c = 0; c < N; c++)
+                d[c] = d[c] - P::broadcast((&point.x)[c]);
+            detail::dot_records<N>(d, d).store(dst + i);
+        });
+    }
+
+    // out[i] = distance(points[i], point)
+    template<detail::bulk_input Points, typename Out>
+    requires detail::bulk_scalar_output<Out, detail::bulk_scalar<Points>>
+    void distance(const Points& points, const detail::bulk_element<Points>& point, Out&& out, execution::policy policy = execution::par)
+    {
+        using V = detail::bulk_element<Points>;
+        constexpr int32 N = detail::bulk_traits<V>::size;
+        const V* src = detail::bulk_data(points);
+        auto* dst = detail::bulk_data(out);
+        detail::bulk_elements<V>(detail::bulk_count(points, out), sizeof(V) + sizeof(*dst), policy, [&]<typename P>(std::size_t i) {
+            P d[N];
+            detail::load_records<N>(&src[i].x, d);
+            for (int32 c = 0; c < N; c++)
+                d[c] = d[c] - P::broadcast((&point.x)[c]);
+            sqrt(detail::dot_records<N>(d, d)).store(dst + i);
+        });
+    }
+
+    // Componentwise minimum and maximum of every element, NaN components are skipped
+    // An empty range gives infinity (min) or -infinity (max), which of -0 and +0 is returned is unspecified
+    template<detail::bulk_input In>
+    detail::bulk_element<In> min(const In& in, execution::policy policy = execution::par)
+    {
+        return detail::bulk_extreme<true>(detail::bulk_data(in), std::ranges::size(in), policy);
+    }
+
+    template<detail::bulk_input In>
+    detail::bulk_element<In> max(const In& in, execution::policy policy = execution::par)
+    {
+        return detail::bulk_extreme<false>(detail::bulk_data(in), std::ranges::size(in), policy);
+    }
+
+}
+
+#endif // GEM_BULK_HPP
@@ -0,0 +1,346 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_BVH_HPP
+#define GEM_BVH_HPP
+
+#include "gem_math.hpp"
+#include "gem_parallel.hpp"
+
+// std
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <span>
+#include <vector>
+
+// Bounding volume hierarchy over axis aligned bounds
+// Built with binned SAH, subtrees of large nodes are built in parallel. Nodes are stored depth first,
+// an internal node's first child is the next node and every node knows where its subtree ends, so
+// queries walk the array forward without a stack
+namespace gem {
+
+    class bvh
+    {
+    public:
+        // 32 bytes, internal nodes have count == 0 and index == the node after their subtree,
+        // leaves hold primitives()[index, index + count)
+        struct node
+        {
+            aabb bounds;
+            std::uint32_t index = 0;
+            std::uint32_t count = 0;
+
+            constexpr bool is_leaf() const { return count != 0; }
+        };
+        static_assert(sizeof(node) == 32);
+
+        static constexpr std::uint32_t invalid = std::numeric_limits<std::uint32_t>::max();
+        // Nodes of up to target_leaf_size primitives are always leaves. Larger ones become leaves of up to
+        // max_leaf_size when the SAH finds no split worth the traversal, never larger
+        static constexpr std::uint32_t target_leaf_size = 4;
+        static constexpr std::uint32_t max_leaf_size = 4 * target_leaf_size;
+
+        bvh() = default;
+
+        // bounds[i] is the box of primitive i. Under par the subtrees of large nodes are built on their own threads,
+        // up to policy.threads of them: the build is recursive fork-join, it does not go through the job system
+        explicit bvh(std::span<const aabb> bounds, execution::policy policy = execution::par)
+        {
+            build(bounds, policy);
+        }
+
+        void build(std::span<const aabb> bounds, execution::policy policy = execution::par)
+        {
+            m_nodes.clear();
+            m_primitives.resize(bounds.size());
+            if (bounds.empty())
+                return;
+
+            std::vector<vec3<float>> centroids(bounds.size());
+            for (std::size_t i = 0; i < bounds.size(); i++)
+            {
+                m_primitives[i] = static_cast<std::uint32_t>(i);
+                centroids[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+            }
+
+            builder builder{ bounds, centroids, m_primitives };
+            m_nodes.reserve(2 * bounds.size());
+            builder.build(m_nodes, 0, static_cast<std::uint32_t>(bounds.size()), detail::thread_budget(policy));
+        }
+
+        // Recomputes the node bounds after primitives moved, the tree shape stays the same
+        // bounds must describe the same primitives the tree was built with
+        void refit(std::span<const aabb> bounds)
+        {
+            // Children come after their parent, so walking backwards visits them first
+            for (std::size_t i = m_nodes.size(); i-- > 0;)
+            {
+                node& current = m_nodes[i];
+                if (current.is_leaf())
+                {
+                    current.bounds = bounds[m_primitives[current.index]];
+                    for (std::uint32_t p = 1; p < current.count; p++)
+                        current.bounds = merge(current.bounds, bounds[m_primitives[current.index + p]]);
+                }
+                else
+                {
+                    std::size_t left = i + 1;
+                    std::size_t right = next(left);
+                    current.bounds = merge(m_nodes[left].bounds, m_nodes[right].bounds);
+                }
+            }
+        }
+
+        // Calls fn(primitive) for every primitive whose bounds overlap box
+        template<typename Fn>
+        void overlap(const aabb& box, Fn&& fn) const
+        {
+            walk([&](const aabb& bounds) { return aabb_in_aabb(box, bounds); }, fn);
+        }
+
+        template<typename Fn>
+        void overlap(const sphere& sphere, Fn&& fn) const
+        {
+            walk([&](const aabb& bounds) { return sphere_in_aabb(sphere, bounds); }, fn);
+        }
+
+        // Closest hit along the ray within [0, t]
+        // intersect(primitive, t) tests one primitive and, on a hit closer than t, lowers t and returns true
+        // Returns the primitive hit last (the closest one) or invalid, t holds its distance
+        template<typename Fn>
+        std::uint32_t raycast(const ray& ray, float& t, Fn&& intersect) const
+        {
+            std::uint32_t closest = invalid;
+            walk([&](const aabb& bounds) {
+                float entry;
+                return gem::raycast(ray, bounds, entry) && entry <= t;
+            }, [&](std::uint32_t primitive) {
+                if (intersect(primitive, t))
+                    closest = primitive;
+            });
+            return closest;
+        }
+
+        // Closest primitive to point within sqrt(distance_squared)
+        // measure(primitive) returns the squared distance from point to the primitive
+        // Returns the closest primitive or invalid, distance_squared holds its squared distance
+        template<typename Fn>
+        std::uint32_t nearest(const vec3<float>& point, float& distance_squared, Fn&& measure) const
+        {
+            std::uint32_t closest = invalid;
+            walk([&](const aabb& bounds) {
+                vec3<float> clamped(clamp(point.x, bounds.min.x, bounds.max.x), clamp(point.y, bounds.min.y, bounds.max.y),
+                                    clamp(point.z, bounds.min.z, bounds.max.z));
+                return gem::distance_squared(point, clamped) <= distance_squared;
+            }, [&](std::uint32_t primitive) {
+                float d = measure(primitive);
+                if (d <= distance_squared)
+                {
+                    distance_squared = d;
+                    closest = primitive;
+                }
+            });
+            return closest;
+        }
+
+        std::span<const node> nodes() const { return m_nodes; }
+        std::span<const std::uint32_t> primitives() const { return m_primitives; }
+
+    private:
+        static constexpr aabb merge(const aabb& a, const aabb& b)
+        {
+            return { vec3<float>(a.min.x < b.min.x ? a.min.x : b.min.x, a.min.y < b.min.y ? a.min.y : b.min.y, a.min.z < b.min.z ? a.min.z : b.min.z),
+                     vec3<float>(a.max.x > b.max.x ? a.max.x : b.max.x, a.max.y > b.max.y ? a.max.y : b.max.y, a.max.z > b.max.z ? a.max.z : b.max.z) };
+        }
+
+        static constexpr float half_area(const aabb& box)
+        {
+            vec3<float> d = box.max - box.min;
+            return d.x * d.y + d.y * d.z + d.z * d.x;
+        }
+
+        // Node after the subtree rooted at i
+        std::size_t next(std::size_t i) const
+        {
+            return m_nodes[i].is_leaf() ? i + 1 : m_nodes[i].index;
+        }
+
+        // Stackless walk, visit(bounds) decides whether to enter a node, leaf(primitive) is called for
+        // every primitive of an entered leaf
+        template<typename Visit, typename Leaf>
+        void walk(Visit&& visit, Leaf&& leaf) const
+        {
+            std::size_t i = 0;
+            while (i < m_nodes.size())
+            {
+                const node& current = m_nodes[i];
+                if (!visit(current.bounds))
+                {
+                    i = next(i);
+                    continue;
+                }
+
+                if (current.is_leaf())
+                {
+                    for (std::uint32_t p = 0; p < current.count; p++)
+                        leaf(m_primitives[current.index + p]);
+                }
+                i++;
+            }
+        }
+
+        struct builder
+        {
+            static constexpr std::uint32_t bin_count = 16;
+            // Below this many primitives a subtree is always built on the calling thread
+            static constexpr std::uint32_t parallel_threshold = 1 << 14;
+
+            std::span<const aabb> bounds;
+            std::span<const vec3<float>> centroids;
+            std::span<std::uint32_t> primitives;
+
+            // Appends the subtree of primitives[begin, end) to out in depth first order,
+            // skip indices are relative to the start of out
+            void build(std::vector<node>& out, std::uint32_t begin, std::uint32_t end, std::uint32_t threads)
+            {
+                std::size_t self = out.size();
+                out.emplace_back();
+
+                aabb box = bounds[primitives[begin]];
+                aabb centroid_box = { centroids[primitives[begin]], centroids[primitives[begin]] };
+                for (std::uint32_t i = begin + 1; i < end; i++)
+                {
+                    box = merge(box, bounds[primitives[i]]);
+                    centroid_box = merge(centroid_box, { centroids[primitives[i]], centroids[primitives[i]] });
+                }
+                out[self].bounds = box;
+
+                std::uint32_t count = end - begin;
+                std::uint32_t middle = count > target_leaf_size ? split(begin, end, box, centroid_box) : begin;
+                if (middle == begin)
+                {
+                    out[self].index = begin;
+                    out[self].count = count;
+                    return;
+                }
+
+                if (threads > 1 && count >= parallel_threshold)
+                {
+                    // Right half on another thread into its own array, appended once both halves are done
+                    std::vector<node> right;
+                    std::future<void> task = std::async(std::launch::async, [&] {
+                        right.reserve(2 * (end - middle));
+                        build(right, middle, end, threads / 2);
+                    });
+                    build(out, begin, middle, threads - threads / 2);
+                    task.get();
+
+                    std::uint32_t base = static_cast<std::uint32_t>(out.size());
+                    for (node& n : right)
+                    {
+                        if (!n.is_leaf())
+                            n.index += base;
+                    }
+                    out.insert(out.end(), right.begin(), right.end());
+                }
+                else
+                {
+                    build(out, begin, middle, 1);
+                    build(out, middle, end, 1);
+                }
+
+                out[self].index = static_cast<std::uint32_t>(out.size());
+            }
+
+            // Partitions primitives[begin, end) along the cheapest binned SAH plane, returns begin when a leaf is cheaper
+            std::uint32_t split(std::uint32_t begin, std::uint32_t end, const aabb& box, const aabb& centroid_box)
+            {
+                std::uint32_t count = end - begin;
+                float best_cost = std::numeric_limits<float>::infinity();
+                int32 best_axis = -1;
+                std::uint32_t best_bin = 0;
+
+                for (int32 axis = 0; axis < 3; axis++)
+                {
+                    float lo = (&centroid_box.min.x)[axis];
+                    float extent = (&centroid_box.max.x)[axis] - lo;
+                    if (extent <= 0.0f)
+                        continue;
+                    float scale = bin_count / extent;
+
+                    aabb bins[bin_count];
+                    std::uint32_t counts[bin_count] = {};
+                    for (std::uint32_t i = begin; i < end; i++)
+                    {
+                        std::uint32_t b = bin_of(centroids[primitives[i]], axis, lo, scale);
+                        bins[b] = counts[b]++ == 0 ? bounds[primitives[i]] : merge(bins[b], bounds[primitives[i]]);
+                    }
+
+                    // Sweep from the right, then from the left evaluating each plane
+                    float right_area[bin_count];
+                    std::uint32_t right_count[bin_count];
+                    aabb accumulated;
+                    std::uint32_t accumulated_count = 0;
+                    for (std::uint32_t b = bin_count; b-- > 1;)
+                    {
+                        if (counts[b] != 0)
+                            accumulated = accumulated_count == 0 ? bins[b] : merge(accumulated, bins[b]);
+                        accumulated_count += counts[b];
+                        right_area[b] = accumulated_count != 0 ? half_area(accumulated) : 0.0f;
+                        right_count[b] = accumulated_count;
+                    }
+
+                    accumulated_count = 0;
+                    for (std::uint32_t b = 0; b + 1 < bin_count; b++)
+                    {
+                        if (counts[b] != 0)
+                            accumulated = accumulated_count == 0 ? bins[b] : merge(accumulated, bins[b]);
+                        accumulated_count += counts[b];
+                        if (accumulated_count == 0 || right_count[b + 1] == 0)
+                            continue;
+
+                        float cost = half_area(accumulated) * accumulated_count + right_area[b + 1] * right_count[b + 1];
+                        if (cost < best_cost)
+                        {
+                            best_cost = cost;
+                            best_axis = axis;
+                            best_bin = b + 1;
+                        }
+                    }
+                }
+
+                // Every centroid in the same place, no plane separates them
+                if (best_axis < 0)
+                    return count <= max_leaf_size ? begin : begin + count / 2;
+
+                // Leaf cost against the split cost (traversal cost taken as one primitive test)
+                float leaf_cost = half_area(box) * count;
+                if (count <= max_leaf_size && leaf_cost <= best_cost + half_area(box))
+                    return begin;
+
+                float lo = (&centroid_box.min.x)[best_axis];
+                float scale = bin_count / ((&centroid_box.max.x)[best_axis] - lo);
+                std::uint32_t* middle = std::partition(primitives.data() + begin, primitives.data() + end, [&](std::uint32_t p) {
+                    return bin_of(centroids[p], best_axis, lo, scale) < best_bin;
+                });
+                return static_cast<std::uint32_t>(middle - primitives.data());
+            }
+
+            static std::uint32_t bin_of(const vec3<float>& centroid, int32 axis, float lo, float scale)
+            {
+                std::uint32_t b = static_cast<std::uint32_t>(((&centroid.x)[axis] - lo) * scale);
+                return b < bin_count ? b : bin_count - 1;
+            }
+        };
+
+        std::vector<node> m_nodes;
+        std::vector<std::uint32_t> m_primitives;
+    };
+
+}
+
+#endif // GEM_BVH_HPP
@@ -0,0 +1,553 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_COLOR_HPP
+#define GEM_COLOR_HPP
+
+#include "gem_math.hpp"
+#include "gem_simd.hpp"
+#include "gem_parallel.hpp"
+
+// std
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+// Color batches
+// Conversions between packed RGBA8 pixels (u8vec4) and float colors (vec4<float>), RGB <-> HSV, sRGB <-> linear,
+// tonemapping and premultiplied alpha, over spans and whole images. Every element equals the matching scalar
+// function of gem_math.hpp, the SIMD paths only change how many pixels are done at once. Build with
+// -ffp-contract=off for bit identical float results
+// Every batch takes an execution policy last (gem_parallel.hpp), large batches are split over the job system in
+// cache sized runs of pixels or rows, small ones always run on the calling thread
+namespace gem {
+
+    // Rows of pixels, row y starts at pixels + y * stride (stride >= width, in pixels)
+    template<typename T>
+    struct image_view
+    {
+        T* pixels = nullptr;
+        std::size_t width = 0;
+        std::size_t height = 0;
+        std::size_t stride = 0;
+
+        std::span<T> row(std::size_t y) const
+        {
+            return { pixels + y * stride, width };
+        }
+
+        operator image_view<const T>() const requires (!std::is_const_v<T>)
+        {
+            return { pixels, width, height, stride };
+        }
+    };
+
+    namespace detail {
+
+        // Pixels per chunk of the fused conversions, 1 KiB of float colors stays in L1 between both passes
+        inline constexpr std::size_t color_chunk = 64;
+
+        inline std::size_t color_count(std::size_t in, std::size_t out)
+        {
+            return in < out ? in : out;
+        }
+
+        // kernel(in slice, out slice) over the smaller of both sizes
+        template<typename In, typename Out, typename Kernel>
+        void parallel_spans(std::span<In> in, std::span<Out> out, execution::policy policy, Kernel&& kernel)
+        {
+            constexpr std::size_t pixel_bytes = sizeof(In) + sizeof(Out);
+            parallel_batch(color_count(in.size(), out.size()), pixel_bytes, color_chunk, policy, [&](std::size_t begin, std::size_t end) {
+                kernel(in.subspan(begin, end - begin), out.subspan(begin, end - begin));
+            });
+        }
+
+        // kernel(in row, out row) for every row, split by rows
+        template<typename In, typename Out, typename Kernel>
+        void parallel_rows(const image_view<In>& in, const image_view<Out>& out, execution::policy policy, Kernel&& kernel)
+        {
+            std::size_t width = color_count(in.width, out.width);
+            std::size_t height = color_count(in.height, out.height);
+            parallel_batch(height, width * (sizeof(In) + sizeof(Out)), 1, policy, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t y = begin; y < end; y++)
+                    kernel(in.row(y).first(width), out.row(y).first(width));
+            });
+        }
+
+        // Single thread kernels, both spans have the same size
+
+        inline void to_normalized_span(std::span<const u8vec4> in, std::span<vec4<float>> out)
+        {
+            std::size_t i = 0;
+#if defined(GEM_SSE)
+            // 4 pixels per iteration, bytes widened to 32-bit integers in two unpack steps
+            const __m128i zero = _mm_setzero_si128();
+            const __m128 conv = _mm_set1_ps(1.0f / 255.0f);
+            for (; i + 4 <= in.size(); i += 4)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+                __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                __m128i high = _mm_unpackhi_epi8(bytes, zero);
+                float* dst = &out[i].x;
+                _mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), conv));
+                _mm_storeu_ps(dst + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), conv));
+                _mm_storeu_ps(dst + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), conv));
+                _mm_storeu_ps(dst + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), conv));
+            }
+#endif
+            for (; i < in.size(); i++)
+                out[i] = rgb_to_normalized(in[i]);
+        }
+
+        inline void to_rgba8_span(std::span<const vec4<float>> in, std::span<u8vec4> out)
+        {
+            std::size_t i = 0;
+#if defined(GEM_SSE)
+            // 4 pixels per iteration, the saturating packs cannot overflow after the clamp
+            // _mm_max_ps returns its second operand for NaN, like the scalar clamp that maps NaN to 0
+            const __m128 scale = _mm_set1_ps(255.0f);
+            const __m128 zero = _mm_setzero_ps();
+            auto channel = [&](const float* src) {
+                return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src), scale), zero), scale));
+            };
+            for (; i + 4 <= in.size(); i += 4)
+            {
+                const float* src = &in[i].x;
+                __m128i low = _mm_packs_epi32(channel(src), channel(src + 4));
+                __m128i high = _mm_packs_epi32(channel(src + 8), channel(src + 12));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), _mm_packus_epi16(low, high));
+            }
+#endif
+            for (; i < in.size(); i++)
+                out[i] = normalized_to_rgb(in[i]);
+        }
+
+        // kernel(r, g, b, a) returns nothing and updates the channels in place, on the widest pack
+        template<typename T, typename Kernel>
+        void map_pixels(std::span<const vec4<T>> in, std::span<vec4<T>> out, Kernel&& kernel)
+        {
+            simd::for_each_block<T>(in.size(), [&]<typename P>(std::size_t i) {
+                P r, g, b, a;
+                P::load_interleaved4(&in[i].x, 4, r, g, b, a);
+                kernel(r, g, b, a);
+                P::store_interleaved4(&out[i].x, 4, r, g, b, a);
+            });
+        }
+
+        // Float colors through a float kernel into packed pixels, chunk by chunk on the stack
+        template<typename Kernel>
+        void map_to_rgba8(std::span<const vec4<float>> in, std::span<u8vec4> out, Kernel&& kernel)
+        {
+            vec4<float> chunk[color_chunk];
+            for (std::size_t i = 0; i < in.size(); i += color_chunk)
+            {
+                std::size_t size = color_count(color_chunk, in.size() - i);
+                kernel(in.subspan(i, size), std::span<vec4<float>>(chunk, size));
+                to_rgba8_span(std::span<const vec4<float>>(chunk, size), out.subspan(i, size));
+            }
+        }
+
+        template<typename T>
+        void rgb_to_hsv_span(std::span<const vec4<T>> in, std::span<vec4<T>> out)
+        {
+            map_pixels(in, out, [](auto& r, auto& g, auto& b, auto&) { rgb_to_hsv(r, g, b, r, g, b); });
+        }
+
+        template<typename T>
+        void hsv_to_rgb_span(std::span<const vec4<T>> in, std::span<vec4<T>> out)
+        {
+            map_pixels(in, out, [](auto& h, auto& s, auto& v, auto&) { hsv_to_rgb(h, s, v, h, s, v); });
+        }
+
+        template<fast::accuracy A>
+        void srgb_to_linear_span(std::span<const vec4<float>> in, std::span<vec4<float>> out)
+        {
+            map_pixels(in, out, [](auto& r, auto& g, auto& b, auto&) {
+                r = srgb_to_linear<A>(r);
+                g = srgb_to_linear<A>(g);
+                b = srgb_to_linear<A>(b);
+            });
+        }
+
+        template<fast::accuracy A>
+        void linear_to_srgb_span(std::span<const vec4<float>> in, std::span<vec4<float>> out)
+        {
+            map_pixels(in, out, [](auto& r, auto& g, auto& b, auto&) {
+                r = linear_to_srgb<A>(r);
+                g = linear_to_srgb<A>(g);
+                b = linear_to_srgb<A>(b);
+            });
+        }
+
+        // Bucket table lookups like linear_to_srgb8, alpha is rounded like to_rgba8_span
+        inline void to_srgb8_span(std::span<const vec4<float>> in, std::span<u8vec4> out)
+        {
+            std::size_t i = 0;
+#if defined(GEM_SSE)
+            // One pixel per register, 4 pixels per iteration. The alpha lane is looked up as well (the clamp keeps
+            // its index in range) and replaced afterwards. Slope and mantissa step fit in 16 bits, so _mm_madd_epi16
+            // is their 32-bit product
+            const __m128 low = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int32>(srgb8_encode_min)));
+            const __m128 high = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int32>(srgb8_encode_max)));
+            const __m128i min_bits = _mm_set1_epi32(static_cast<int32>(srgb8_encode_min));
+            const __m128i low_16 = _mm_set1_epi32(0xffff);
+            const __m128i low_8 = _mm_set1_epi32(0xff);
+            const __m128 scale = _mm_set1_ps(255.0f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128i alpha_lane = _mm_setr_epi32(0, 0, 0, -1);
+            const int32* table = reinterpret_cast<const int32*>(srgb8_encode_table);
+            auto encode1 = [&](const float* src) {
+                __m128 color = _mm_loadu_ps(src);
+                __m128i bits = _mm_castps_si128(_mm_min_ps(_mm_max_ps(color, low), high));
+                __m128i index = _mm_srli_epi32(_mm_sub_epi32(bits, min_bits), 20);
+#if defined(GEM_AVX2)
+                __m128i entry = _mm_i32gather_epi32(table, index, 4);
+#else
+                alignas(16) int32 lanes[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes), index);
+                __m128i entry = _mm_setr_epi32(table[lanes[0]], table[lanes[1]], table[lanes[2]], table[lanes[3]]);
+#endif
+                __m128i bias = _mm_slli_epi32(_mm_srli_epi32(entry, 16), 9);
+                __m128i t = _mm_and_si128(_mm_srli_epi32(bits, 12), low_8);
+                __m128i srgb = _mm_srli_epi32(_mm_add_epi32(bias, _mm_madd_epi16(_mm_and_si128(entry, low_16), t)), 16);
+                __m128i alpha = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(color, scale), zero), scale));
+                return _mm_or_si128(_mm_and_si128(alpha_lane, alpha), _mm_andnot_si128(alpha_lane, srgb));
+            };
+            for (; i + 4 <= in.size(); i += 4)
+            {
+                const float* src = &in[i].x;
+                __m128i p01 = _mm_packs_epi32(encode1(src), encode1(src + 4));
+                __m128i p23 = _mm_packs_epi32(encode1(src + 8), encode1(src + 12));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), _mm_packus_epi16(p01, p23));
+            }
+#endif
+            for (; i < in.size(); i++)
+                out[i] = linear_to_srgb8(in[i]);
+        }
+
+        // Table lookups, the gathers cost about as much as the scalar loads
+        inline void srgb8_to_linear_span(std::span<const u8vec4> in, std::span<vec4<float>> out)
+        {
+            const float* table = srgb8_table();
+            for (std::size_t i = 0; i < in.size(); i++)
+                out[i] = vec4<float>(table[in[i].x], table[in[i].y], table[in[i].z], in[i].w * (1.0f / 255.0f));
+        }
+
+        inline void premultiply_rgba8_span(std::span<const u8vec4> in, std::span<u8vec4> out)
+        {
+            std::size_t i = 0;
+#if defined(GEM_SSE)
+            // 2 pixels per 16-bit register, (t + (t >> 8)) >> 8 with t = c * a + 128 like the scalar function
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i bias = _mm_set1_epi16(128);
+            const __m128i alpha_lanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+            auto premultiply2 = [&](__m128i c) {
+                __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                __m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a), bias);
+                __m128i p = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+                return _mm_or_si128(_mm_and_si128(alpha_lanes, c), _mm_andnot_si128(alpha_lanes, p));
+            };
+            for (; i + 4 <= in.size(); i += 4)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+                __m128i low = premultiply2(_mm_unpacklo_epi8(bytes, zero));
+                __m128i high = premultiply2(_mm_unpackhi_epi8(bytes, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), _mm_packus_epi16(low, high));
+            }
+#endif
+            for (; i < in.size(); i++)
+                out[i] = premultiply(in[i]);
+        }
+
+        inline void unpremultiply_rgba8_span(std::span<const u8vec4> in, std::span<u8vec4> out)
+        {
+            std::size_t i = 0;
+#if defined(GEM_SSE)
+            // One pixel per float register, floor((c * 255 + a / 2) / a) equals the integer division of the
+            // scalar function: the float quotient is off by less than 1 / a, the distance to the next integer
+            const __m128i zero = _mm_setzero_si128();
+            const __m128 scale = _mm_set1_ps(255.0f);
+            const __m128 alpha_lane = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+            auto unpremultiply1 = [&](__m128i c) {
+                __m128 color = _mm_cvtepi32_ps(c);
+                __m128 a = _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3));
+                __m128 half = _mm_cvtepi32_ps(_mm_srli_epi32(_mm_shuffle_epi32(c, _MM_SHUFFLE(3, 3, 3, 3)), 1));
+                __m128 q = _mm_min_ps(_mm_div_ps(_mm_add_ps(_mm_mul_ps(color, scale), half), a), scale);
+                q = _mm_and_ps(q, _mm_cmpgt_ps(a, _mm_setzero_ps()));
+                return _mm_cvttps_epi32(_mm_or_ps(_mm_and_ps(alpha_lane, color), _mm_andnot_ps(alpha_lane, q)));
+            };
+            for (; i + 4 <= in.size(); i += 4)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+                __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                __m128i high = _mm_unpackhi_epi8(bytes, zero);
+                __m128i p01 = _mm_packs_epi32(unpremultiply1(_mm_unpacklo_epi16(low, zero)), unpremultiply1(_mm_unpackhi_epi16(low, zero)));
+                __m128i p23 = _mm_packs_epi32(unpremultiply1(_mm_unpacklo_epi16(high, zero)), unpremultiply1(_mm_unpackhi_epi16(high, zero)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), _mm_packus_epi16(p01, p23));
+            }
+#endif
+            for (; i < in.size(); i++)
+                out[i] = unpremultiply(in[i]);
+        }
+
+    }
+
+    // RGBA8 <-> normalized float
+    // in and out have different pixel sizes and must not overlap, the smaller of both sizes is processed
+
+    // out[i] = rgb_to_normalized(in[i])
+    inline void to_normalized(std::span<const u8vec4> in, std::span<vec4<float>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::to_normalized_span(src, dst); });
+    }
+
+    // out[i] = normalized_to_rgb(in[i]), clamped to [0, 1] and rounded to nearest
+    inline void to_rgba8(std::span<const vec4<float>> in, std::span<u8vec4> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::to_rgba8_span(src, dst); });
+    }
+
+    inline void to_normalized(const image_view<const u8vec4>& in, const image_view<vec4<float>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::to_normalized_span(src, dst); });
+    }
+
+    inline void to_rgba8(const image_view<const vec4<float>>& in, const image_view<u8vec4>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::to_rgba8_span(src, dst); });
+    }
+
+    // RGB <-> HSV
+    // Colors are (r, g, b, a) and (h, s, v, a), alpha passes through. The widest SIMD pack converts
+    // a whole register of pixels at once, loaded and stored with a 4x4 transpose
+    // Float and double colors may be converted in place, packed pixels go through float chunks on the stack
+
+    // out[i] = rgb_to_hsv(in[i])
+    inline void rgb_to_hsv(std::span<const vec4<float>> in, std::span<vec4<float>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::rgb_to_hsv_span<float>(src, dst); });
+    }
+
+    inline void rgb_to_hsv(std::span<const vec4<double>> in, std::span<vec4<double>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::rgb_to_hsv_span<double>(src, dst); });
+    }
+
+    // out[i] = hsv_to_rgb(in[i])
+    inline void hsv_to_rgb(std::span<const vec4<float>> in, std::span<vec4<float>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::hsv_to_rgb_span<float>(src, dst); });
+    }
+
+    inline void hsv_to_rgb(std::span<const vec4<double>> in, std::span<vec4<double>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::hsv_to_rgb_span<double>(src, dst); });
+    }
+
+    // Packed pixels, out[i] = rgb_to_hsv(rgb_to_normalized(in[i])), alpha normalized as well
+    inline void rgb_to_hsv(std::span<const u8vec4> in, std::span<vec4<float>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](std::span<const u8vec4> a, std::span<vec4<float>> b) {
+            for (std::size_t i = 0; i < a.size(); i += detail::color_chunk)
+            {
+                std::span<vec4<float>> chunk = b.subspan(i, detail::color_count(detail::color_chunk, a.size() - i));
+                detail::to_normalized_span(a.subspan(i, chunk.size()), chunk);
+                detail::rgb_to_hsv_span<float>(chunk, chunk);
+            }
+        });
+    }
+
+    // Packed pixels, out[i] = normalized_to_rgb(hsv_to_rgb(in[i]))
+    inline void hsv_to_rgb(std::span<const vec4<float>> in, std::span<u8vec4> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::map_to_rgba8(src, dst, detail::hsv_to_rgb_span<float>); });
+    }
+
+    inline void rgb_to_hsv(const image_view<const vec4<float>>& in, const image_view<vec4<float>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::rgb_to_hsv_span<float>(src, dst); });
+    }
+
+    inline void rgb_to_hsv(const image_view<const vec4<double>>& in, const image_view<vec4<double>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::rgb_to_hsv_span<double>(src, dst); });
+    }
+
+    inline void hsv_to_rgb(const image_view<const vec4<float>>& in, const image_view<vec4<float>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::hsv_to_rgb_span<float>(src, dst); });
+    }
+
+    inline void hsv_to_rgb(const image_view<const vec4<double>>& in, const image_view<vec4<double>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::hsv_to_rgb_span<double>(src, dst); });
+    }
+
+    inline void rgb_to_hsv(const image_view<const u8vec4>& in, const image_view<vec4<float>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { rgb_to_hsv(src, dst, execution::seq); });
+    }
+
+    inline void hsv_to_rgb(const image_view<const vec4<float>>& in, const image_view<u8vec4>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { hsv_to_rgb(src, dst, execution::seq); });
+    }
+
+    // sRGB <-> linear
+    // Float colors use the fast::pow curves of srgb_to_linear and linear_to_srgb and may be converted in place,
+    // packed sRGB pixels are decoded with a 256 entry table and encoded with the bucket table of linear_to_srgb8
+
+    // out[i] = srgb_to_linear<A>(in[i])
+    template<fast::accuracy A = fast::accuracy::high>
+    void srgb_to_linear(std::span<const vec4<float>> in, std::span<vec4<float>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::srgb_to_linear_span<A>(src, dst); });
+    }
+
+    // out[i] = linear_to_srgb<A>(in[i])
+    template<fast::accuracy A = fast::accuracy::high>
+    void linear_to_srgb(std::span<const vec4<float>> in, std::span<vec4<float>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::linear_to_srgb_span<A>(src, dst); });
+    }
+
+    // out[i] = srgb_to_linear(in[i]), from the exact table
+    inline void srgb_to_linear(std::span<const u8vec4> in, std::span<vec4<float>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::srgb8_to_linear_span(src, dst); });
+    }
+
+    // out[i] = linear_to_srgb8(in[i])
+    inline void linear_to_srgb(std::span<const vec4<float>> in, std::span<u8vec4> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::to_srgb8_span(src, dst); });
+    }
+
+    template<fast::accuracy A = fast::accuracy::high>
+    void srgb_to_linear(const image_view<const vec4<float>>& in, const image_view<vec4<float>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::srgb_to_linear_span<A>(src, dst); });
+    }
+
+    template<fast::accuracy A = fast::accuracy::high>
+    void linear_to_srgb(const image_view<const vec4<float>>& in, const image_view<vec4<float>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::linear_to_srgb_span<A>(src, dst); });
+    }
+
+    inline void srgb_to_linear(const image_view<const u8vec4>& in, const image_view<vec4<float>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::srgb8_to_linear_span(src, dst); });
+    }
+
+    inline void linear_to_srgb(const image_view<const vec4<float>>& in, const image_view<u8vec4>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::to_srgb8_span(src, dst); });
+    }
+
+    // Tonemapping
+    // HDR float colors to [0, 1], in place or not, alpha passes through
+
+    // out[i] = tonemap_reinhard(in[i], white)
+    inline void tonemap_reinhard(std::span<const vec4<float>> in, std::span<vec4<float>> out, float white = std::numeric_limits<float>::infinity(),
+                                 execution::policy policy = execution::par)
+    {
+        float inv_white2 = 1 / (white * white);
+        detail::parallel_spans(in, out, policy, [inv_white2](auto src, auto dst) {
+            detail::map_pixels(src, dst, [inv_white2]<typename P>(P& r, P& g, P& b, P&) {
+                P w = P::broadcast(inv_white2);
+                r = detail::tonemap_reinhard(r, w);
+                g = detail::tonemap_reinhard(g, w);
+                b = detail::tonemap_reinhard(b, w);
+            });
+        });
+    }
+
+    // out[i] = tonemap_aces(in[i])
+    inline void tonemap_aces(std::span<const vec4<float>> in, std::span<vec4<float>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) {
+            detail::map_pixels(src, dst, [](auto& r, auto& g, auto& b, auto&) {
+                r = detail::tonemap_aces(r);
+                g = detail::tonemap_aces(g);
+                b = detail::tonemap_aces(b);
+            });
+        });
+    }
+
+    inline void tonemap_reinhard(const image_view<const vec4<float>>& in, const image_view<vec4<float>>& out,
+                                 float white = std::numeric_limits<float>::infinity(), execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [white](auto src, auto dst) { tonemap_reinhard(src, dst, white, execution::seq); });
+    }
+
+    inline void tonemap_aces(const image_view<const vec4<float>>& in, const image_view<vec4<float>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { tonemap_aces(src, dst, execution::seq); });
+    }
+
+    // Premultiplied alpha
+    // in and out may be the same span
+
+    // out[i] = premultiply(in[i])
+    inline void premultiply(std::span<const vec4<float>> in, std::span<vec4<float>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) {
+            detail::map_pixels(src, dst, [](auto& r, auto& g, auto& b, auto& alpha) {
+                r = r * alpha;
+                g = g * alpha;
+                b = b * alpha;
+            });
+        });
+    }
+
+    // out[i] = unpremultiply(in[i])
+    inline void unpremultiply(std::span<const vec4<float>> in, std::span<vec4<float>> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) {
+            detail::map_pixels(src, dst, [](auto& r, auto& g, auto& b, auto& alpha) {
+                auto inv = detail::inverse_alpha(alpha);
+                r = r * inv;
+                g = g * inv;
+                b = b * inv;
+            });
+        });
+    }
+
+    inline void premultiply(std::span<const u8vec4> in, std::span<u8vec4> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::premultiply_rgba8_span(src, dst); });
+    }
+
+    inline void unpremultiply(std::span<const u8vec4> in, std::span<u8vec4> out, execution::policy policy = execution::par)
+    {
+        detail::parallel_spans(in, out, policy, [](auto src, auto dst) { detail::unpremultiply_rgba8_span(src, dst); });
+    }
+
+    inline void premultiply(const image_view<const vec4<float>>& in, const image_view<vec4<float>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { premultiply(src, dst, execution::seq); });
+    }
+
+    inline void unpremultiply(const image_view<const vec4<float>>& in, const image_view<vec4<float>>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { unpremultiply(src, dst, execution::seq); });
+    }
+
+    inline void premultiply(const image_view<const u8vec4>& in, const image_view<u8vec4>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::premultiply_rgba8_span(src, dst); });
+    }
+
+    inline void unpremultiply(const image_view<const u8vec4>& in, const image_view<u8vec4>& out, execution::policy policy = execution::par)
+    {
+        detail::parallel_rows(in, out, policy, [](auto src, auto dst) { detail::unpremultiply_rgba8_span(src, dst); });
+    }
+
+}
+
+#endif // GEM_COLOR_HPP
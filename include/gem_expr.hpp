@@ -0,0 +1,406 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_EXPR_HPP
+#define GEM_EXPR_HPP
+
+#include "gem_math.hpp"
+
+// std
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Expression templates
+// Opt in lazy evaluation of componentwise vec2, vec3, vec4 and quaternion arithmetic. gem::expr::lazy wraps a value,
+// a scalar or an array (span or vector) of either, and the operators on the wrappers build an expression instead of
+// computing anything. Assigning an expression to an array evaluates every element in one loop, component by component,
+// so a chain like a * s + b * t - c makes no temporaries, neither vectors nor arrays:
+//   gem::expr::lazy(positions) += gem::expr::lazy(velocities) * dt;
+//   gem::expr::lazy(out) = gem::expr::lazy(a) * s + gem::expr::lazy(b) * gem::expr::lazy(weights) - gem::vec3<float>(2.0f, -5.0f, 1.0f);
+// Every component goes through the same operations in the same order as the eager operators, so results are identical
+// Only componentwise operations exist here: quaternion products, dot and cross products stay eager
+namespace gem::expr {
+
+    namespace detail {
+
+        template<typename V>
+        struct vector_traits
+        {
+            static constexpr bool is_vector = false;
+        };
+
+        template<typename T>
+        struct vector_traits<vec2<T>>
+        {
+            static constexpr bool is_vector = true;
+            static constexpr int size = 2;
+            using scalar = T;
+        };
+
+        template<typename T>
+        struct vector_traits<vec3<T>>
+        {
+            static constexpr bool is_vector = true;
+            static constexpr int size = 3;
+            using scalar = T;
+        };
+
+        template<typename T>
+        struct vector_traits<vec4<T>>
+        {
+            static constexpr bool is_vector = true;
+            static constexpr int size = 4;
+            using scalar = T;
+        };
+
+        template<typename T>
+        struct vector_traits<quaternion<T>>
+        {
+            static constexpr bool is_vector = true;
+            static constexpr int size = 4;
+            using scalar = T;
+        };
+
+        template<typename V>
+        inline constexpr bool is_vector = vector_traits<std::remove_cvref_t<V>>::is_vector;
+
+        template<int C, typename V>
+        constexpr auto& component(V& v)
+        {
+            if constexpr (C == 0)
+                return v.x;
+            else if constexpr (C == 1)
+                return v.y;
+            else if constexpr (C == 2)
+                return v.z;
+            else
+                return v.w;
+        }
+
+        // Size of expressions without arrays
+        inline constexpr std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+
+        struct add
+        {
+            template<typename A, typename B>
+            constexpr auto operator()(A a, B b) const { return a + b; }
+        };
+
+        struct substract
+        {
+            template<typename A, typename B>
+            constexpr auto operator()(A a, B b) const { return a - b; }
+        };
+
+        struct multiply
+        {
+            template<typename A, typename B>
+            constexpr auto operator()(A a, B b) const { return a * b; }
+        };
+
+        struct divide
+        {
+            template<typename A, typename B>
+            constexpr auto operator()(A a, B b) const { return a / b; }
+        };
+
+    }
+
+    // Expression nodes have a value_type, is_vector, size() (the smallest array, detail::unbounded without arrays)
+    // and either component<C>(i) (vectors) or scalar(i) (scalars) for element i
+    template<typename E>
+    concept expression = requires { std::remove_cvref_t<E>::is_expression; };
+
+    namespace detail {
+
+        template<typename V>
+        inline constexpr bool is_quaternion = false;
+
+        template<typename T>
+        inline constexpr bool is_quaternion<quaternion<T>> = true;
+
+        // The vector type of the operands, or the common scalar type
+        template<typename L, typename R>
+        struct result : std::common_type<typename L::value_type, typename R::value_type>
+        {
+        };
+
+        template<typename L, typename R>
+        requires (L::is_vector || R::is_vector)
+        struct result<L, R>
+        {
+            using type = std::conditional_t<L::is_vector, typename L::value_type, typename R::value_type>;
+        };
+
+        template<typename V, typename E, int... C>
+        constexpr void store(V& out, const E& e, std::size_t i, std::integer_sequence<int, C...>)
+        {
+            ((component<C>(out) = e.template component<C>(i)), ...);
+        }
+
+        // out[i] = e[i] for the first min(count, e.size()) elements. Element i only reads element i of the operands,
+        // so out may alias any of them. The element is built in a local first: stores through out could alias the
+        // operands and would force a reload of every operand after each component
+        template<typename V, typename E>
+        constexpr void assign(V* out, std::size_t count, const E& e)
+        {
+            static_assert(std::is_same_v<V, typename E::value_type>, "the expression must have the element type of the array");
+            count = std::min(count, e.size());
+            for (std::size_t i = 0; i < count; i++)
+            {
+                if constexpr (E::is_vector)
+                {
+                    V element{};
+                    store(element, e, i, std::make_integer_sequence<int, vector_traits<V>::size>());
+                    out[i] = element;
+                }
+                else
+                    out[i] = e.scalar(i);
+            }
+        }
+
+    }
+
+    // One value (vector or scalar) used for every element
+    template<typename V>
+    struct value
+    {
+        static constexpr bool is_expression = true;
+        static constexpr bool is_vector = detail::is_vector<V>;
+        using value_type = V;
+
+        V v;
+
+        constexpr std::size_t size() const
+        {
+            return detail::unbounded;
+        }
+
+        template<int C>
+        constexpr auto component(std::size_t) const
+        {
+            return detail::component<C>(v);
+        }
+
+        constexpr V scalar(std::size_t) const
+        {
+            return v;
+        }
+    };
+
+    // An array of vectors or scalars, element i is data[i]. Assigning an expression to an array evaluates it
+    // into the elements (like std::slice_array), the wrapper itself is never reseated
+    template<typename V>
+    struct array
+    {
+        static constexpr bool is_expression = true;
+        static constexpr bool is_vector = detail::is_vector<V>;
+        using value_type = std::remove_const_t<V>;
+
+        V* data = nullptr;
+        std::size_t count = 0;
+
+        constexpr array(V* data, std::size_t count)
+            : data(data), count(count)
+        {
+        }
+
+        constexpr array(const array&) = default;
+
+        constexpr std::size_t size() const
+        {
+            return count;
+        }
+
+        template<int C>
+        constexpr auto component(std::size_t i) const
+        {
+            return detail::component<C>(data[i]);
+        }
+
+        constexpr value_type scalar(std::size_t i) const
+        {
+            return data[i];
+        }
+
+        constexpr const array& operator=(const array& other) const requires (!std::is_const_v<V>)
+        {
+            detail::assign(data, count, other);
+            return *this;
+        }
+
+        template<expression E>
+        constexpr const array& operator=(const E& e) const requires (!std::is_const_v<V>)
+        {
+            detail::assign(data, count, e);
+            return *this;
+        }
+
+        template<typename E>
+        constexpr const array& operator+=(const E& e) const requires (!std::is_const_v<V>)
+        {
+            return *this = *this + e;
+        }
+
+        template<typename E>
+        constexpr const array& operator-=(const E& e) const requires (!std::is_const_v<V>)
+        {
+            return *this = *this - e;
+        }
+
+        template<typename E>
+        constexpr const array& operator*=(const E& e) const requires (!std::is_const_v<V>)
+        {
+            return *this = *this * e;
+        }
+
+        template<typename E>
+        constexpr const array& operator/=(const E& e) const requires (!std::is_const_v<V>)
+        {
+            return *this = *this / e;
+        }
+    };
+
+    // Op applied per component, vector op scalar uses the scalar for every component. The scalar is converted to the
+    // component type first, as the eager vecN<T> operators take T, so lazy(a) * 0.1 on vec3<float> multiplies by 0.1f
+    template<typename Op, typename L, typename R>
+    struct binary
+    {
+        static constexpr bool is_expression = true;
+        static constexpr bool is_vector = L::is_vector || R::is_vector;
+        using value_type = typename detail::result<L, R>::type;
+
+        static_assert(!(L::is_vector && R::is_vector) || std::is_same_v<typename L::value_type, typename R::value_type>,
+                      "both operands must have the same vector type");
+        static_assert(!R::is_vector || L::is_vector || std::is_same_v<Op, detail::multiply>,
+                      "a scalar can only be on the left of a vector in a product");
+        static_assert(!(L::is_vector && R::is_vector) || !detail::is_quaternion<value_type> ||
+                      std::is_same_v<Op, detail::add> || std::is_same_v<Op, detail::substract>,
+                      "quaternion products are not componentwise, evaluate them eagerly");
+
+        L left;
+        R right;
+
+        constexpr std::size_t size() const
+        {
+            return std::min(left.size(), right.size());
+        }
+
+        template<int C>
+        constexpr auto component(std::size_t i) const
+        {
+            using scalar = typename detail::vector_traits<value_type>::scalar;
+            if constexpr (L::is_vector && R::is_vector)
+                return static_cast<scalar>(Op{}(left.template component<C>(i), right.template component<C>(i)));
+            else if constexpr (L::is_vector)
+                return static_cast<scalar>(Op{}(left.template component<C>(i), static_cast<scalar>(right.scalar(i))));
+            else
+                return static_cast<scalar>(Op{}(static_cast<scalar>(left.scalar(i)), right.template component<C>(i)));
+        }
+
+        constexpr value_type scalar(std::size_t i) const
+        {
+            return static_cast<value_type>(Op{}(left.scalar(i), right.scalar(i)));
+        }
+    };
+
+    // Wrappers
+    // Arrays are views, the data must outlive the expression. Values are copied
+
+    template<typename V>
+    constexpr array<V> lazy(std::span<V> values)
+    {
+        return { values.data(), values.size() };
+    }
+
+    template<typename V, typename A>
+    constexpr array<V> lazy(std::vector<V, A>& values)
+    {
+        return { values.data(), values.size() };
+    }
+
+    template<typename V, typename A>
+    constexpr array<const V> lazy(const std::vector<V, A>& values)
+    {
+        return { values.data(), values.size() };
+    }
+
+    template<typename V>
+    requires (detail::is_vector<V> || std::is_arithmetic_v<V>)
+    constexpr value<V> lazy(const V& v)
+    {
+        return { v };
+    }
+
+    template<expression E>
+    constexpr E lazy(const E& e)
+    {
+        return e;
+    }
+
+    // Element i of an expression, evaluate(e) for expressions without arrays
+    template<expression E>
+    constexpr typename E::value_type evaluate(const E& e, std::size_t i = 0)
+    {
+        typename E::value_type result{};
+        if constexpr (E::is_vector)
+            detail::store(result, e, i, std::make_integer_sequence<int, detail::vector_traits<typename E::value_type>::size>());
+        else
+            result = e.scalar(i);
+        return result;
+    }
+
+    // Operators, at least one operand is an expression, the other may be a vector or a scalar
+
+    namespace detail {
+
+        template<typename T>
+        concept operand = expression<T> || is_vector<T> || std::is_arithmetic_v<std::remove_cvref_t<T>>;
+
+        template<typename Op, typename L, typename R>
+        constexpr auto make_binary(const L& left, const R& right)
+        {
+            using left_node = decltype(lazy(left));
+            using right_node = decltype(lazy(right));
+            return binary<Op, left_node, right_node>{ lazy(left), lazy(right) };
+        }
+
+    }
+
+    template<detail::operand L, detail::operand R>
+    requires (expression<L> || expression<R>)
+    constexpr auto operator+(const L& left, const R& right)
+    {
+        return detail::make_binary<detail::add>(left, right);
+    }
+
+    template<detail::operand L, detail::operand R>
+    requires (expression<L> || expression<R>)
+    constexpr auto operator-(const L& left, const R& right)
+    {
+        return detail::make_binary<detail::substract>(left, right);
+    }
+
+    template<detail::operand L, detail::operand R>
+    requires (expression<L> || expression<R>)
+    constexpr auto operator*(const L& left, const R& right)
+    {
+        return detail::make_binary<detail::multiply>(left, right);
+    }
+
+    template<detail::operand L, detail::operand R>
+    requires (expression<L> || expression<R>)
+    constexpr auto operator/(const L& left, const R& right)
+    {
+        return detail::make_binary<detail::divide>(left, right);
+    }
+
+}
+
+#endif // GEM_EXPR_HPP
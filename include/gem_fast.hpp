@@ -0,0 +1,422 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_FAST_HPP
+#define GEM_FAST_HPP
+
+#include "gem_base.hpp"
+#include "gem_simd.hpp"
+
+// std
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+
+// Fast approximate math
+// Polynomial and Newton step replacements for the <cmath> functions used on hot paths. Every function
+// is written once over the lane packs of gem_simd.hpp, so the scalar overloads and the SIMD lanes give
+// the same results. Accuracy is chosen at compile time, max errors measured by bench/fast.cpp:
+//
+//                    accuracy::high                 accuracy::low
+//   rsqrt      float 2.6e-7 relative (4 ulp)        3.3e-4 relative (hardware estimate, 4.7e-6 without SSE)
+//             double 2.7e-16 relative (2 ulp)       4.6e-6 relative
+//   rcp        float 2.0e-7 relative (4 ulp)        3.0e-4 relative (hardware estimate, 6.7e-6 without SSE)
+//             double 2.8e-16 relative (2 ulp)       6.6e-6 relative
+//   sin, cos   float 9.2e-8 absolute                1.3e-5 absolute
+//             double 1.7e-16 absolute               1.3e-5 absolute
+//   atan2      float 2.7e-7 absolute                6.3e-6 absolute
+//             double 4.8e-16 absolute               6.3e-6 absolute
+//   acos       float 2.9e-7 absolute                2.7e-5 absolute
+//             double 5.2e-16 absolute               2.7e-5 absolute
+//   log2       float 2.6 ulp                        3.8e-6 absolute
+//             double 1.9 ulp                        1.9e-6 absolute
+//   exp2       float 9.2e-8 relative                3.3e-6 relative
+//             double 2.2e-16 relative               3.3e-6 relative
+//   pow        float 2.3e-6 relative                8.0e-6 relative
+//             double 4.9e-15 relative               8.0e-6 relative
+//
+// rsqrt needs x > 0 and rcp a normal x of either sign with a normal reciprocal. sin and cos keep these bounds
+// for |x| <= 8192 (float) or 1e6 (double), acos needs x in [-1, 1] and atan2 does not tell +0 from -0.
+// log2 and pow need positive normal x, pow is measured for x in (0, 2] and |y| <= 4 and its error is that
+// of exp2 plus |y * log2(x)| times the log2 error, which peaks for the smallest x. NaN and infinite inputs give unspecified results.
+// The speedup is in the packs, scalar sin and cos calls cost about as much as the <cmath> ones
+namespace gem::fast {
+
+    enum class accuracy
+    {
+        high, // close to the <cmath> functions, at a fraction of their cost
+        low,  // shorter polynomials and no refinement, for visuals and heuristics
+    };
+
+    // Pack kernels, P is any gem::simd pack (scalar, f32x4, f32x8, f64x2, f64x4)
+    template<typename P>
+    concept lane_pack = requires { typename P::value_type; typename P::mask_type; P::width; };
+
+    namespace detail {
+
+        template<typename P>
+        P constant(double value)
+        {
+            return P::broadcast(static_cast<typename P::value_type>(value));
+        }
+
+        template<typename P>
+        inline constexpr bool is_double = std::is_same_v<typename P::value_type, double>;
+
+        // Nearest integer for |x| < 2^22 (float) or 2^51 (double), adding and removing 1.5 * 2^mantissa bits
+        template<typename P>
+        P round(P x)
+        {
+            P bias = constant<P>(is_double<P> ? 6755399441055744.0 : 12582912.0);
+            return (x + bias) - bias;
+        }
+
+        // Taylor coefficients, 2^x = sum exp2_series[k] * x^k and, with s = (m - 1) / (m + 1),
+        // log2(m) = s * sum log2_series[k] * s^2k (the atanh series scaled by 2 / ln(2))
+        inline constexpr double exp2_series[] = { 1.0, 0.6931471805599453, 0.2402265069591007, 0.055504108664821576, 0.009618129107628477,
+                                                  0.0013333558146428441, 0.00015403530393381606, 1.5252733804059838e-05 };
+        inline constexpr double log2_series[] = { 2.8853900817779268, 0.9617966939259756, 0.5770780163555853, 0.4121985831111324,
+                                                  0.3205988979753252, 0.2623081892525388, 0.22195308321368667, 0.19235933878519512,
+                                                  0.16972882833987804, 0.15186263588304877, 0.1373995277037108 };
+
+        // First N coefficients evaluated with Horner's rule
+        template<std::size_t N, typename P>
+        P polynomial(P x, const double* coefficients)
+        {
+            P result = constant<P>(coefficients[N - 1]);
+            for (std::size_t k = N - 1; k > 0; k--)
+                result = result * x + constant<P>(coefficients[k - 1]);
+            return result;
+        }
+
+        // atan(t) for t in [0, 1], reduced around tan(pi / 8) to an odd polynomial in [-0.4143, 0.4143]
+        template<accuracy A, typename P>
+        P atan_unit(P t)
+        {
+            auto c = [](double value) { return constant<P>(value); };
+
+            typename P::mask_type big = t > c(0.41421356237309504880);
+            P u = select(big, (t - c(1.0)) / (t + c(1.0)), t);
+            P base = select(big, c(0.78539816339744830962), c(0.0));
+            P z = u * u;
+
+            P p;
+            if constexpr (A == accuracy::low)
+            {
+                p = c(-0.33156819280594780) + z * c(0.16856612226055692);
+            }
+            else if constexpr (is_double<P>)
+            {
+                // Cephes atan, rational approximation
+                P num = (((c(-8.750608600031904122785e-1) * z + c(-1.615753718733365076637e1)) * z + c(-7.500855792314704667340e1)) * z +
+                         c(-1.228866684490136173410e2)) * z + c(-6.485021904942025371773e1);
+                P den = ((((z + c(2.485846490142306297962e1)) * z + c(1.650270098316988542046e2)) * z + c(4.328810604912902668951e2)) * z +
+                         c(4.853903996359136964868e2)) * z + c(1.945506571482613964425e2);
+                p = num / den;
+            }
+            else
+            {
+                // Cephes atanf
+                p = ((c(8.05374449538e-2) * z + c(-1.38776856032e-1)) * z + c(1.99777106478e-1)) * z + c(-3.33329491539e-1);
+            }
+
+            return base + (u + u * z * p);
+        }
+
+        // (asin(s) - s) / s^3 as a function of z = s^2, s in [0, 0.5]
+        template<accuracy A, typename P>
+        P asin_poly(P z)
+        {
+            auto c = [](double value) { return constant<P>(value); };
+
+            if constexpr (A == accuracy::low)
+            {
+                return c(0.16470905424980860) + z * c(0.095894632900700730);
+            }
+            else if constexpr (is_double<P>)
+            {
+                // Cephes asin, rational approximation
+                P num = ((((c(4.253011369004428248960e-3) * z + c(-6.019598008014123785661e-1)) * z + c(5.444622390564711410273e0)) * z +
+                          c(-1.626247967210700244449e1)) * z + c(1.956261983317594739197e1)) * z + c(-8.198089802484824371615e0);
+                P den = ((((z + c(-1.474091372988853791896e1)) * z + c(7.049610280856842141659e1)) * z + c(-1.471791292232726029859e2)) * z +
+                         c(1.395105614657485689735e2)) * z + c(-4.918853881490881290097e1);
+                return num / den;
+            }
+            else
+            {
+                // Cephes asinf
+                return (((c(4.2163199048e-2) * z + c(2.4181311049e-2)) * z + c(4.5470025998e-2)) * z + c(7.4953002686e-2)) * z + c(1.6666752422e-1);
+            }
+        }
+
+    }
+
+    // 1 / sqrt(x)
+    template<accuracy A = accuracy::high, lane_pack P>
+    P rsqrt(P x)
+    {
+        P y = rsqrt_estimate(x);
+        if constexpr (A == accuracy::high)
+        {
+            P half = x * detail::constant<P>(0.5), three_halves = detail::constant<P>(1.5);
+            y = y * (three_halves - half * y * y);
+            if constexpr (detail::is_double<P>)
+                y = y * (three_halves - half * y * y);
+        }
+        return y;
+    }
+
+    // 1 / x
+    template<accuracy A = accuracy::high, lane_pack P>
+    P rcp(P x)
+    {
+        P y = rcp_estimate(x);
+        if constexpr (A == accuracy::high)
+        {
+            P two = detail::constant<P>(2.0);
+            y = y * (two - x * y);
+            if constexpr (detail::is_double<P>)
+                y = y * (two - x * y);
+        }
+        return y;
+    }
+
+    // sin(x) and cos(x) together, x in radians
+    template<accuracy A = accuracy::high, lane_pack P>
+    void sincos(P x, P& sin, P& cos)
+    {
+        auto c = [](double value) { return detail::constant<P>(value); };
+
+        // x = q * pi / 2 + r with r in [-pi / 4, pi / 4], pi / 2 split in three parts so q * part is exact
+        P q = detail::round(x * c(0.63661977236758134308));
+        P r;
+        if constexpr (detail::is_double<P>)
+            r = ((x - q * c(1.57079625129699707031)) - q * c(7.54978941586159635336e-8)) - q * c(5.39030285815811905290e-15);
+        else
+            r = ((x - q * c(1.5703125)) - q * c(4.837512969970703125e-4)) - q * c(7.54978995489188216e-8);
+
+        P z = r * r;
+        P s, k;
+        if constexpr (A == accuracy::low)
+        {
+            s = r + r * z * (c(-0.16662833726088747) + z * c(0.0081529909011807970));
+            k = c(1.0) + z * (c(-0.49977630917302424) + z * c(0.040488940021701746));
+        }
+        else if constexpr (detail::is_double<P>)
+        {
+            // Cephes sin / cos
+            s = r + r * z * (((((c(1.58962301576546568060e-10) * z + c(-2.50507477628578072866e-8)) * z + c(2.75573136213857245213e-6)) * z +
+                               c(-1.98412698295895385996e-4)) * z + c(8.33333333332211858878e-3)) * z + c(-1.66666666666666307295e-1));
+            k = c(1.0) - c(0.5) * z + z * z * (((((c(-1.13585365213876817300e-11) * z + c(2.08757008419747316778e-9)) * z +
+                                                  c(-2.75573141792967388112e-7)) * z + c(2.48015872888517045348e-5)) * z +
+                                                c(-1.38888888888730564116e-3)) * z + c(4.16666666666665929218e-2));
+        }
+        else
+        {
+            // Cephes sinf / cosf
+            s = r + r * z * ((c(-1.9515295891e-4) * z + c(8.3321608736e-3)) * z + c(-1.6666654611e-1));
+            k = c(1.0) - c(0.5) * z + z * z * ((c(2.443315711809948e-5) * z + c(-1.388731625493765e-3)) * z + c(4.166664568298827e-2));
+        }
+
+        // Quadrant m = q mod 4 in [-2, 2]: odd quadrants swap sin and cos, then the signs follow
+        P m = q - c(4.0) * detail::round(q * c(0.25));
+        P am = abs(m);
+        typename P::mask_type odd = (am > c(0.5)) & (am < c(1.5));
+        P sin_base = select(odd, k, s);
+        P cos_base = select(odd, s, k);
+        sin = select((m > c(1.5)) | (m < c(-0.5)), -sin_base, sin_base);
+        cos = select((m > c(0.5)) | (m < c(-1.5)), -cos_base, cos_base);
+    }
+
+    template<accuracy A = accuracy::high, lane_pack P>
+    P sin(P x)
+    {
+        P s, c;
+        sincos<A>(x, s, c);
+        return s;
+    }
+
+    template<accuracy A = accuracy::high, lane_pack P>
+    P cos(P x)
+    {
+        P s, c;
+        sincos<A>(x, s, c);
+        return c;
+    }
+
+    // Angle of (x, y) in [-pi, pi]
+    template<accuracy A = accuracy::high, lane_pack P>
+    P atan2(P y, P x)
+    {
+        auto c = [](double value) { return detail::constant<P>(value); };
+
+        P ax = abs(x), ay = abs(y);
+        P hi = max(ax, ay), lo = min(ax, ay);
+        P t = select(hi > c(0.0), lo / hi, c(0.0));
+
+        P r = detail::atan_unit<A>(t);
+        r = select(ay > ax, c(1.57079632679489661923) - r, r);
+        r = select(x < c(0.0), c(3.14159265358979323846) - r, r);
+        return select(y < c(0.0), -r, r);
+    }
+
+    // acos(x) for x in [-1, 1], pi / 2 - asin(x) while |x| <= 0.5 and 2 * asin(sqrt((1 - |x|) / 2)) past it
+    template<accuracy A = accuracy::high, lane_pack P>
+    P acos(P x)
+    {
+        auto c = [](double value) { return detail::constant<P>(value); };
+
+        P ax = abs(x);
+        typename P::mask_type big = ax > c(0.5);
+        P z = select(big, c(0.5) * (c(1.0) - ax), x * x);
+        P s = select(big, sqrt(z), x);
+
+        P asin_s = s + s * z * detail::asin_poly<A>(z);
+        P twice = asin_s + asin_s;
+        return select(big, select(x < c(0.0), c(3.14159265358979323846) - twice, twice), c(1.57079632679489661923) - asin_s);
+    }
+
+    // log2(x) for positive normal x, x = 2^e * m with m in [sqrt(1 / 2), sqrt(2))
+    template<accuracy A = accuracy::high, lane_pack P>
+    P log2(P x)
+    {
+        auto c = [](double value) { return detail::constant<P>(value); };
+
+        P m = mantissa(x), e = exponent(x);
+        typename P::mask_type big = m > c(1.41421356237309504880);
+        m = select(big, m * c(0.5), m);
+        e = select(big, e + c(1.0), e);
+
+        P s = (m - c(1.0)) / (m + c(1.0));
+        constexpr std::size_t terms = A == accuracy::low ? 3 : detail::is_double<P> ? 11 : 5;
+        return e + s * detail::polynomial<terms>(s * s, detail::log2_series);
+    }
+
+    // 2^x, x is clamped to the normal exponent range, so large negative x give the smallest normal instead of 0
+    template<accuracy A = accuracy::high, lane_pack P>
+    P exp2(P x)
+    {
+        auto c = [](double value) { return detail::constant<P>(value); };
+
+        x = detail::is_double<P> ? min(max(x, c(-1022.0)), c(1023.0)) : min(max(x, c(-126.0)), c(127.0));
+        P n = detail::round(x);
+        P f = x - n;
+        if constexpr (A == accuracy::high && detail::is_double<P>)
+        {
+            // Cephes exp2, 2^f = 1 + 2 f P(f^2) / (Q(f^2) - f P(f^2))
+            P z = f * f;
+            P p = f * ((c(2.30933477057345225087e-2) * z + c(2.02020656693165307700e1)) * z + c(1.51390680115615096133e3));
+            P q = (z + c(2.33184211722314911771e2)) * z + c(4.36821166879210612817e3);
+            P r = p / (q - p);
+            return pow2(n) * (c(1.0) + (r + r));
+        }
+        else
+        {
+            constexpr std::size_t terms = A == accuracy::low ? 6 : 8;
+            return pow2(n) * detail::polynomial<terms>(f, detail::exp2_series);
+        }
+    }
+
+    // x^y for x > 0 as exp2(y * log2(x)), the relative error grows with |y * log2(x)|
+    template<accuracy A = accuracy::high, lane_pack P>
+    P pow(P x, P y)
+    {
+        return exp2<A>(y * log2<A>(x));
+    }
+
+    // Scalar overloads
+    template<accuracy A = accuracy::high, std::floating_point T>
+    T rsqrt(T x)
+    {
+        return rsqrt<A>(simd::scalar<T>{ x }).v;
+    }
+
+    template<accuracy A = accuracy::high, std::floating_point T>
+    T rcp(T x)
+    {
+        return rcp<A>(simd::scalar<T>{ x }).v;
+    }
+
+    template<accuracy A = accuracy::high, std::floating_point T>
+    void sincos(T x, T& sin, T& cos)
+    {
+        simd::scalar<T> s, c;
+        sincos<A>(simd::scalar<T>{ x }, s, c);
+        sin = s.v;
+        cos = c.v;
+    }
+
+    // Four sincos at once, in a single SIMD register when the target has one wide enough for T
+    template<accuracy A = accuracy::high, std::floating_point T>
+    void sincos4(const T (&x)[4], T (&sin)[4], T (&cos)[4])
+    {
+#if defined(GEM_SSE)
+        if constexpr (std::is_same_v<T, float>)
+        {
+            simd::f32x4 s, c;
+            sincos<A>(simd::f32x4{ _mm_setr_ps(x[0], x[1], x[2], x[3]) }, s, c);
+            s.store(sin);
+            c.store(cos);
+            return;
+        }
+#endif
+#if defined(GEM_AVX2)
+        if constexpr (std::is_same_v<T, double>)
+        {
+            simd::f64x4 s, c;
+            sincos<A>(simd::f64x4{ _mm256_setr_pd(x[0], x[1], x[2], x[3]) }, s, c);
+            s.store(sin);
+            c.store(cos);
+            return;
+        }
+#endif
+        for (int32 i = 0; i < 4; i++)
+            sincos<A>(x[i], sin[i], cos[i]);
+    }
+
+    template<accuracy A = accuracy::high, std::floating_point T>
+    T sin(T x)
+    {
+        return sin<A>(simd::scalar<T>{ x }).v;
+    }
+
+    template<accuracy A = accuracy::high, std::floating_point T>
+    T cos(T x)
+    {
+        return cos<A>(simd::scalar<T>{ x }).v;
+    }
+
+    template<accuracy A = accuracy::high, std::floating_point T>
+    T atan2(T y, T x)
+    {
+        return atan2<A>(simd::scalar<T>{ y }, simd::scalar<T>{ x }).v;
+    }
+
+    template<accuracy A = accuracy::high, std::floating_point T>
+    T acos(T x)
+    {
+        return acos<A>(simd::scalar<T>{ x }).v;
+    }
+
+    template<accuracy A = accuracy::high, std::floating_point T>
+    T log2(T x)
+    {
+        return log2<A>(simd::scalar<T>{ x }).v;
+    }
+
+    template<accuracy A = accuracy::high, std::floating_point T>
+    T exp2(T x)
+    {
+        return exp2<A>(simd::scalar<T>{ x }).v;
+    }
+
+    template<accuracy A = accuracy::high, std::floating_point T>
+    T pow(T x, T y)
+    {
+        return pow<A>(simd::scalar<T>{ x }, simd::scalar<T>{ y }).v;
+    }
+
+}
+
+#endif // GEM_FAST_HPP
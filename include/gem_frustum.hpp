@@ -0,0 +1,178 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_FRUSTUM_HPP
+#define GEM_FRUSTUM_HPP
+
+#include "gem_math.hpp"
+#include "gem_batch.hpp"
+#include "gem_simd.hpp"
+
+// std
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Frustum culling
+// Planes come from a view projection matrix with clip space depth in [-w, w], which is what
+// mat4::perspective and mat4::orthographic produce
+namespace gem {
+
+    template<typename T>
+    struct frustum
+    {
+        // near_plane and far_plane, windows.h defines near and far as macros
+        enum plane_index { left, right, bottom, top, near_plane, far_plane, plane_count };
+
+        // (normal, distance) with unit normals pointing inside, a point p is inside a plane when dot(normal, p) + distance >= 0
+        vec4<T> planes[plane_count];
+
+        constexpr frustum() = default;
+
+        // Gribb / Hartmann extraction, combines the w row with the x, y and z rows of the matrix
+        explicit constexpr frustum(const mat4<T>& view_projection)
+        {
+            const vec4<T>* rows = view_projection.columns;
+            planes[left] = rows[3] + rows[0];
+            planes[right] = rows[3] - rows[0];
+            planes[bottom] = rows[3] + rows[1];
+            planes[top] = rows[3] - rows[1];
+            planes[near_plane] = rows[3] + rows[2];
+            planes[far_plane] = rows[3] - rows[2];
+
+            for (vec4<T>& plane : planes)
+            {
+                T inv = 1 / sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+                plane = vec4<T>(plane.x * inv, plane.y * inv, plane.z * inv, plane.w * inv);
+            }
+        }
+
+        // Conservative tests, bounds crossing a plane count as visible. NaN bounds are outside, like in the batched culls
+        constexpr bool intersects_sphere(const vec3<T>& center, T radius) const
+        {
+            for (const vec4<T>& plane : planes)
+            {
+                if (!(plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w >= -radius))
+                    return false;
+            }
+            return true;
+        }
+
+        constexpr bool intersects(const sphere& sphere) const
+        {
+            return intersects_sphere(vec3<T>(sphere.position.x, sphere.position.y, sphere.position.z), sphere.radius);
+        }
+
+        constexpr bool intersects_aabb(const vec3<T>& min, const vec3<T>& max) const
+        {
+            vec3<T> center((min.x + max.x) * static_cast<T>(0.5), (min.y + max.y) * static_cast<T>(0.5), (min.z + max.z) * static_cast<T>(0.5));
+            vec3<T> extent((max.x - min.x) * static_cast<T>(0.5), (max.y - min.y) * static_cast<T>(0.5), (max.z - min.z) * static_cast<T>(0.5));
+
+            for (const vec4<T>& plane : planes)
+            {
+                T d = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+                T r = abs(plane.x) * extent.x + abs(plane.y) * extent.y + abs(plane.z) * extent.z;
+                if (!(d >= -r))
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+        static constexpr T abs(T value)
+        {
+            return value < 0 ? -value : value;
+        }
+    };
+
+    // Batched culling
+    // Writes the indices of the visible bounds to visible in increasing order and returns how many there are,
+    // visible must hold as many indices as there are bounds. Same results as the frustum members, whatever the policy
+    namespace detail {
+
+        // cull(begin, end, out) writes the visible indices of [begin, end) to out and returns how many. Chunks are
+        // culled in parallel, each one into visible from its first index on (it has at most as many indices as bounds),
+        // then moved down in chunk order
+        template<typename Cull>
+        std::size_t cull_batch(std::size_t count, std::size_t item_bytes, execution::policy policy, std::uint32_t* visible, Cull&& cull)
+        {
+            if (!worth_splitting(count, item_bytes))
+                return cull(std::size_t(0), count, visible);
+
+            std::size_t grain = chunk_items(item_bytes, batch_granularity);
+            std::vector<std::size_t> counts((count + grain - 1) / grain, 0);
+            parallel_for(count, grain, [&](std::size_t begin, std::size_t end) {
+                counts[begin / grain] = cull(begin, end, visible + begin);
+            }, policy);
+
+            std::size_t total = 0;
+            for (std::size_t chunk = 0; chunk < counts.size(); chunk++)
+            {
+                std::copy(visible + chunk * grain, visible + chunk * grain + counts[chunk], visible + total);
+                total += counts[chunk];
+            }
+            return total;
+        }
+
+    }
+
+    // Spheres as x, y, z = center and w = radius
+    template<typename T>
+    std::size_t cull_spheres(const frustum<T>& frustum, const std::type_identity_t<soa4<const T>>& spheres, std::span<std::uint32_t> visible,
+                             execution::policy policy = execution::par)
+    {
+        std::size_t item_bytes = 4 * sizeof(T) + sizeof(std::uint32_t);
+        return detail::cull_batch(spheres.count, item_bytes, policy, visible.data(), [&](std::size_t begin, std::size_t end, std::uint32_t* out) {
+            std::size_t count = 0;
+            detail::range_blocks<T>(begin, end, [&]<typename P>(std::size_t i) {
+                P x = P::load(spheres.x + i), y = P::load(spheres.y + i), z = P::load(spheres.z + i);
+                P neg_radius = -P::load(spheres.w + i);
+
+                typename P::mask_type inside = P::broadcast(1) > P::broadcast(0);
+                for (const vec4<T>& plane : frustum.planes)
+                {
+                    P d = P::broadcast(plane.x) * x + P::broadcast(plane.y) * y + P::broadcast(plane.z) * z + P::broadcast(plane.w);
+                    inside = inside & (d >= neg_radius);
+                }
+
+                count += detail::append_indices(bits(inside), i, out + count);
+            });
+            return count;
+        });
+    }
+
+    // Axis aligned boxes given by their min and max corners
+    template<typename T>
+    std::size_t cull_aabbs(const frustum<T>& frustum, const std::type_identity_t<soa3<const T>>& min, const std::type_identity_t<soa3<const T>>& max,
+                           std::span<std::uint32_t> visible, execution::policy policy = execution::par)
+    {
+        std::size_t item_bytes = 6 * sizeof(T) + sizeof(std::uint32_t);
+        return detail::cull_batch(min.count, item_bytes, policy, visible.data(), [&](std::size_t begin, std::size_t end, std::uint32_t* out) {
+            std::size_t count = 0;
+            detail::range_blocks<T>(begin, end, [&]<typename P>(std::size_t i) {
+                P half = P::broadcast(static_cast<T>(0.5));
+                P min_x = P::load(min.x + i), min_y = P::load(min.y + i), min_z = P::load(min.z + i);
+                P max_x = P::load(max.x + i), max_y = P::load(max.y + i), max_z = P::load(max.z + i);
+                P cx = (min_x + max_x) * half, cy = (min_y + max_y) * half, cz = (min_z + max_z) * half;
+                P ex = (max_x - min_x) * half, ey = (max_y - min_y) * half, ez = (max_z - min_z) * half;
+
+                typename P::mask_type inside = P::broadcast(1) > P::broadcast(0);
+                for (const vec4<T>& plane : frustum.planes)
+                {
+                    P d = P::broadcast(plane.x) * cx + P::broadcast(plane.y) * cy + P::broadcast(plane.z) * cz + P::broadcast(plane.w);
+                    P r = abs(P::broadcast(plane.x)) * ex + abs(P::broadcast(plane.y)) * ey + abs(P::broadcast(plane.z)) * ez;
+                    inside = inside & (d >= -r);
+                }
+
+                count += detail::append_indices(bits(inside), i, out + count);
+            });
+            return count;
+        });
+    }
+
+}
+
+#endif // GEM_FRUSTUM_HPP
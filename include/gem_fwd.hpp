@@ -0,0 +1,33 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_FWD_HPP
+#define GEM_FWD_HPP
+
+// Forward declarations of the gem types
+// Headers that only pass gem types around by reference or pointer can include this instead of
+// gem_math.hpp, which keeps <cmath> and the template definitions out of their translation units
+namespace gem {
+
+    template<typename T> struct vec2;
+    template<typename T> struct vec3;
+    template<typename T> struct vec4;
+
+    template<typename T> struct mat4;
+    template<typename T> struct affine3;
+
+    template<typename T> struct quaternion;
+
+    struct circle;
+    struct sphere;
+    struct aabb;
+    struct obb;
+    struct plane;
+    struct capsule;
+    struct triangle;
+    struct ray;
+
+}
+
+#endif // GEM_FWD_HPP
@@ -0,0 +1,330 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_GRID_HPP
+#define GEM_GRID_HPP
+
+#include "gem_math.hpp"
+#include "gem_parallel.hpp"
+
+// std
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Hashed uniform grid for broadphase over points
+// Cells are cubes (squares in 2D) of a fixed size, hashed into a table of buckets. Building is a
+// counting sort of the points by bucket, so there is no per cell allocation, and points of a
+// bucket sit next to each other in memory for the queries
+namespace gem {
+
+    template<typename T, int32 dimensions>
+    class spatial_grid
+    {
+        static_assert(dimensions == 2 || dimensions == 3);
+
+    public:
+        using vec_type = std::conditional_t<dimensions == 2, vec2<T>, vec3<T>>;
+
+        explicit spatial_grid(T cell_size)
+            : m_cell_size(cell_size), m_inverse_cell_size(1 / cell_size)
+        {
+        }
+
+        // Replaces the content with points, point i keeps index i. Large builds are split over the job system
+        // (gem_parallel.hpp), later rebuilds triggered by updates use the same policy
+        void build(std::span<const vec_type> points, execution::policy policy = execution::par)
+        {
+            m_points.assign(points.begin(), points.end());
+            m_threads = detail::thread_budget(policy);
+            rebuild();
+        }
+
+        // Moves one point. Points that stay in their cell are updated in place, points that change cell go
+        // to a short overflow list scanned by every query, the grid is rebuilt once that list grows too long
+        void update(std::uint32_t point, const vec_type& position)
+        {
+            move(point, position);
+            if (m_moved.size() > max_moved())
+                rebuild();
+        }
+
+        // Moves every point, positions[i] is the new position of point i
+        // Rebuilds at most once, as soon as too many points changed cell
+        void update(std::span<const vec_type> positions)
+        {
+            for (std::uint32_t i = 0; i < positions.size(); i++)
+            {
+                if (m_moved.size() > max_moved())
+                {
+                    std::copy(positions.begin() + i, positions.end(), m_points.begin() + i);
+                    rebuild();
+                    return;
+                }
+                move(i, positions[i]);
+            }
+            if (m_moved.size() > max_moved())
+                rebuild();
+        }
+
+        // Calls fn(index) for every point p with distance_squared(p, center) <= radius * radius,
+        // the same test as point_in_circle and point_in_sphere
+        template<typename Fn>
+        void query(const vec_type& center, T radius, Fn&& fn) const
+        {
+            if (m_points.empty())
+                return;
+
+            T radius_squared = radius * radius;
+            cell lo = cell_of(center - vec_type(radius));
+            cell hi = cell_of(center + vec_type(radius));
+
+            cell c = lo;
+            while (true)
+            {
+                std::uint32_t bucket = bucket_of(c);
+                for (std::uint32_t slot = m_bucket_start[bucket]; slot < m_bucket_start[bucket + 1]; slot++)
+                {
+                    // Buckets are shared by every cell hashing to them, only take the points of this cell
+                    const vec_type& p = m_sorted_points[slot];
+                    if (m_sorted_indices[slot] != invalid && distance_squared(p, center) <= radius_squared && cell_of(p) == c)
+                        fn(m_sorted_indices[slot]);
+                }
+
+                // Next cell of the [lo, hi] range, x fastest
+                int32 axis = 0;
+                for (; axis < dimensions; axis++)
+                {
+                    if (c[axis] < hi[axis])
+                    {
+                        c[axis]++;
+                        break;
+                    }
+                    c[axis] = lo[axis];
+                }
+                if (axis == dimensions)
+                    break;
+            }
+
+            for (std::uint32_t point : m_moved)
+            {
+                if (distance_squared(m_points[point], center) <= radius_squared)
+                    fn(point);
+            }
+        }
+
+        std::size_t size() const { return m_points.size(); }
+        T cell_size() const { return m_cell_size; }
+        std::span<const vec_type> points() const { return m_points; }
+
+    private:
+        struct cell
+        {
+            int32 coordinates[dimensions];
+
+            int32& operator[](int32 axis) { return coordinates[axis]; }
+            int32 operator[](int32 axis) const { return coordinates[axis]; }
+
+            friend bool operator==(const cell& a, const cell& b)
+            {
+                for (int32 axis = 0; axis < dimensions; axis++)
+                {
+                    if (a.coordinates[axis] != b.coordinates[axis])
+                        return false;
+                }
+                return true;
+            }
+        };
+
+        static constexpr std::uint32_t invalid = std::numeric_limits<std::uint32_t>::max();
+        static constexpr std::uint32_t moved = invalid;
+        // Below this many points the build runs on the calling thread
+        static constexpr std::size_t parallel_threshold = 1 << 16;
+        // Bucket ranges of a parallel build, the per chunk histograms have this many entries
+        static constexpr std::uint32_t bucket_ranges = 1024;
+
+        // Past this many points in the overflow list a rebuild is cheaper than scanning it on every query
+        std::size_t max_moved() const { return 256 + m_points.size() / 1024; }
+
+        void move(std::uint32_t point, const vec_type& position)
+        {
+            m_points[point] = position;
+
+            std::uint32_t slot = m_slots[point];
+            if (slot == moved)
+                return;
+
+            if (cell_of(m_sorted_points[slot]) == cell_of(position))
+            {
+                m_sorted_points[slot] = position;
+            }
+            else
+            {
+                m_sorted_indices[slot] = invalid;
+                m_slots[point] = moved;
+                m_moved.push_back(point);
+            }
+        }
+
+        cell cell_of(const vec_type& p) const
+        {
+            cell c;
+            const T* components = &p.x;
+            for (int32 axis = 0; axis < dimensions; axis++)
+                c[axis] = static_cast<int32>(std::floor(components[axis] * m_inverse_cell_size));
+            return c;
+        }
+
+        std::uint32_t bucket_of(const cell& c) const
+        {
+            constexpr std::uint32_t primes[3] = { 73856093u, 19349663u, 83492791u };
+            std::uint32_t hash = 0;
+            for (int32 axis = 0; axis < dimensions; axis++)
+                hash ^= static_cast<std::uint32_t>(c[axis]) * primes[axis];
+            return hash & (m_bucket_count - 1);
+        }
+
+        // Counting sort of m_points by bucket, the order inside a bucket is the point order whatever the thread count
+        // Large builds sort in two passes so no thread keeps a histogram of every bucket: chunks of points are hashed and
+        // scattered by bucket range (the top bits of the bucket) in parallel, then every range is sorted by bucket on its own
+        void rebuild()
+        {
+            std::size_t count = m_points.size();
+            m_bucket_count = std::bit_ceil(std::max<std::uint32_t>(1, static_cast<std::uint32_t>(count)));
+            m_moved.clear();
+
+            m_bucket_start.resize(m_bucket_count + 1);
+            m_bucket_start[m_bucket_count] = static_cast<std::uint32_t>(count);
+            m_sorted_points.resize(count);
+            m_sorted_indices.resize(count);
+            m_slots.resize(count);
+            std::vector<std::uint32_t> buckets(count);
+
+            if (count < parallel_threshold || m_threads <= 1)
+            {
+                for (std::size_t i = 0; i < count; i++)
+                    buckets[i] = bucket_of(cell_of(m_points[i]));
+                sort_buckets(buckets, 0, m_bucket_count, 0, count, [](std::size_t k) { return static_cast<std::uint32_t>(k); });
+                return;
+            }
+
+            std::uint32_t ranges = std::min(m_bucket_count, bucket_ranges);
+            int32 shift = std::countr_zero(m_bucket_count) - std::countr_zero(ranges);
+            std::size_t chunks = m_threads;
+            std::size_t chunk_size = (count + chunks - 1) / chunks;
+
+            std::vector<std::uint32_t> offsets(chunks * ranges, 0);
+            for_each_chunk(chunks, [&](std::size_t chunk) {
+                std::uint32_t* histogram = offsets.data() + chunk * ranges;
+                std::size_t end = std::min(count, (chunk + 1) * chunk_size);
+                for (std::size_t i = chunk * chunk_size; i < end; i++)
+                {
+                    buckets[i] = bucket_of(cell_of(m_points[i]));
+                    histogram[buckets[i] >> shift]++;
+                }
+            });
+
+            // Exclusive prefix sum over (range, chunk), turns the histograms into scatter offsets
+            std::vector<std::uint32_t> range_start(ranges + 1);
+            std::uint32_t total = 0;
+            for (std::uint32_t range = 0; range < ranges; range++)
+            {
+                range_start[range] = total;
+                for (std::size_t chunk = 0; chunk < chunks; chunk++)
+                {
+                    std::uint32_t& offset = offsets[chunk * ranges + range];
+                    std::uint32_t n = offset;
+                    offset = total;
+                    total += n;
+                }
+            }
+            range_start[ranges] = total;
+
+            // Point indices grouped by range, in point order inside a range
+            std::vector<std::uint32_t> order(count);
+            for_each_chunk(chunks, [&](std::size_t chunk) {
+                std::uint32_t* offset = offsets.data() + chunk * ranges;
+                std::size_t end = std::min(count, (chunk + 1) * chunk_size);
+                for (std::size_t i = chunk * chunk_size; i < end; i++)
+                    order[offset[buckets[i] >> shift]++] = static_cast<std::uint32_t>(i);
+            });
+
+            for_each_chunk(ranges, [&](std::size_t range) {
+                const std::uint32_t* indices = order.data() + range_start[range];
+                sort_buckets(buckets, static_cast<std::uint32_t>(range << shift), static_cast<std::uint32_t>((range + 1) << shift), range_start[range],
+                             range_start[range + 1] - range_start[range], [&](std::size_t k) { return indices[k]; });
+            });
+        }
+
+        // Counting sort of the n points index_of(0), ..., index_of(n - 1), every one in a bucket of [first, last), into the
+        // slots from slot_begin on. Only touches m_bucket_start[first, last)
+        template<typename IndexOf>
+        void sort_buckets(const std::vector<std::uint32_t>& buckets, std::uint32_t first, std::uint32_t last, std::uint32_t slot_begin, std::size_t n,
+                          IndexOf&& index_of)
+        {
+            std::uint32_t* start = m_bucket_start.data();
+            std::fill(start + first, start + last, 0u);
+            for (std::size_t k = 0; k < n; k++)
+                start[buckets[index_of(k)]]++;
+
+            std::uint32_t total = slot_begin;
+            for (std::uint32_t bucket = first; bucket < last; bucket++)
+            {
+                std::uint32_t count = start[bucket];
+                start[bucket] = total;
+                total += count;
+            }
+
+            // Every start moves to the end of its bucket, which is where the next one begins
+            for (std::size_t k = 0; k < n; k++)
+            {
+                std::uint32_t i = index_of(k);
+                std::uint32_t slot = start[buckets[i]]++;
+                m_sorted_points[slot] = m_points[i];
+                m_sorted_indices[slot] = i;
+                m_slots[i] = slot;
+            }
+            for (std::uint32_t bucket = last - 1; bucket > first; bucket--)
+                start[bucket] = start[bucket - 1];
+            start[first] = slot_begin;
+        }
+
+        // fn(chunk) for every chunk over the job system participants
+        template<typename Fn>
+        void for_each_chunk(std::size_t chunks, Fn&& fn) const
+        {
+            parallel_for(chunks, 1, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t chunk = begin; chunk < end; chunk++)
+                    fn(chunk);
+            }, execution::parallel_policy{ m_threads });
+        }
+
+        T m_cell_size;
+        T m_inverse_cell_size;
+        std::uint32_t m_bucket_count = 1;
+        std::uint32_t m_threads = 1;
+
+        std::vector<vec_type> m_points;               // current position of every point, by index
+        std::vector<std::uint32_t> m_bucket_start;    // first slot of every bucket, plus the total
+        std::vector<vec_type> m_sorted_points;        // positions in bucket order
+        std::vector<std::uint32_t> m_sorted_indices;  // point index of every slot, invalid once the point moved out
+        std::vector<std::uint32_t> m_slots;           // slot of every point, moved when it is in m_moved
+        std::vector<std::uint32_t> m_moved;           // points that changed cell since the last build
+    };
+
+    template<typename T>
+    using grid2 = spatial_grid<T, 2>;
+
+    template<typename T>
+    using grid3 = spatial_grid<T, 3>;
+
+}
+
+#endif // GEM_GRID_HPP
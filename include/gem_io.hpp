@@ -0,0 +1,318 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_IO_HPP
+#define GEM_IO_HPP
+
+#include "gem_math.hpp"
+
+// std
+#include <charconv>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <version>
+
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
+// Text output for the gem types, kept out of gem_math.hpp so math only translation units
+// don't pay for <format>, <string> and <ostream>
+// Vectors and quaternions are written as "(x, y, z)", matrices as one vector per line
+namespace gem {
+
+    namespace detail {
+
+        // Writes "(v0, v1, ...)" without allocating, values use the shortest round trip representation
+        template<typename T>
+        std::to_chars_result write_components(char* first, char* last, const T* values, int32 count)
+        {
+            if (first == last)
+                return { last, std::errc::value_too_large };
+            *first++ = '(';
+
+            for (int32 i = 0; i < count; i++)
+            {
+                if (i > 0)
+                {
+                    if (last - first < 2)
+                        return { last, std::errc::value_too_large };
+                    *first++ = ',';
+                    *first++ = ' ';
+                }
+
+                std::to_chars_result result = std::to_chars(first, last, values[i]);
+                if (result.ec != std::errc())
+                    return result;
+                first = result.ptr;
+            }
+
+            if (first == last)
+                return { last, std::errc::value_too_large };
+            *first++ = ')';
+
+            return { first, std::errc() };
+        }
+
+        // Rows of a matrix separated by new lines
+        template<typename T>
+        std::to_chars_result write_rows(char* first, char* last, const vec4<T>* rows, int32 count)
+        {
+            for (int32 i = 0; i < count; i++)
+            {
+                if (i > 0)
+                {
+                    if (first == last)
+                        return { last, std::errc::value_too_large };
+                    *first++ = '\n';
+                }
+
+                std::to_chars_result result = write_components(first, last, &rows[i].x, 4);
+                if (result.ec != std::errc())
+                    return result;
+                first = result.ptr;
+            }
+
+            return { first, std::errc() };
+        }
+
+        // Large enough for a mat4<double>
+        inline constexpr int32 text_buffer_size = 512;
+
+        template<typename Value>
+        std::string to_string(const Value& value)
+        {
+            char buffer[text_buffer_size];
+            std::to_chars_result result = to_chars(buffer, buffer + text_buffer_size, value);
+            return std::string(buffer, result.ptr);
+        }
+
+        template<typename Value>
+        std::ostream& write(std::ostream& os, const Value& value)
+        {
+            char buffer[text_buffer_size];
+            std::to_chars_result result = to_chars(buffer, buffer + text_buffer_size, value);
+            return os.write(buffer, result.ptr - buffer);
+        }
+
+    }
+
+    // Allocation free serialisation, same contract as std::to_chars
+    template<typename T>
+    std::to_chars_result to_chars(char* first, char* last, const vec2<T>& vec)
+    {
+        return detail::write_components(first, last, &vec.x, 2);
+    }
+
+    template<typename T>
+    std::to_chars_result to_chars(char* first, char* last, const vec3<T>& vec)
+    {
+        return detail::write_components(first, last, &vec.x, 3);
+    }
+
+    template<typename T>
+    std::to_chars_result to_chars(char* first, char* last, const vec4<T>& vec)
+    {
+        return detail::write_components(first, last, &vec.x, 4);
+    }
+
+    template<typename T>
+    std::to_chars_result to_chars(char* first, char* last, const quaternion<T>& quat)
+    {
+        return detail::write_components(first, last, &quat.x, 4);
+    }
+
+    template<typename T>
+    std::to_chars_result to_chars(char* first, char* last, const mat4<T>& mat)
+    {
+        return detail::write_rows(first, last, mat.columns, 4);
+    }
+
+    template<typename T>
+    std::to_chars_result to_chars(char* first, char* last, const affine3<T>& mat)
+    {
+        return detail::write_rows(first, last, mat.columns, 3);
+    }
+
+    // Strings
+    template<typename T>
+    std::string to_string(const vec2<T>& vec)
+    {
+        return detail::to_string(vec);
+    }
+
+    template<typename T>
+    std::string to_string(const vec3<T>& vec)
+    {
+        return detail::to_string(vec);
+    }
+
+    template<typename T>
+    std::string to_string(const vec4<T>& vec)
+    {
+        return detail::to_string(vec);
+    }
+
+    template<typename T>
+    std::string to_string(const quaternion<T>& quat)
+    {
+        return detail::to_string(quat);
+    }
+
+    template<typename T>
+    std::string to_string(const mat4<T>& mat)
+    {
+        return detail::to_string(mat);
+    }
+
+    template<typename T>
+    std::string to_string(const affine3<T>& mat)
+    {
+        return detail::to_string(mat);
+    }
+
+    // Streams
+    template<typename T>
+    std::ostream& operator<<(std::ostream& os, const vec2<T>& vec)
+    {
+        return detail::write(os, vec);
+    }
+
+    template<typename T>
+    std::ostream& operator<<(std::ostream& os, const vec3<T>& vec)
+    {
+        return detail::write(os, vec);
+    }
+
+    template<typename T>
+    std::ostream& operator<<(std::ostream& os, const vec4<T>& vec)
+    {
+        return detail::write(os, vec);
+    }
+
+    template<typename T>
+    std::ostream& operator<<(std::ostream& os, const quaternion<T>& quat)
+    {
+        return detail::write(os, quat);
+    }
+
+    template<typename T>
+    std::ostream& operator<<(std::ostream& os, const mat4<T>& mat)
+    {
+        return detail::write(os, mat);
+    }
+
+    template<typename T>
+    std::ostream& operator<<(std::ostream& os, const affine3<T>& mat)
+    {
+        return detail::write(os, mat);
+    }
+
+}
+
+#if defined(__cpp_lib_format)
+// std::format support, the format spec applies to every component: std::format("{:.2f}", vec)
+// Components are formatted straight into the output iterator, no temporary strings
+namespace gem::detail {
+
+    template<typename T, typename CharT, typename Context>
+    typename Context::iterator format_components(const std::formatter<T, CharT>& element, const T* values, int32 count, Context& ctx)
+    {
+        auto out = ctx.out();
+        *out++ = CharT('(');
+        for (int32 i = 0; i < count; i++)
+        {
+            if (i > 0)
+            {
+                *out++ = CharT(',');
+                *out++ = CharT(' ');
+            }
+            ctx.advance_to(out);
+            out = element.format(values[i], ctx);
+        }
+        *out++ = CharT(')');
+        return out;
+    }
+
+    template<typename T, typename CharT, typename Context>
+    typename Context::iterator format_rows(const std::formatter<T, CharT>& element, const gem::vec4<T>* rows, int32 count, Context& ctx)
+    {
+        auto out = ctx.out();
+        for (int32 i = 0; i < count; i++)
+        {
+            if (i > 0)
+            {
+                *out++ = CharT('\n');
+                ctx.advance_to(out);
+            }
+            out = format_components(element, &rows[i].x, 4, ctx);
+        }
+        return out;
+    }
+
+}
+
+template<typename T, typename CharT>
+struct std::formatter<gem::vec2<T>, CharT> : std::formatter<T, CharT>
+{
+    template<typename Context>
+    auto format(const gem::vec2<T>& vec, Context& ctx) const
+    {
+        return gem::detail::format_components<T, CharT>(*this, &vec.x, 2, ctx);
+    }
+};
+
+template<typename T, typename CharT>
+struct std::formatter<gem::vec3<T>, CharT> : std::formatter<T, CharT>
+{
+    template<typename Context>
+    auto format(const gem::vec3<T>& vec, Context& ctx) const
+    {
+        return gem::detail::format_components<T, CharT>(*this, &vec.x, 3, ctx);
+    }
+};
+
+template<typename T, typename CharT>
+struct std::formatter<gem::vec4<T>, CharT> : std::formatter<T, CharT>
+{
+    template<typename Context>
+    auto format(const gem::vec4<T>& vec, Context& ctx) const
+    {
+        return gem::detail::format_components<T, CharT>(*this, &vec.x, 4, ctx);
+    }
+};
+
+template<typename T, typename CharT>
+struct std::formatter<gem::quaternion<T>, CharT> : std::formatter<T, CharT>
+{
+    template<typename Context>
+    auto format(const gem::quaternion<T>& quat, Context& ctx) const
+    {
+        return gem::detail::format_components<T, CharT>(*this, &quat.x, 4, ctx);
+    }
+};
+
+template<typename T, typename CharT>
+struct std::formatter<gem::mat4<T>, CharT> : std::formatter<T, CharT>
+{
+    template<typename Context>
+    auto format(const gem::mat4<T>& mat, Context& ctx) const
+    {
+        return gem::detail::format_rows<T, CharT>(*this, mat.columns, 4, ctx);
+    }
+};
+
+template<typename T, typename CharT>
+struct std::formatter<gem::affine3<T>, CharT> : std::formatter<T, CharT>
+{
+    template<typename Context>
+    auto format(const gem::affine3<T>& mat, Context& ctx) const
+    {
+        return gem::detail::format_rows<T, CharT>(*this, mat.columns, 3, ctx);
+    }
+};
+#endif
+
+#endif // GEM_IO_HPP
@@ -6,13 +6,18 @@
 #define GEM_MATH_HPP
 
 #include "gem_base.hpp"
+#include "gem_fwd.hpp"
+#include "gem_simd.hpp"
+#include "gem_fast.hpp"
 
 // std
+#include <bit>
 #include <cmath>
-#include <string>
-#include <sstream>
-#include <ostream>
-#include <format> // c++20
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <type_traits>
 
 #define GEM_DEBUG 0
 
@@ -27,72 +32,222 @@
 
 // Basic conversions
 // Angles
-#define GEM_DEG_TO_RAD 0.017453229252
-#define GEM_RAD_TO_DEG 57.29577951
+#define GEM_DEG_TO_RAD 0.017453292519943
+#define GEM_RAD_TO_DEG 57.295779513082
 
 #define GEM_MILI(x) (x * 1000)
 
 namespace gem {
     // snake_case for every name
-/*
-    // TODO: Review this, not all types should be precision_type 
+
+    // Scalar of the non template helpers, define GEM_DOUBLE for double
+    // Every template computes in its own T, vec3<double> is double precision whatever precision_type is
 #ifdef GEM_DOUBLE
     using precision_type = double;
 #else
     using precision_type = float;
 #endif
-*/
-    // Temporary, no double supported, always using floats, for now
-    using precision_type = float;
+
+    // Constant evaluation friendly math
+    // sqrt, sin, cos and tan use the std:: functions at run time and the fallbacks below
+    // during constant evaluation, so every constexpr builder works in both contexts
+    namespace detail {
+        inline constexpr double constexpr_pi = 3.14159265358979323846;
+
+        // Newton iteration from above, stops once the estimate no longer decreases
+        constexpr double constexpr_sqrt(double x)
+        {
+            if (x != x || x < 0.0)
+                return std::numeric_limits<double>::quiet_NaN();
+            if (x == 0.0 || x == std::numeric_limits<double>::infinity())
+                return x;
+
+            double current = x > 1.0 ? x : 1.0;
+            while (true)
+            {
+                double next = 0.5 * (current + x / current);
+                if (next >= current)
+                    return current;
+                current = next;
+            }
+        }
+
+        // Reduces x to [-pi, pi], NaN for non finite input
+        constexpr double constexpr_reduce_angle(double x)
+        {
+            double turns = x / (2.0 * constexpr_pi);
+            long long n = static_cast<long long>(turns + (turns >= 0.0 ? 0.5 : -0.5));
+            return x - static_cast<double>(n) * (2.0 * constexpr_pi);
+        }
+
+        // Taylor series, accurate to double precision after range reduction
+        constexpr double constexpr_sin(double x)
+        {
+            if (x - x != 0.0)
+                return std::numeric_limits<double>::quiet_NaN();
+
+            x = constexpr_reduce_angle(x);
+            double term = x;
+            double sum = x;
+            for (int32 i = 1; i < 20; i++)
+            {
+                term *= -x * x / static_cast<double>((2 * i) * (2 * i + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr double constexpr_cos(double x)
+        {
+            if (x - x != 0.0)
+                return std::numeric_limits<double>::quiet_NaN();
+
+            x = constexpr_reduce_angle(x);
+            double term = 1.0;
+            double sum = 1.0;
+            for (int32 i = 1; i < 20; i++)
+            {
+                term *= -x * x / static_cast<double>((2 * i - 1) * (2 * i));
+                sum += term;
+            }
+            return sum;
+        }
+    }
+
+    template<std::floating_point T>
+    constexpr T sqrt(T x)
+    {
+        if (std::is_constant_evaluated())
+            return static_cast<T>(detail::constexpr_sqrt(static_cast<double>(x)));
+        return std::sqrt(x);
+    }
+
+    template<std::integral T>
+    constexpr double sqrt(T x)
+    {
+        return sqrt(static_cast<double>(x));
+    }
+
+    template<std::floating_point T>
+    constexpr T sin(T x)
+    {
+        if (std::is_constant_evaluated())
+            return static_cast<T>(detail::constexpr_sin(static_cast<double>(x)));
+        return std::sin(x);
+    }
+
+    template<std::floating_point T>
+    constexpr T cos(T x)
+    {
+        if (std::is_constant_evaluated())
+            return static_cast<T>(detail::constexpr_cos(static_cast<double>(x)));
+        return std::cos(x);
+    }
+
+    template<std::floating_point T>
+    constexpr T tan(T x)
+    {
+        if (std::is_constant_evaluated())
+            return static_cast<T>(detail::constexpr_sin(static_cast<double>(x)) / detail::constexpr_cos(static_cast<double>(x)));
+        return std::tan(x);
+    }
 
     // General functions
     template<typename T>
-    T pi()
+    constexpr T pi()
     {
         return static_cast<T>(GEM_PI);
     }
 
-    // TODO: once all vecotrs and matrices are changed with templates, review precision_type here
-    precision_type to_radians(precision_type degrees)
+    // Floating point arguments keep their type, anything else (integers, mixed types) goes through precision_type
+    template<std::floating_point T>
+    constexpr T to_radians(T degrees)
+    {
+        return degrees * static_cast<T>(GEM_DEG_TO_RAD);
+    }
+
+    constexpr precision_type to_radians(precision_type degrees)
+    {
+        return to_radians<precision_type>(degrees);
+    }
+
+    template<std::floating_point T>
+    constexpr T to_degrees(T radians)
     {
-        return degrees * GEM_DEG_TO_RAD;
+        return radians * static_cast<T>(GEM_RAD_TO_DEG);
     }
 
-    precision_type to_degrees(precision_type radians)
+    constexpr precision_type to_degrees(precision_type radians)
     {
-        return radians * GEM_RAD_TO_DEG;
+        return to_degrees<precision_type>(radians);
     }
 
-    float inverse(float val)
+    template<std::floating_point T>
+    constexpr T inverse(T val)
     {
         return 1 / val;
     }
 
-    precision_type max(precision_type a, precision_type b)
+    constexpr precision_type inverse(precision_type val)
+    {
+        return 1 / val;
+    }
+
+    template<std::floating_point T>
+    constexpr T max(T a, T b)
     {
         return a > b ? a : b;
     }
 
-    precision_type max(precision_type a, precision_type b, precision_type c)
+    template<std::floating_point T>
+    constexpr T max(T a, T b, T c)
     {
         return max(max(a, b), c);
     }
 
-    precision_type min(precision_type a, precision_type b)
+    template<std::floating_point T>
+    constexpr T min(T a, T b)
     {
         return a < b ? a : b;
     }
 
-    precision_type min(precision_type a, precision_type b, precision_type c)
+    template<std::floating_point T>
+    constexpr T min(T a, T b, T c)
     {
         return min(min(a, b), c);
     }
 
-    precision_type clamp(precision_type val, precision_type min_val, precision_type max_val)
+    template<std::floating_point T>
+    constexpr T clamp(T val, T min_val, T max_val)
     {
         return min(max(val, min_val), max_val);
     }
 
+    constexpr precision_type max(precision_type a, precision_type b)
+    {
+        return max<precision_type>(a, b);
+    }
+
+    constexpr precision_type max(precision_type a, precision_type b, precision_type c)
+    {
+        return max<precision_type>(a, b, c);
+    }
+
+    constexpr precision_type min(precision_type a, precision_type b)
+    {
+        return min<precision_type>(a, b);
+    }
+
+    constexpr precision_type min(precision_type a, precision_type b, precision_type c)
+    {
+        return min<precision_type>(a, b, c);
+    }
+
+    constexpr precision_type clamp(precision_type val, precision_type min_val, precision_type max_val)
+    {
+        return clamp<precision_type>(val, min_val, max_val);
+    }
+
     // Vectors
     // vec2
     // Two-component vector
@@ -110,45 +265,45 @@ namespace gem {
         };
         
         // Constructors
-        vec2() : x(T{}), y(T{})
+        constexpr vec2() : x(T{}), y(T{})
         {
         }
 
-        vec2(T x, T y)
+        constexpr vec2(T x, T y)
         {
             this->x = x;
             this->y = y;
         }
 
-        vec2(T scalar)
+        constexpr vec2(T scalar)
         {
             x = scalar;
             y = scalar;
         }
 
         // Operations
-        vec2<T>& add(const vec2<T>& other)
+        constexpr vec2<T>& add(const vec2<T>& other)
         {
             this->x += other.x;
             this->y += other.y;
             return *this;
         }
 
-        vec2<T>& substract(const vec2<T>& other)
+        constexpr vec2<T>& substract(const vec2<T>& other)
         {
             this->x -= other.x;
             this->y -= other.y;
             return *this;
         }
 
-        vec2<T>& multiply(const vec2<T>& other)
+        constexpr vec2<T>& multiply(const vec2<T>& other)
         {
             this->x *= other.x;
             this->y *= other.y;
             return *this;
         }
 
-        vec2<T>& divide(const vec2<T>& other)
+        constexpr vec2<T>& divide(const vec2<T>& other)
         {
             this->x /= other.x;
             this->y /= other.y;
@@ -156,45 +311,45 @@ namespace gem {
         }
 
         // Operations with scalars
-        vec2<T>& add(T scalar)
+        constexpr vec2<T>& add(T scalar)
         {
             this->x += scalar;
             this->y += scalar;
             return *this;
         }
 
-        vec2<T>& substract(T scalar)
+        constexpr vec2<T>& substract(T scalar)
         {
             this->x -= scalar;
             this->y -= scalar;
             return *this;
         }
 
-        vec2<T>& multiply(T scalar)
+        constexpr vec2<T>& multiply(T scalar)
         {
             this->x *= scalar;
             this->y *= scalar;
             return *this;
         }
 
-        vec2<T>& divide(T scalar)
+        constexpr vec2<T>& divide(T scalar)
         {
             this->x /= scalar;
             this->y /= scalar;
             return *this;
         }
 
-        float magnitude() const
+        constexpr T magnitude() const
         {
-            float mag = sqrt(this->x * this->x + this->y * this->y);
+            T mag = sqrt(this->x * this->x + this->y * this->y);
             return mag;
         }
 
-        vec2<T>& normalize()
+        constexpr vec2<T>& normalize()
         {
-            float mag = magnitude();
-            if (mag > 0.0f) {
-                precision_type inv_mag = inverse(mag);
+            T mag = magnitude();
+            if (mag > 0) {
+                T inv_mag = inverse(mag);
                 this->x *= inv_mag;
                 this->y *= inv_mag;
             }
@@ -202,7 +357,7 @@ namespace gem {
             return *this;
         }
 
-        vec2<T> normalized() const
+        constexpr vec2<T> normalized() const
         {
             vec2<T> vec(this->x, this->y);
             vec.normalize();
@@ -210,128 +365,118 @@ namespace gem {
             return vec;
         }
 
-        float dot(const vec2<T>& other) const
+        constexpr T dot(const vec2<T>& other) const
         {
-            float result = this->x * other.x + this->y * other.y;
+            T result = this->x * other.x + this->y * other.y;
             return result;
         }
 
-        vec2<T>* value_ptr()
+        constexpr vec2<T>* value_ptr()
         {
             return &(*this);
         }
 
         // Operators
-        friend vec2<T> operator+(vec2<T> left, const vec2<T>& right)
+        friend constexpr vec2<T> operator+(vec2<T> left, const vec2<T>& right)
         {
             return left.add(right);
         }
 
-        friend vec2<T> operator-(vec2<T> left, const vec2<T>& right)
+        friend constexpr vec2<T> operator-(vec2<T> left, const vec2<T>& right)
         {
             return left.substract(right);
         }
 
-        friend vec2<T> operator*(vec2<T> left, const vec2<T>& right)
+        friend constexpr vec2<T> operator*(vec2<T> left, const vec2<T>& right)
         {
             return left.multiply(right);
         }
 
-        friend vec2<T> operator/(vec2<T> left, const vec2<T>& right)
+        friend constexpr vec2<T> operator/(vec2<T> left, const vec2<T>& right)
         {
             return left.divide(right);
         }
 
         // Operators with scalars
-        friend vec2<T> operator+(vec2<T> left, T right)
+        friend constexpr vec2<T> operator+(vec2<T> left, T right)
         {
             return left.add(right);
         }
 
-        friend vec2<T> operator-(vec2<T> left, T right)
+        friend constexpr vec2<T> operator-(vec2<T> left, T right)
         {
             return left.substract(right);
         }
 
-        friend vec2<T> operator*(vec2<T> left, T right)
+        friend constexpr vec2<T> operator*(vec2<T> left, T right)
         {
             return left.multiply(right);
         }
 
-        friend vec2<T> operator/(vec2 left, T right)
+        friend constexpr vec2<T> operator/(vec2 left, T right)
         {
             return left.divide(right);
         }
 
-        vec2<T>& operator+=(const vec2<T>& other)
+        constexpr vec2<T>& operator+=(const vec2<T>& other)
         {
             this->add(other);
             return *this;
         }
 
-        vec2<T>& operator-=(const vec2<T>& other)
+        constexpr vec2<T>& operator-=(const vec2<T>& other)
         {
             this->substract(other);
             return *this;
         }
 
-        vec2<T>& operator*=(const vec2<T>& other)
+        constexpr vec2<T>& operator*=(const vec2<T>& other)
         {
             this->multiply(other);
             return *this;
         }
 
-        vec2<T>& operator/=(const vec2<T>& other)
+        constexpr vec2<T>& operator/=(const vec2<T>& other)
         {
             this->divide(other);
             return *this;
         }
 
         // Scalars
-        vec2<T>& operator+=(T scalar)
+        constexpr vec2<T>& operator+=(T scalar)
         {
             this->add(scalar);
             return *this;
         }
 
-        vec2<T>& operator-=(T scalar)
+        constexpr vec2<T>& operator-=(T scalar)
         {
             this->substract(scalar);
             return *this;
         }
 
-        vec2<T>& operator*=(T scalar)
+        constexpr vec2<T>& operator*=(T scalar)
         {
             this->multiply(scalar);
             return *this;
         }
 
-        vec2<T>& operator/=(T scalar)
+        constexpr vec2<T>& operator/=(T scalar)
         {
             this->divide(scalar);
             return *this;
         }
 
-        friend bool operator==(const vec2<T>& left, const vec2<T>& right)
+        friend constexpr bool operator==(const vec2<T>& left, const vec2<T>& right)
         {
             return left.x == right.x and left.y == right.y;
         }
 
-        friend bool operator!=(const vec2<T>& left, const vec2<T>& right)
+        friend constexpr bool operator!=(const vec2<T>& left, const vec2<T>& right)
         {
             return !(left.x == right.x and left.y == right.y);
         }
 
-        std::string to_string() const
-        {
-            return std::format("({}, {})", this->x, this->y);
-        }
-
-        friend std::ostream& operator<<(std::ostream& os, const vec2<T>& vec) {
-            os << vec.to_string();
-            return os;
-        }
-
     }; // vec2
 
     // vec3
@@ -363,18 +508,18 @@ namespace gem {
         };
 
         // Constructors
-        vec3() : x(T{}), y(T{}), z(T{})
+        constexpr vec3() : x(T{}), y(T{}), z(T{})
         {
         }
 
-        vec3(T scalar)
+        constexpr vec3(T scalar)
         {
             x = scalar;
             y = scalar;
             z = scalar;
         }
 
-        vec3(T x, T y, T z)
+        constexpr vec3(T x, T y, T z)
         {
             this->x = x;
             this->y = y;
@@ -382,7 +527,7 @@ namespace gem {
         }
 
         // Operations
-        vec3<T>& add(const vec3<T>& other)
+        constexpr vec3<T>& add(const vec3<T>& other)
         {
             this->x += other.x;
             this->y += other.y;
@@ -390,7 +535,7 @@ namespace gem {
             return *this;
         }
 
-        vec3<T>& substract(const vec3<T>& other)
+        constexpr vec3<T>& substract(const vec3<T>& other)
         {
             this->x -= other.x;
             this->y -= other.y;
@@ -398,7 +543,7 @@ namespace gem {
             return *this;
         }
 
-        vec3<T>& multiply(const vec3<T>& other)
+        constexpr vec3<T>& multiply(const vec3<T>& other)
         {
             this->x *= other.x;
             this->y *= other.y;
@@ -406,7 +551,7 @@ namespace gem {
             return *this;
         }
 
-        vec3<T>& divide(const vec3<T>& other)
+        constexpr vec3<T>& divide(const vec3<T>& other)
         {
             this->x /= other.x;
             this->y /= other.y;
@@ -415,7 +560,7 @@ namespace gem {
         }
 
         // Operations with scalars
-        vec3<T>& add(T scalar)
+        constexpr vec3<T>& add(T scalar)
         {
             this->x += scalar;
             this->y += scalar;
@@ -423,7 +568,7 @@ namespace gem {
             return *this;
         }
 
-        vec3<T>& substract(T scalar)
+        constexpr vec3<T>& substract(T scalar)
         {
             this->x -= scalar;
             this->y -= scalar;
@@ -431,7 +576,7 @@ namespace gem {
             return *this;
         }
 
-        vec3<T>& multiply(T scalar)
+        constexpr vec3<T>& multiply(T scalar)
         {
             this->x *= scalar;
             this->y *= scalar;
@@ -439,7 +584,7 @@ namespace gem {
             return *this;
         }
 
-        vec3<T>& divide(T scalar)
+        constexpr vec3<T>& divide(T scalar)
         {
             this->x /= scalar;
             this->y /= scalar;
@@ -447,17 +592,17 @@ namespace gem {
             return *this;
         }
 
-        float magnitude() const
+        constexpr T magnitude() const
         {
-            float mag = sqrt(this->x * this->x + this->y * this->y + this->z * this->z);
+            T mag = sqrt(this->x * this->x + this->y * this->y + this->z * this->z);
             return mag;
         }
 
-        vec3<T>& normalize()
+        constexpr vec3<T>& normalize()
         {
-            float mag = magnitude();
-            if (mag > 0.0f) {
-                float inv_mag = inverse(mag);
+            T mag = magnitude();
+            if (mag > 0) {
+                T inv_mag = inverse(mag);
                 this->x *= inv_mag;
                 this->y *= inv_mag;
                 this->z *= inv_mag;
@@ -466,7 +611,7 @@ namespace gem {
             return *this;
         }
 
-        vec3<T> normalized() const
+        constexpr vec3<T> normalized() const
         {
             vec3<T> vec(this->x, this->y, this->z);
             vec.normalize();
@@ -474,134 +619,133 @@ namespace gem {
             return vec;
         }
 
-        float dot(const vec3<T>& other) const
+        constexpr T dot(const vec3<T>& other) const
         {
-            float result = this->x * other.x + this->y * other.y + this->z * other.z;
+            T result = this->x * other.x + this->y * other.y + this->z * other.z;
             return result;
         }
 
-        vec3<T>* value_ptr()
+        constexpr vec3<T> cross(const vec3<T>& other) const
+        {
+            return vec3<T>(
+                this->y * other.z - this->z * other.y,
+                this->z * other.x - this->x * other.z,
+                this->x * other.y - this->y * other.x);
+        }
+
+        constexpr vec3<T>* value_ptr()
         {
             return &(*this);
         }
 
         // Operators
-        friend vec3<T> operator+(vec3<T> left, const vec3<T>& right)
+        friend constexpr vec3<T> operator+(vec3<T> left, const vec3<T>& right)
         {
             return left.add(right);
         }
 
-        friend vec3<T> operator-(vec3<T> left, const vec3<T>& right)
+        friend constexpr vec3<T> operator-(vec3<T> left, const vec3<T>& right)
         {
             return left.substract(right);
         }
 
-        friend vec3<T> operator*(vec3<T> left, const vec3<T>& right)
+        friend constexpr vec3<T> operator*(vec3<T> left, const vec3<T>& right)
         {
             return left.multiply(right);
         }
 
-        friend vec3<T> operator/(vec3<T> left, const vec3<T>& right)
+        friend constexpr vec3<T> operator/(vec3<T> left, const vec3<T>& right)
         {
             return left.divide(right);
         }
 
         // Operators with scalars
-        friend vec3<T> operator+(vec3<T> left, T right)
+        friend constexpr vec3<T> operator+(vec3<T> left, T right)
         {
             return left.add(right);
         }
 
-        friend vec3<T> operator-(vec3<T> left, T right)
+        friend constexpr vec3<T> operator-(vec3<T> left, T right)
         {
             return left.substract(right);
         }
 
-        friend vec3<T> operator*(vec3<T> left, T right)
+        friend constexpr vec3<T> operator*(vec3<T> left, T right)
         {
             return left.multiply(right);
         }
 
-        friend vec3<T> operator/(vec3<T> left, T right)
+        friend constexpr vec3<T> operator/(vec3<T> left, T right)
         {
             return left.divide(right);
         }
 
-        vec3<T>& operator+=(const vec3<T>& other)
+        constexpr vec3<T>& operator+=(const vec3<T>& other)
         {
             this->add(other);
             return *this;
         }
 
-        vec3<T>& operator-=(const vec3<T>& other)
+        constexpr vec3<T>& operator-=(const vec3<T>& other)
         {
             this->substract(other);
             return *this;
         }
 
-        vec3<T>& operator*=(const vec3<T>& other)
+        constexpr vec3<T>& operator*=(const vec3<T>& other)
         {
             this->multiply(other);
             return *this;
         }
 
-        vec3<T>& operator/=(const vec3<T>& other)
+        constexpr vec3<T>& operator/=(const vec3<T>& other)
         {
             this->divide(other);
             return *this;
         }
 
         // Scalars
-        vec3<T>& operator+=(T scalar)
+        constexpr vec3<T>& operator+=(T scalar)
         {
             this->add(scalar);
             return *this;
         }
 
-        vec3<T>& operator-=(T scalar)
+        constexpr vec3<T>& operator-=(T scalar)
         {
             this->substract(scalar);
             return *this;
         }
 
-        vec3<T>& operator*=(T scalar)
+        constexpr vec3<T>& operator*=(T scalar)
         {
             this->multiply(scalar);
             return *this;
         }
 
-        vec3<T>& operator/=(T scalar)
+        constexpr vec3<T>& operator/=(T scalar)
         {
             this->divide(scalar);
             return *this;
         }
 
-        friend bool operator==(const vec3<T>& left, const vec3<T>& right)
+        friend constexpr bool operator==(const vec3<T>& left, const vec3<T>& right)
         {
             return left.x == right.x and left.y == right.y && left.z == right.z;
         }
 
-        friend bool operator!=(const vec3<T>& left, const vec3<T>& right)
+        friend constexpr bool operator!=(const vec3<T>& left, const vec3<T>& right)
         {
             return !(left.x == right.x and left.y == right.y && left.z == right.z);
         }
 
-        std::string to_string() const
-        {
-            return std::format("({}, {}, {})", this->x, this->y, this->z);
-        }
-
-        friend std::ostream& operator<<(std::ostream& os, const vec3& vec) {
-            os << vec.to_string();
-            return os;
-        }
-
     }; // vec3
 
     // vec4
     // Four-component vector
+    // vec4<float> is 16-byte aligned and uses SSE kernels, define GEM_NO_SIMD for the scalar code
     template<typename T>
-    struct vec4
+    struct alignas(simd::alignment<T>) vec4
     {
         // Data
         union
@@ -623,11 +767,11 @@ namespace gem {
         };
         
         // Constructors
-        vec4() : x(T{}), y(T{}), z(T{}), w(T{})
+        constexpr vec4() : x(T{}), y(T{}), z(T{}), w(T{})
         {
         }
 
-        vec4(T scalar)
+        constexpr vec4(T scalar)
         {
             x = scalar;
             y = scalar;
@@ -635,7 +779,7 @@ namespace gem {
             w = scalar;
         }
 
-        vec4(T x, T y, T z, T w)
+        constexpr vec4(T x, T y, T z, T w)
         {
             this->x = x;
             this->y = y;
@@ -644,8 +788,18 @@ namespace gem {
         }
 
         // Operations
-        vec4<T>& add(const vec4<T>& other)
+        constexpr vec4<T>& add(const vec4<T>& other)
         {
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    _mm_store_ps(&this->x, _mm_add_ps(_mm_load_ps(&this->x), _mm_load_ps(&other.x)));
+                    return *this;
+                }
+            }
+#endif
             this->x += other.x;
             this->y += other.y;
             this->z += other.z;
@@ -653,8 +807,18 @@ namespace gem {
             return *this;
         }
 
-        vec4<T>& substract(const vec4<T>& other)
+        constexpr vec4<T>& substract(const vec4<T>& other)
         {
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    _mm_store_ps(&this->x, _mm_sub_ps(_mm_load_ps(&this->x), _mm_load_ps(&other.x)));
+                    return *this;
+                }
+            }
+#endif
             this->x -= other.x;
             this->y -= other.y;
             this->z -= other.z;
@@ -662,8 +826,18 @@ namespace gem {
             return *this;
         }
 
-        vec4<T>& multiply(const vec4<T>& other)
+        constexpr vec4<T>& multiply(const vec4<T>& other)
         {
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    _mm_store_ps(&this->x, _mm_mul_ps(_mm_load_ps(&this->x), _mm_load_ps(&other.x)));
+                    return *this;
+                }
+            }
+#endif
             this->x *= other.x;
             this->y *= other.y;
             this->z *= other.z;
@@ -671,8 +845,18 @@ namespace gem {
             return *this;
         }
 
-        vec4<T>& divide(const vec4<T>& other)
+        constexpr vec4<T>& divide(const vec4<T>& other)
         {
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    _mm_store_ps(&this->x, _mm_div_ps(_mm_load_ps(&this->x), _mm_load_ps(&other.x)));
+                    return *this;
+                }
+            }
+#endif
             this->x /= other.x;
             this->y /= other.y;
             this->z /= other.z;
@@ -681,8 +865,18 @@ namespace gem {
         }
 
         // Operations with scalars
-        vec4<T>& add(T scalar)
+        constexpr vec4<T>& add(T scalar)
         {
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    _mm_store_ps(&this->x, _mm_add_ps(_mm_load_ps(&this->x), _mm_set1_ps(scalar)));
+                    return *this;
+                }
+            }
+#endif
             this->x += scalar;
             this->y += scalar;
             this->z += scalar;
@@ -690,8 +884,18 @@ namespace gem {
             return *this;
         }
 
-        vec4<T>& substract(T scalar)
+        constexpr vec4<T>& substract(T scalar)
         {
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    _mm_store_ps(&this->x, _mm_sub_ps(_mm_load_ps(&this->x), _mm_set1_ps(scalar)));
+                    return *this;
+                }
+            }
+#endif
             this->x -= scalar;
             this->y -= scalar;
             this->z -= scalar;
@@ -699,8 +903,18 @@ namespace gem {
             return *this;
         }
 
-        vec4<T>& multiply(T scalar)
+        constexpr vec4<T>& multiply(T scalar)
         {
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    _mm_store_ps(&this->x, _mm_mul_ps(_mm_load_ps(&this->x), _mm_set1_ps(scalar)));
+                    return *this;
+                }
+            }
+#endif
             this->x *= scalar;
             this->y *= scalar;
             this->z *= scalar;
@@ -708,8 +922,18 @@ namespace gem {
             return *this;
         }
 
-        vec4<T>& divide(T scalar)
+        constexpr vec4<T>& divide(T scalar)
         {
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    _mm_store_ps(&this->x, _mm_div_ps(_mm_load_ps(&this->x), _mm_set1_ps(scalar)));
+                    return *this;
+                }
+            }
+#endif
             this->x /= scalar;
             this->y /= scalar;
             this->z /= scalar;
@@ -717,17 +941,27 @@ namespace gem {
             return *this;
         }
 
-        float magnitude() const
+        constexpr T magnitude() const
         {
-            float mag = sqrt(this->x * this->x + this->y * this->y + this->z * this->z + this->w * this->w);
+            T mag = sqrt(dot(*this));
             return mag;
         }
 
-        vec4<T>& normalize()
+        constexpr vec4<T>& normalize()
         {
-            float mag = magnitude();
-            if (mag > 0.0f) {
-                float inv_mag = inverse(mag);
+            T mag = magnitude();
+            if (mag > 0) {
+                T inv_mag = inverse(mag);
+#if defined(GEM_SSE)
+                if constexpr (simd::enabled<T>)
+                {
+                    if (!std::is_constant_evaluated())
+                    {
+                        _mm_store_ps(&this->x, _mm_mul_ps(_mm_load_ps(&this->x), _mm_set1_ps(inv_mag)));
+                        return *this;
+                    }
+                }
+#endif
                 this->x *= inv_mag;
                 this->y *= inv_mag;
                 this->z *= inv_mag;
@@ -737,7 +971,7 @@ namespace gem {
             return *this;
         }
 
-        vec4<T> normalized() const
+        constexpr vec4<T> normalized() const
         {
             vec4 vec(this->x, this->y, this->z, this->w);
             vec.normalize();
@@ -745,131 +979,137 @@ namespace gem {
             return vec;
         }
 
-        float dot(const vec4& other) const
+        constexpr T dot(const vec4& other) const
         {
-            float result = this->x * other.x + this->y * other.y + this->z * other.z + this->w * other.w;
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+                if (!std::is_constant_evaluated())
+                    return simd::horizontal_add(_mm_mul_ps(_mm_load_ps(&this->x), _mm_load_ps(&other.x)));
+#endif
+            T result = this->x * other.x + this->y * other.y + this->z * other.z + this->w * other.w;
             return result;
         }
 
-        vec4<T>* value_ptr()
+        constexpr vec4<T>* value_ptr()
         {
             return &(*this);
         }
 
         // Operators
-        friend vec4<T> operator+(vec4<T> left, const vec4<T>& right)
+        friend constexpr vec4<T> operator+(vec4<T> left, const vec4<T>& right)
         {
             return left.add(right);
         }
 
 
-        friend vec4<T> operator-(vec4<T> left, const vec4<T>& right)
+        friend constexpr vec4<T> operator-(vec4<T> left, const vec4<T>& right)
         {
             return left.substract(right);
         }
 
-        friend vec4<T> operator*(vec4<T> left, const vec4<T>& right)
+        friend constexpr vec4<T> operator*(vec4<T> left, const vec4<T>& right)
         {
             return left.multiply(right);
         }
 
-        friend vec4<T> operator/(vec4<T> left, const vec4<T>& right)
+        friend constexpr vec4<T> operator/(vec4<T> left, const vec4<T>& right)
         {
             return left.divide(right);
         }
 
         // Operators with scalars
-        friend vec4<T> operator+(vec4<T> left, T right)
+        friend constexpr vec4<T> operator+(vec4<T> left, T right)
         {
             return left.add(right);
         }
 
 
-        friend vec4<T> operator-(vec4<T> left, T right)
+        friend constexpr vec4<T> operator-(vec4<T> left, T right)
         {
             return left.substract(right);
         }
 
-        friend vec4<T> operator*(vec4<T> left, T right)
+        friend constexpr vec4<T> operator*(vec4<T> left, T right)
         {
             return left.multiply(right);
         }
 
-        friend vec4<T> operator/(vec4<T> left, T right)
+        friend constexpr vec4<T> operator/(vec4<T> left, T right)
         {
             return left.divide(right);
         }
 
-        vec4<T>& operator+=(const vec4<T>& other)
+        constexpr vec4<T>& operator+=(const vec4<T>& other)
         {
             this->add(other);
             return *this;
         }
 
-        vec4<T>& operator-=(const vec4<T>& other)
+        constexpr vec4<T>& operator-=(const vec4<T>& other)
         {
             this->substract(other);
             return *this;
         }
 
-        vec4<T>& operator*=(const vec4<T>& other)
+        constexpr vec4<T>& operator*=(const vec4<T>& other)
         {
             this->multiply(other);
             return *this;
         }
 
-        vec4<T>& operator/=(const vec4<T>& other)
+        constexpr vec4<T>& operator/=(const vec4<T>& other)
         {
             this->divide(other);
             return *this;
         }
 
         // Scalars
-        vec4<T>& operator+=(T scalar)
+        constexpr vec4<T>& operator+=(T scalar)
         {
             this->add(scalar);
             return *this;
         }
 
-        vec4<T>& operator-=(T scalar)
+        constexpr vec4<T>& operator-=(T scalar)
         {
             this->substract(scalar);
             return *this;
         }
 
-        vec4<T>& operator*=(T scalar)
+        constexpr vec4<T>& operator*=(T scalar)
         {
             this->multiply(scalar);
             return *this;
         }
 
-        vec4<T>& operator/=(T scalar)
+        constexpr vec4<T>& operator/=(T scalar)
         {
             this->divide(scalar);
             return *this;
         }
 
-        friend bool operator==(const vec4& left, const vec4& right)
+        friend constexpr bool operator==(const vec4& left, const vec4& right)
         {
             return left.x == right.x and left.y == right.y && left.z == right.z && left.w == right.w;
         }
 
-        friend bool operator!=(const vec4& left, const vec4& right)
+        friend constexpr bool operator!=(const vec4& left, const vec4& right)
         {
             return !(left.x == right.x and left.y == right.y && left.z == right.z && left.w == right.w);
         }
 
-        std::string to_string() const
-        {
-            return std::format("({}, {}, {}, {})", this->x, this->y, this->z, this->w);
-        }
+    }; // vec4
 
-        friend std::ostream& operator<<(std::ostream& os, const vec4<T>& vec) {
-            os << vec.to_string();
-            return os;
-        }
+    // Integer vectors
+    // The vector templates with integer components, for pixel coordinates, grid cells and 8-bit colors
+    // Functions that need a square root or a division (length, normalized, ...) are only meant for floating point T
+    using ivec2 = vec2<int32>;
+    using ivec3 = vec3<int32>;
+    using ivec4 = vec4<int32>;
+    using u8vec3 = vec3<uint8>;
+    using u8vec4 = vec4<uint8>;
 
-    }; // vec4
+    static_assert(sizeof(u8vec4) == 4, "u8vec4 must pack into one 32-bit RGBA pixel");
 
     // Vector general operation
     // Geometry
@@ -887,342 +1127,963 @@ namespace gem {
     };
 
     template<typename T>
-    float distance(const vec2<T>& a, const vec2<T>& b)
+    constexpr T distance(const vec2<T>& a, const vec2<T>& b)
     {
         GEM_LOG(a - b);
         return (a - b).magnitude();
     }
 
     template<typename T>
-    float distance(const vec3<T>& a, const vec3<T>& b)
+    constexpr T distance(const vec3<T>& a, const vec3<T>& b)
     {
         return (a - b).magnitude();
     }
 
     template<typename T>
-    float distance(const vec4<T>& a, const vec4<T>& b)
+    constexpr T distance(const vec4<T>& a, const vec4<T>& b)
     {
         return (a - b).magnitude();
     }
 
+    // Squared distances, no sqrt, enough to compare against a squared radius
     template<typename T>
-    bool point_in_circle(const vec2<T>& point, const circle& circle)
+    constexpr T distance_squared(const vec2<T>& a, const vec2<T>& b)
     {
-        return distance(point, circle.position) <= circle.radius;
+        T dx = a.x - b.x;
+        T dy = a.y - b.y;
+        return dx * dx + dy * dy;
     }
 
     template<typename T>
-    bool point_in_sphere(const vec3<T>& point, const sphere& sphere)
+    constexpr T distance_squared(const vec3<T>& a, const vec3<T>& b)
     {
-        return distance(point, sphere.position) <= sphere.radius;
+        T dx = a.x - b.x;
+        T dy = a.y - b.y;
+        T dz = a.z - b.z;
+        return dx * dx + dy * dy + dz * dz;
     }
 
-    bool circle_in_circle(const circle& a, const circle& b)
+    template<typename T>
+    constexpr T distance_squared(const vec4<T>& a, const vec4<T>& b)
     {
-        return distance(a.position, b.position) <= a.radius + b.radius;
+        T dx = a.x - b.x;
+        T dy = a.y - b.y;
+        T dz = a.z - b.z;
+        T dw = a.w - b.w;
+        return dx * dx + dy * dy + dz * dz + dw * dw;
     }
 
-    bool sphere_in_sphere(const sphere& a, const sphere& b)
+    // Linear interpolation, a + (b - a) * t, exactly a at t = 0
+    template<typename T>
+    constexpr vec2<T> lerp(const vec2<T>& a, const vec2<T>& b, T t)
     {
-        return distance(a.position, b.position) <= a.radius + b.radius;
+        return a + (b - a) * t;
     }
 
-    // Color conversions
-    // TODO: Review (0-255 should be ivecs(ints)) -> implement ivec
-    // TODO: Remake colors
-#ifdef GEM_COLOR_CONV
-    color3 rgb_to_normalized(const color3& color)
-    {
-        vec3 c(color);
-        float conv = inverse(255.0f);
-        c.r *= conv;
-        c.g *= conv;
-        c.b *= conv;
-        return c;
-    }
-
-    color4 rgb_to_normalized(const color4& color)
-    {
-        vec4 c(color);
-        float conv = inverse(255.0f);
-        c.r *= conv;
-        c.g *= conv;
-        c.b *= conv;
-        c.a *= conv;
-        return c;
-    }
-
-    color3 normalized_to_rgb(const color3& color)
-    {
-        vec3 c(color);
-        c.r *= 255.0f;
-        c.g *= 255.0f;
-        c.b *= 255.0f;
-        return c;
-    }
-
-    color4 normalized_to_rgb(const color4& color)
-    {
-        vec4 c(color);
-        c.r *= 255.0f;
-        c.g *= 255.0f;
-        c.b *= 255.0f;
-        c.a *= 255.0f;
-        return c;
-    }
-
-    color3 rgb_to_hsv(const color3& color)
-    {
-        // Convert RGB to [0, 1] range
-        vec3 norm = rgb_to_normalized(color);
-
-        // Find min and max components of RGB
-        precision_type cmin = min(norm.r, norm.g, norm.b);
-        precision_type cmax = max(norm.r, norm.g, norm.b);
-
-        // Compute value (V) of HSV
-        precision_type v = cmax;
-        precision_type s = 0;
-        precision_type h = 0;
-        // Compute saturation (S) of HSV
-        if (v == 0) {
-            s = 0;
-        } else {
-            s = (v - cmin) / v;
-        }
-
-        // Compute hue (H) of HSV
-        if (cmax == cmin) {
-            h = 0;
-        } else if (cmax == norm.r) {
-            h = (norm.g - norm.b) / (cmax - cmin);
-        } else if (cmax == norm.g) {
-            h = 2 + (norm.b - norm.r) / (cmax - cmin);
-        } else {
-            h = 4 + (norm.r - norm.g) / (cmax - cmin);
-        }
-
-        h *= 60;
-        if (h < 0) {
-            h += 360;
-        }
-
-        return color3(h, s, v);
-    }
-
-    color3 hsv_to_rgb(const color3& color)
-    {
-        // From stackoverflow
-        double      hh, p, q, t, ff;
-        long        i;
-        color3      out;
-
-        if(color.s <= 0.0) {       // < is bogus, just shuts up warnings
-            out.r = color.v;
-            out.g = color.v;
-            out.b = color.v;
-            return out;
-        }
-        hh = color.h;
-        if(hh >= 360.0) hh = 0.0;
-        hh /= 60.0;
-        i = (long)hh;
-        ff = hh - i;
-        p = color.v * (1.0 - color.s);
-        q = color.v * (1.0 - (color.s * ff));
-        t = color.v * (1.0 - (color.s * (1.0 - ff)));
-
-        switch(i) {
-        case 0:
-            out.r = color.v;
-            out.g = t;
-            out.b = p;
-            break;
-        case 1:
-            out.r = q;
-            out.g = color.v;
-            out.b = p;
-            break;
-        case 2:
-            out.r = p;
-            out.g = color.v;
-            out.b = t;
-            break;
-
-        case 3:
-            out.r = p;
-            out.g = q;
-            out.b = color.v;
-            break;
-        case 4:
-            out.r = t;
-            out.g = p;
-            out.b = color.v;
-            break;
-        case 5:
-        default:
-            out.r = color.v;
-            out.g = p;
-            out.b = q;
-            break;
-        }
-
-        out = normalized_to_rgb(out);
-        return out;
-    }
-#endif
-    // vec2
     template<typename T>
-    T dot(const vec2<T>& first, const vec2<T>& second)
+    constexpr vec3<T> lerp(const vec3<T>& a, const vec3<T>& b, T t)
     {
-        T result = first.x * second.x + first.y * second.y;
-        return result;
+        return a + (b - a) * t;
     }
 
     template<typename T>
-    float angle(const vec2<T>& first, const vec2<T>& second)
+    constexpr vec4<T> lerp(const vec4<T>& a, const vec4<T>& b, T t)
     {
-        float angleCos = dot(first, second) / (first.magnitude() * second.magnitude());
-        return acos(angleCos);
+        return a + (b - a) * t;
     }
 
-    // vec3
+    // Overlap tests compare squared distances, radii are expected to be non negative
     template<typename T>
-    T dot(const vec3<T>& first, const vec3<T>& second)
+    constexpr bool point_in_circle(const vec2<T>& point, const circle& circle)
     {
-        T result = first.x * second.x + first.y * second.y + first.z * second.z;
-        return result;
+        return distance_squared(point, circle.position) <= circle.radius * circle.radius;
     }
 
     template<typename T>
-    float angle(const vec3<T>& first, const vec3<T>& second)
+    constexpr bool point_in_sphere(const vec3<T>& point, const sphere& sphere)
     {
-        float angleCos = dot(first, second) / (first.magnitude() * second.magnitude());
-        return acos(angleCos);
+        return distance_squared(point, sphere.position) <= sphere.radius * sphere.radius;
     }
 
-    // vec4
-    template<typename T>
-    float dot(const vec4<T>& first, const vec4<T>& second)
+    constexpr bool circle_in_circle(const circle& a, const circle& b)
     {
-        float result = first.x * second.x + first.y * second.y + first.z * second.z + first.w * second.w;
-        return result;
+        float r = a.radius + b.radius;
+        return distance_squared(a.position, b.position) <= r * r;
     }
 
-    template<typename T>
-    float angle(const vec4<T>& first, const vec4<T>& second)
+    constexpr bool sphere_in_sphere(const sphere& a, const sphere& b)
     {
-        float angleCos = dot(first, second) / (first.magnitude() * second.magnitude());
-        return acos(angleCos);
+        float r = a.radius + b.radius;
+        return distance_squared(a.position, b.position) <= r * r;
     }
 
-    // Matrices
-    // mat4
-    // 4x4 matrix
-    template<typename T>
-    struct mat4
+    // Primitives
+    // Float only like circle and sphere. Raycasts return true on a hit and write the distance along the ray
+    // (in units of the direction length) to t, 0 when the origin is inside a solid
+    struct aabb
     {
-        // Data
-        union
-        {
-            T elements[4 * 4];
-            // TEMP -> template
-            vec4<T> columns[4];
-        };
+        vec3<float> min = vec3(0.0f);
+        vec3<float> max = vec3(0.0f);
+    };
+
+    // Oriented box, axes must be orthonormal
+    struct obb
+    {
+        vec3<float> center = vec3(0.0f);
+        vec3<float> half_extents = vec3(0.5f);
+        vec3<float> axes[3] = { vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f) };
+    };
+
+    // Points on the plane satisfy dot(normal, p) + distance == 0, normal must be unit
+    struct plane
+    {
+        vec3<float> normal = vec3(0.0f, 1.0f, 0.0f);
+        float distance = 0.0f;
+    };
+
+    // Segment from a to b swept by a sphere
+    struct capsule
+    {
+        vec3<float> a = vec3(0.0f);
+        vec3<float> b = vec3(0.0f);
+        float radius = 1.0f;
+    };
+
+    struct triangle
+    {
+        vec3<float> a = vec3(0.0f);
+        vec3<float> b = vec3(0.0f);
+        vec3<float> c = vec3(0.0f);
+    };
 
-        mat4()
+    // The inverse direction is computed once per ray for the slab tests, zero components become infinities
+    // (at run time, dividing by zero is not a constant expression)
+    struct ray
+    {
+        vec3<float> origin = vec3(0.0f);
+        vec3<float> direction = vec3(0.0f, 0.0f, 1.0f);
+        vec3<float> inverse_direction = vec3(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), 1.0f);
+
+        constexpr ray() = default;
+
+        constexpr ray(const vec3<float>& origin, const vec3<float>& direction)
+            : origin(origin), direction(direction), inverse_direction(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z)
         {
-            for (int32 i = 0; i < 4 * 4; i++)
-                elements[i] = T{};
         }
 
-        mat4(T diagonal)
+        constexpr vec3<float> at(float t) const
         {
-            // Initialize all elements to 0
-            for (int32 i = 0; i < 4 * 4; i++)
-                elements[i] = T{};
-
-            // Set the diagonal
-            elements[0 + 0 * 4] = diagonal;
-            elements[1 + 1 * 4] = diagonal;
-            elements[2 + 2 * 4] = diagonal;
-            elements[3 + 3 * 4] = diagonal;
+            return origin + direction * t;
         }
+    };
+
+    namespace detail {
 
-        static mat4<T> identiy()
+        // Same choice as minps / maxps, the second operand wins when either is NaN
+        constexpr float slab_min(float a, float b)
         {
-            return mat4<T>(static_cast<T>(1));
+            return a < b ? a : b;
         }
 
-        mat4<T>& multiply(const mat4<T>& other)
+        constexpr float slab_max(float a, float b)
         {
-            for (int32 y = 0; y < 4; y++)
-            {
-                for (int32 x = 0; x < 4; x++)
-                {
-                    T sum = static_cast<T>(1);
-                    for (int32 e = 0; e < 4; e++)
-                    {
-                        sum += elements[x + e * 4] * other.elements[e + y * 4];
-                    }
-                    elements[x + y * 4] = sum;
-                }
-            }
-    
-            return *this;
+            return a > b ? a : b;
         }
 
-        float determinant() const
+        constexpr float closest_on_segment(const vec3<float>& point, const vec3<float>& a, const vec3<float>& b)
         {
-            float a = elements[0], b = elements[1], c = elements[2], d = elements[3];
-            float e = elements[4], f = elements[5], g = elements[6], h = elements[7];
-            float i = elements[8], j = elements[9], k = elements[10], l = elements[11];
-            float m = elements[12], n = elements[13], o = elements[14], p = elements[15];
+            vec3<float> ab = b - a;
+            float length_squared = ab.dot(ab);
+            if (length_squared == 0.0f)
+                return 0.0f;
+            return clamp((point - a).dot(ab) / length_squared, 0.0f, 1.0f);
+        }
 
-            float det = 
-                  a * f * k * p + a * g * l * n + a * h * j * o
-                - a * f * l * o - a * g * j * p - a * h * k * n
-                - b * e * k * p - b * g * l * m - b * h * i * o
-                + b * e * l * o + b * g * i * p + b * h * k * m
-                + c * e * j * p + c * f * l * m + c * h * i * n
-                - c * e * l * n - c * f * i * p - c * h * j * m
-                - d * e * j * o - d * f * k * m - d * g * i * n
-                + d * e * k * n + d * f * i * o + d * g * j * m;
+    }
 
-            return det;
-        }
+    template<typename T>
+    constexpr bool point_in_aabb(const vec3<T>& point, const aabb& box)
+    {
+        return point.x >= box.min.x && point.x <= box.max.x &&
+               point.y >= box.min.y && point.y <= box.max.y &&
+               point.z >= box.min.z && point.z <= box.max.z;
+    }
+
+    constexpr bool aabb_in_aabb(const aabb& a, const aabb& b)
+    {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+               a.min.y <= b.max.y && a.max.y >= b.min.y &&
+               a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+
+    constexpr bool sphere_in_aabb(const sphere& sphere, const aabb& box)
+    {
+        const vec3<float>& c = sphere.position;
+        vec3<float> closest(clamp(c.x, box.min.x, box.max.x), clamp(c.y, box.min.y, box.max.y), clamp(c.z, box.min.z, box.max.z));
+        return distance_squared(c, closest) <= sphere.radius * sphere.radius;
+    }
 
-        mat4<T>& invert() // From sparky engine
+    template<typename T>
+    constexpr bool point_in_obb(const vec3<T>& point, const obb& box)
+    {
+        vec3<float> d = point - box.center;
+        const float* half = &box.half_extents.x;
+        for (int32 i = 0; i < 3; i++)
         {
-            T temp[16];
+            float p = d.dot(box.axes[i]);
+            if (p > half[i] || p < -half[i])
+                return false;
+        }
+        return true;
+    }
 
-            temp[0] = elements[5] * elements[10] * elements[15] -
-                elements[5] * elements[11] * elements[14] -
-                elements[9] * elements[6] * elements[15] +
-                elements[9] * elements[7] * elements[14] +
-                elements[13] * elements[6] * elements[11] -
-                elements[13] * elements[7] * elements[10];
+    constexpr float signed_distance(const plane& plane, const vec3<float>& point)
+    {
+        return plane.normal.dot(point) + plane.distance;
+    }
 
-            temp[4] = -elements[4] * elements[10] * elements[15] +
-                elements[4] * elements[11] * elements[14] +
-                elements[8] * elements[6] * elements[15] -
-                elements[8] * elements[7] * elements[14] -
-                elements[12] * elements[6] * elements[11] +
-                elements[12] * elements[7] * elements[10];
+    template<typename T>
+    constexpr bool point_in_capsule(const vec3<T>& point, const capsule& capsule)
+    {
+        vec3<float> closest = capsule.a + (capsule.b - capsule.a) * detail::closest_on_segment(point, capsule.a, capsule.b);
+        return distance_squared(point, closest) <= capsule.radius * capsule.radius;
+    }
 
-            temp[8] = elements[4] * elements[9] * elements[15] -
-                elements[4] * elements[11] * elements[13] -
-                elements[8] * elements[5] * elements[15] +
-                elements[8] * elements[7] * elements[13] +
-                elements[12] * elements[5] * elements[11] -
-                elements[12] * elements[7] * elements[9];
+    constexpr bool sphere_in_capsule(const sphere& sphere, const capsule& capsule)
+    {
+        vec3<float> closest = capsule.a + (capsule.b - capsule.a) * detail::closest_on_segment(sphere.position, capsule.a, capsule.b);
+        float r = sphere.radius + capsule.radius;
+        return distance_squared(sphere.position, closest) <= r * r;
+    }
 
-            temp[12] = -elements[4] * elements[9] * elements[14] +
-                elements[4] * elements[10] * elements[13] +
-                elements[8] * elements[5] * elements[14] -
-                elements[8] * elements[6] * elements[13] -
-                elements[12] * elements[5] * elements[10] +
-                elements[12] * elements[6] * elements[9];
+    // Slab method
+    constexpr bool raycast(const ray& ray, const aabb& box, float& t)
+    {
+        float t0 = (box.min.x - ray.origin.x) * ray.inverse_direction.x;
+        float t1 = (box.max.x - ray.origin.x) * ray.inverse_direction.x;
+        float t_near = detail::slab_min(t0, t1);
+        float t_far = detail::slab_max(t0, t1);
+
+        t0 = (box.min.y - ray.origin.y) * ray.inverse_direction.y;
+        t1 = (box.max.y - ray.origin.y) * ray.inverse_direction.y;
+        t_near = detail::slab_max(detail::slab_min(t0, t1), t_near);
+        t_far = detail::slab_min(detail::slab_max(t0, t1), t_far);
+
+        t0 = (box.min.z - ray.origin.z) * ray.inverse_direction.z;
+        t1 = (box.max.z - ray.origin.z) * ray.inverse_direction.z;
+        t_near = detail::slab_max(detail::slab_min(t0, t1), t_near);
+        t_far = detail::slab_min(detail::slab_max(t0, t1), t_far);
+
+        t_near = detail::slab_max(t_near, 0.0f);
+        if (!(t_far >= t_near))
+            return false;
+
+        t = t_near;
+        return true;
+    }
+
+    // Slab method in the box frame
+    constexpr bool raycast(const ray& ray, const obb& box, float& t)
+    {
+        vec3<float> d = ray.origin - box.center;
+        vec3<float> origin(d.dot(box.axes[0]), d.dot(box.axes[1]), d.dot(box.axes[2]));
+        vec3<float> direction(ray.direction.dot(box.axes[0]), ray.direction.dot(box.axes[1]), ray.direction.dot(box.axes[2]));
+        return raycast(gem::ray(origin, direction), aabb{ box.half_extents * -1.0f, box.half_extents }, t);
+    }
+
+    constexpr bool raycast(const ray& ray, const plane& plane, float& t)
+    {
+        float denominator = plane.normal.dot(ray.direction);
+        if (denominator == 0.0f)
+            return false;
+
+        float hit = -signed_distance(plane, ray.origin) / denominator;
+        if (hit < 0.0f)
+            return false;
+
+        t = hit;
+        return true;
+    }
+
+    constexpr bool raycast(const ray& ray, const sphere& sphere, float& t)
+    {
+        vec3<float> m = ray.origin - sphere.position;
+        float a = ray.direction.dot(ray.direction);
+        float b = m.dot(ray.direction);
+        float c = m.dot(m) - sphere.radius * sphere.radius;
+
+        // Outside and pointing away
+        if (c > 0.0f && b > 0.0f)
+            return false;
+
+        float discriminant = b * b - a * c;
+        if (discriminant < 0.0f)
+            return false;
+
+        float hit = (-b - sqrt(discriminant)) / a;
+        t = hit < 0.0f ? 0.0f : hit;
+        return true;
+    }
+
+    // Möller-Trumbore, both faces count, epsilon rejects rays parallel to the triangle
+    constexpr bool raycast(const ray& ray, const triangle& triangle, float& t)
+    {
+        constexpr float epsilon = 1e-8f;
+
+        vec3<float> e1 = triangle.b - triangle.a;
+        vec3<float> e2 = triangle.c - triangle.a;
+        vec3<float> p = ray.direction.cross(e2);
+        float det = e1.dot(p);
+        if (det < epsilon && det > -epsilon)
+            return false;
+
+        float inv_det = 1.0f / det;
+        vec3<float> s = ray.origin - triangle.a;
+        float u = s.dot(p) * inv_det;
+        if (u < 0.0f || u > 1.0f)
+            return false;
+
+        vec3<float> q = s.cross(e1);
+        float v = ray.direction.dot(q) * inv_det;
+        if (v < 0.0f || u + v > 1.0f)
+            return false;
+
+        float hit = e2.dot(q) * inv_det;
+        if (hit < 0.0f)
+            return false;
+
+        t = hit;
+        return true;
+    }
+
+    // Color conversions
+    // 8-bit colors are u8vec3 / u8vec4 in [0, 255], normalized ones vec3 / vec4<float> in [0, 1]
+    // HSV keeps h in degrees [0, 360) and s, v in [0, 1], alpha passes through unchanged
+    // Span and image batches are in gem_color.hpp
+    namespace detail {
+        // Both take and return the three channels through packs, so the scalar functions below and the
+        // batches in gem_color.hpp compute the same values
+        template<typename P>
+        void rgb_to_hsv(P r, P g, P b, P& h, P& s, P& v)
+        {
+            using V = typename P::value_type;
+            auto c = [](double value) { return P::broadcast(static_cast<V>(value)); };
+
+            P cmax = max(max(r, g), b);
+            P cmin = min(min(r, g), b);
+            P delta = cmax - cmin;
+            P inv = c(1.0) / delta;
+
+            // Gray pixels divide by zero, the selects drop those lanes
+            P hue = select(r >= cmax, (g - b) * inv, select(g >= cmax, c(2.0) + (b - r) * inv, c(4.0) + (r - g) * inv));
+            hue = select(delta > c(0.0), hue * c(60.0), c(0.0));
+            h = select(hue < c(0.0), hue + c(360.0), hue);
+            s = select(cmax > c(0.0), delta / cmax, c(0.0));
+            v = cmax;
+        }
+
+        template<typename P>
+        void hsv_to_rgb(P h, P s, P v, P& r, P& g, P& b)
+        {
+            using V = typename P::value_type;
+            auto c = [](double value) { return P::broadcast(static_cast<V>(value)); };
+
+            P hh = select(h >= c(360.0), c(0.0), h) * c(1.0 / 60.0);
+            P sector = fast::detail::round(hh);
+            sector = select(sector > hh, sector - c(1.0), sector);
+            P ff = hh - sector;
+            P p = v * (c(1.0) - s);
+            P q = v * (c(1.0) - s * ff);
+            P t = v * (c(1.0) - s * (c(1.0) - ff));
+
+            // Sectors 0 to 5, each channel is one of v, p, q, t
+            auto pick = [&](P s0, P s1, P s2, P s3, P s4, P s5) {
+                return select(sector < c(0.5), s0, select(sector < c(1.5), s1, select(sector < c(2.5), s2,
+                       select(sector < c(3.5), s3, select(sector < c(4.5), s4, s5)))));
+            };
+            r = pick(v, q, p, p, t, v);
+            g = pick(t, v, v, q, p, p);
+            b = pick(p, p, t, v, v, q);
+        }
+    }
+
+    inline vec3<float> rgb_to_normalized(const u8vec3& color)
+    {
+        const float conv = 1.0f / 255.0f;
+        return vec3<float>(color.x * conv, color.y * conv, color.z * conv);
+    }
+
+    inline vec4<float> rgb_to_normalized(const u8vec4& color)
+    {
+        const float conv = 1.0f / 255.0f;
+        return vec4<float>(color.x * conv, color.y * conv, color.z * conv, color.w * conv);
+    }
+
+    namespace detail {
+        // Clamped and rounded to nearest even, like the cvtps_epi32 and saturating packs of the batches
+        // The compiler turns the scalar clamp into branches that mispredict on image data, so SSE uses minss / maxss
+        // (same NaN behavior). Adding 1.5 * 2^23 leaves the rounded integer in the low mantissa bits
+        inline uint8 to_channel(float value)
+        {
+#if defined(GEM_SSE)
+            __m128 scaled = _mm_mul_ss(_mm_set_ss(value), _mm_set_ss(255.0f));
+            return static_cast<uint8>(_mm_cvtss_si32(_mm_min_ss(_mm_max_ss(scaled, _mm_setzero_ps()), _mm_set_ss(255.0f))));
+#else
+            return static_cast<uint8>(std::bit_cast<uint32>(clamp(value * 255.0f, 0.0f, 255.0f) + 12582912.0f));
+#endif
+        }
+    }
+
+    inline u8vec3 normalized_to_rgb(const vec3<float>& color)
+    {
+        return u8vec3(detail::to_channel(color.x), detail::to_channel(color.y), detail::to_channel(color.z));
+    }
+
+    inline u8vec4 normalized_to_rgb(const vec4<float>& color)
+    {
+        return u8vec4(detail::to_channel(color.x), detail::to_channel(color.y), detail::to_channel(color.z), detail::to_channel(color.w));
+    }
+
+    template<std::floating_point T>
+    vec3<T> rgb_to_hsv(const vec3<T>& color)
+    {
+        simd::scalar<T> h, s, v;
+        detail::rgb_to_hsv(simd::scalar<T>{ color.x }, simd::scalar<T>{ color.y }, simd::scalar<T>{ color.z }, h, s, v);
+        return vec3<T>(h.v, s.v, v.v);
+    }
+
+    template<std::floating_point T>
+    vec4<T> rgb_to_hsv(const vec4<T>& color)
+    {
+        vec3<T> hsv = rgb_to_hsv(vec3<T>(color.x, color.y, color.z));
+        return vec4<T>(hsv.x, hsv.y, hsv.z, color.w);
+    }
+
+    template<std::floating_point T>
+    vec3<T> hsv_to_rgb(const vec3<T>& color)
+    {
+        simd::scalar<T> r, g, b;
+        detail::hsv_to_rgb(simd::scalar<T>{ color.x }, simd::scalar<T>{ color.y }, simd::scalar<T>{ color.z }, r, g, b);
+        return vec3<T>(r.v, g.v, b.v);
+    }
+
+    template<std::floating_point T>
+    vec4<T> hsv_to_rgb(const vec4<T>& color)
+    {
+        vec3<T> rgb = hsv_to_rgb(vec3<T>(color.x, color.y, color.z));
+        return vec4<T>(rgb.x, rgb.y, rgb.z, color.w);
+    }
+
+    // sRGB transfer functions (IEC 61966-2-1) and tonemapping, on the color channels only, alpha stays linear
+    // The power segments use fast::pow, so the batches in gem_color.hpp match these bit for bit
+    namespace detail {
+
+        template<fast::accuracy A, typename P>
+        P srgb_to_linear(P s)
+        {
+            using V = typename P::value_type;
+            auto c = [](double value) { return P::broadcast(static_cast<V>(value)); };
+
+            // Divided rather than multiplied by 1 / 1.055 so that 1 maps to exactly 1
+            P curve = fast::pow<A>((s + c(0.055)) / c(1.055), c(2.4));
+            return select(s <= c(0.04045), s * c(1.0 / 12.92), curve);
+        }
+
+        template<fast::accuracy A, typename P>
+        P linear_to_srgb(P l)
+        {
+            using V = typename P::value_type;
+            auto c = [](double value) { return P::broadcast(static_cast<V>(value)); };
+
+            // 1.055 * p - 0.055 written as p + 0.055 * (p - 1), exact at 1
+            P p = fast::pow<A>(l, c(1.0 / 2.4));
+            P curve = p + c(0.055) * (p - c(1.0));
+            return select(l <= c(0.0031308), l * c(12.92), curve);
+        }
+
+        // Extended Reinhard, c * (1 + c / white^2) / (1 + c), inv_white2 = 0 gives the plain c / (1 + c)
+        template<typename P>
+        P tonemap_reinhard(P color, P inv_white2)
+        {
+            P one = P::broadcast(1);
+            return color * (one + color * inv_white2) / (one + color);
+        }
+
+        // ACES filmic curve fit (K. Narkowicz), clamped to [0, 1]
+        template<typename P>
+        P tonemap_aces(P x)
+        {
+            using V = typename P::value_type;
+            auto c = [](double value) { return P::broadcast(static_cast<V>(value)); };
+
+            P mapped = (x * (c(2.51) * x + c(0.03))) / (x * (c(2.43) * x + c(0.59)) + c(0.14));
+            return min(max(mapped, c(0.0)), c(1.0));
+        }
+
+        // Reciprocal of alpha for unpremultiply, 0 for fully transparent colors
+        template<typename P>
+        P inverse_alpha(P alpha)
+        {
+            return select(alpha > P::broadcast(0), P::broadcast(1) / alpha, P::broadcast(0));
+        }
+
+        // Applies kernel to the three color channels
+        template<typename T, typename Kernel>
+        vec3<T> map_rgb(const vec3<T>& color, Kernel&& kernel)
+        {
+            return vec3<T>(kernel(simd::scalar<T>{ color.x }).v, kernel(simd::scalar<T>{ color.y }).v, kernel(simd::scalar<T>{ color.z }).v);
+        }
+
+    }
+
+    // Within about 1e-6 of the exact curves at accuracy::high (float), see bench/srgb.cpp
+    template<fast::accuracy A = fast::accuracy::high, std::floating_point T>
+    vec3<T> srgb_to_linear(const vec3<T>& color)
+    {
+        return detail::map_rgb(color, [](auto s) { return detail::srgb_to_linear<A>(s); });
+    }
+
+    template<fast::accuracy A = fast::accuracy::high, std::floating_point T>
+    vec4<T> srgb_to_linear(const vec4<T>& color)
+    {
+        vec3<T> rgb = srgb_to_linear<A>(vec3<T>(color.x, color.y, color.z));
+        return vec4<T>(rgb.x, rgb.y, rgb.z, color.w);
+    }
+
+    template<fast::accuracy A = fast::accuracy::high, std::floating_point T>
+    vec3<T> linear_to_srgb(const vec3<T>& color)
+    {
+        return detail::map_rgb(color, [](auto l) { return detail::linear_to_srgb<A>(l); });
+    }
+
+    template<fast::accuracy A = fast::accuracy::high, std::floating_point T>
+    vec4<T> linear_to_srgb(const vec4<T>& color)
+    {
+        vec3<T> rgb = linear_to_srgb<A>(vec3<T>(color.x, color.y, color.z));
+        return vec4<T>(rgb.x, rgb.y, rgb.z, color.w);
+    }
+
+    // 8-bit sRGB pixels, table lookups of the exact curve (rounded from double), alpha is divided by 255
+    namespace detail {
+        inline const float* srgb8_table()
+        {
+            static const auto table = [] {
+                struct { float values[256]; } result;
+                for (int32 i = 0; i < 256; i++)
+                {
+                    double s = i / 255.0;
+                    result.values[i] = static_cast<float>(s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4));
+                }
+                return result;
+            }();
+            return table.values;
+        }
+    }
+
+    inline vec4<float> srgb_to_linear(const u8vec4& color)
+    {
+        const float* table = detail::srgb8_table();
+        return vec4<float>(table[color.x], table[color.y], table[color.z], color.w * (1.0f / 255.0f));
+    }
+
+    // Linear floats to 8-bit sRGB without pow: [2^-13, 1) is split into 104 buckets (8 per octave) by the exponent and
+    // the top 3 mantissa bits, and each bucket is a straight line in the next 8 mantissa bits. An entry holds the line's
+    // bias (high 16 bits, in 1/128 codes) and slope (low 16 bits, in 1/65536 codes). The lines are fitted to the exact
+    // curve and round like it except for about 0.4% of the inputs, which are one code off
+    namespace detail {
+        inline constexpr uint32 srgb8_encode_table[104] = {
+            0x0070000a, 0x0079000f, 0x0080000a, 0x0084000a, 0x008a000a, 0x0091000a, 0x0097000a, 0x009e000a,
+            0x00a40017, 0x00b10017, 0x00be0017, 0x00cb0017, 0x00d70017, 0x00e40017, 0x00f50018, 0x01000017,
+            0x010b0030, 0x01250030, 0x013e0030, 0x01580030, 0x01750033, 0x018c0030, 0x01a50030, 0x01bf0030,
+            0x01dd0064, 0x020c0064, 0x02400064, 0x02760069, 0x02a70064, 0x02de0065, 0x030e0064, 0x03410064,
+            0x037800cb, 0x03df00cc, 0x044600cd, 0x04ad00cd, 0x051100ca, 0x057a00c2, 0x05dd00bb, 0x063c00b3,
+            0x06980155, 0x0743013f, 0x07e30130, 0x087a0121, 0x090c0110, 0x09950103, 0x0a1800f9, 0x0a9600ef,
+            0x0b1001c8, 0x0bf301b1, 0x0ccb0193, 0x0d96017f, 0x0e55016f, 0x0f0e015b, 0x0fbd014d, 0x10630143,
+            0x11080261, 0x1239023d, 0x1358021a, 0x14650204, 0x156601ea, 0x165a01d3, 0x174401be, 0x182501ac,
+            0x18fe0330, 0x1a9702fb, 0x1c1602d0, 0x1d7d02ad, 0x1ed4028d, 0x201b026d, 0x21520256, 0x227c0242,
+            0x239f0441, 0x25c103fd, 0x27c003c1, 0x29a10392, 0x2b690368, 0x2d1e033e, 0x2ebe031d, 0x304d02ff,
+            0x31d105ae, 0x34a90553, 0x37520509, 0x39d504c2, 0x3c37048a, 0x3e7b045a, 0x40a80428, 0x42bd03ff,
+            0x44c30797, 0x488e071f, 0x4c1e06b3, 0x4f76065e, 0x52a5060e, 0x55ac05ca, 0x5892058d, 0x5b580556,
+            0x5e0b0a26, 0x631c097f, 0x67dc08f5, 0x6c55087e, 0x70950815, 0x74a107bc, 0x787c076e, 0x7c340724
+        };
+
+        inline constexpr uint32 srgb8_encode_min = (127 - 13) << 23;   // 2^-13, everything below encodes to 0
+        inline constexpr uint32 srgb8_encode_max = 0x3f7fffff;         // largest float below 1, the last bucket ends at 255
+
+        // NaN and negative values clamp to the bottom like in to_channel
+        inline uint8 to_srgb8_channel(float value)
+        {
+            float clamped = min(max(value, std::bit_cast<float>(srgb8_encode_min)), std::bit_cast<float>(srgb8_encode_max));
+            uint32 bits = std::bit_cast<uint32>(clamped);
+            uint32 entry = srgb8_encode_table[(bits - srgb8_encode_min) >> 20];
+            uint32 bias = (entry >> 16) << 9, scale = entry & 0xffff, t = (bits >> 12) & 0xff;
+            return static_cast<uint8>((bias + scale * t) >> 16);
+        }
+    }
+
+    // Alpha is linear and goes through normalized_to_rgb
+    inline u8vec4 linear_to_srgb8(const vec4<float>& color)
+    {
+        return u8vec4(detail::to_srgb8_channel(color.x), detail::to_srgb8_channel(color.y), detail::to_srgb8_channel(color.z),
+                      detail::to_channel(color.w));
+    }
+
+    // white is the smallest value mapped to 1, infinity for the plain Reinhard operator
+    template<std::floating_point T>
+    vec3<T> tonemap_reinhard(const vec3<T>& color, T white = std::numeric_limits<T>::infinity())
+    {
+        simd::scalar<T> inv_white2{ 1 / (white * white) };
+        return detail::map_rgb(color, [&](auto c) { return detail::tonemap_reinhard(c, inv_white2); });
+    }
+
+    template<std::floating_point T>
+    vec4<T> tonemap_reinhard(const vec4<T>& color, T white = std::numeric_limits<T>::infinity())
+    {
+        vec3<T> rgb = tonemap_reinhard(vec3<T>(color.x, color.y, color.z), white);
+        return vec4<T>(rgb.x, rgb.y, rgb.z, color.w);
+    }
+
+    // Fitted to the ACES reference at an exposure of 0.6, scale the input by 0.6 for the same brightness
+    template<std::floating_point T>
+    vec3<T> tonemap_aces(const vec3<T>& color)
+    {
+        return detail::map_rgb(color, [](auto c) { return detail::tonemap_aces(c); });
+    }
+
+    template<std::floating_point T>
+    vec4<T> tonemap_aces(const vec4<T>& color)
+    {
+        vec3<T> rgb = tonemap_aces(vec3<T>(color.x, color.y, color.z));
+        return vec4<T>(rgb.x, rgb.y, rgb.z, color.w);
+    }
+
+    // Premultiplied alpha
+    // Fully transparent colors unpremultiply to (0, 0, 0, 0)
+    template<std::floating_point T>
+    vec4<T> premultiply(const vec4<T>& color)
+    {
+        return vec4<T>(color.x * color.w, color.y * color.w, color.z * color.w, color.w);
+    }
+
+    template<std::floating_point T>
+    vec4<T> unpremultiply(const vec4<T>& color)
+    {
+        T inv = detail::inverse_alpha(simd::scalar<T>{ color.w }).v;
+        return vec4<T>(color.x * inv, color.y * inv, color.z * inv, color.w);
+    }
+
+    // 8-bit channels, c * a / 255 and c * 255 / a rounded to nearest, exact integer arithmetic
+    inline u8vec4 premultiply(const u8vec4& color)
+    {
+        auto channel = [&](uint8 c) {
+            uint32 t = static_cast<uint32>(c) * color.w + 128;
+            return static_cast<uint8>((t + (t >> 8)) >> 8);
+        };
+        return u8vec4(channel(color.x), channel(color.y), channel(color.z), color.w);
+    }
+
+    inline u8vec4 unpremultiply(const u8vec4& color)
+    {
+        if (color.w == 0)
+            return u8vec4(0, 0, 0, 0);
+
+        auto channel = [&](uint8 c) {
+            uint32 q = (static_cast<uint32>(c) * 255 + color.w / 2) / color.w;
+            return static_cast<uint8>(q < 255 ? q : 255);
+        };
+        return u8vec4(channel(color.x), channel(color.y), channel(color.z), color.w);
+    }
+
+    // vec2
+    template<typename T>
+    constexpr T dot(const vec2<T>& first, const vec2<T>& second)
+    {
+        T result = first.x * second.x + first.y * second.y;
+        return result;
+    }
+
+    template<typename T>
+    T angle(const vec2<T>& first, const vec2<T>& second)
+    {
+        T angleCos = dot(first, second) / (first.magnitude() * second.magnitude());
+        return std::acos(angleCos);
+    }
+
+    // vec3
+    template<typename T>
+    constexpr T dot(const vec3<T>& first, const vec3<T>& second)
+    {
+        T result = first.x * second.x + first.y * second.y + first.z * second.z;
+        return result;
+    }
+
+    template<typename T>
+    constexpr vec3<T> cross(const vec3<T>& first, const vec3<T>& second)
+    {
+        return first.cross(second);
+    }
+
+    template<typename T>
+    T angle(const vec3<T>& first, const vec3<T>& second)
+    {
+        T angleCos = dot(first, second) / (first.magnitude() * second.magnitude());
+        return std::acos(angleCos);
+    }
+
+    // vec4
+    template<typename T>
+    constexpr T dot(const vec4<T>& first, const vec4<T>& second)
+    {
+        return first.dot(second);
+    }
+
+    template<typename T>
+    T angle(const vec4<T>& first, const vec4<T>& second)
+    {
+        T angleCos = dot(first, second) / (first.magnitude() * second.magnitude());
+        return std::acos(angleCos);
+    }
+
+    // Fast variants, gem::fast::rsqrt and gem::fast::acos instead of sqrt, division and std::acos
+    // Within a few float ulp of normalized() and angle() at accuracy::high, see gem_fast.hpp for the bounds
+    template<fast::accuracy A = fast::accuracy::high, std::floating_point T>
+    vec2<T> normalize_fast(const vec2<T>& vec)
+    {
+        T length_squared = dot(vec, vec);
+        return length_squared > 0 ? vec * fast::rsqrt<A>(length_squared) : vec;
+    }
+
+    template<fast::accuracy A = fast::accuracy::high, std::floating_point T>
+    vec3<T> normalize_fast(const vec3<T>& vec)
+    {
+        T length_squared = dot(vec, vec);
+        return length_squared > 0 ? vec * fast::rsqrt<A>(length_squared) : vec;
+    }
+
+    template<fast::accuracy A = fast::accuracy::high, std::floating_point T>
+    vec4<T> normalize_fast(const vec4<T>& vec)
+    {
+        T length_squared = dot(vec, vec);
+        return length_squared > 0 ? vec * fast::rsqrt<A>(length_squared) : vec;
+    }
+
+    // The cosine is clamped to [-1, 1], rounding can push it slightly out for (anti)parallel vectors
+    template<fast::accuracy A = fast::accuracy::high, std::floating_point T>
+    T angle_fast(const vec2<T>& first, const vec2<T>& second)
+    {
+        T angle_cos = dot(first, second) * fast::rsqrt<A>(dot(first, first) * dot(second, second));
+        return fast::acos<A>(clamp(angle_cos, static_cast<T>(-1), static_cast<T>(1)));
+    }
+
+    template<fast::accuracy A = fast::accuracy::high, std::floating_point T>
+    T angle_fast(const vec3<T>& first, const vec3<T>& second)
+    {
+        T angle_cos = dot(first, second) * fast::rsqrt<A>(dot(first, first) * dot(second, second));
+        return fast::acos<A>(clamp(angle_cos, static_cast<T>(-1), static_cast<T>(1)));
+    }
+
+    template<fast::accuracy A = fast::accuracy::high, std::floating_point T>
+    T angle_fast(const vec4<T>& first, const vec4<T>& second)
+    {
+        T angle_cos = dot(first, second) * fast::rsqrt<A>(dot(first, first) * dot(second, second));
+        return fast::acos<A>(clamp(angle_cos, static_cast<T>(-1), static_cast<T>(1)));
+    }
+
+    // Matrices
+    // Tag for constructors that leave the elements uninitialized, for results that are fully written right after
+    struct no_init {};
+
+    // mat4
+    // 4x4 matrix
+    // mat4<float> is 16-byte aligned and uses SSE kernels, mat4<double> products and transforms use AVX2 when available
+    // Define GEM_NO_SIMD for the scalar code
+    template<typename T>
+    struct alignas(simd::alignment<T>) mat4
+    {
+        // Data
+        union
+        {
+            T elements[4 * 4];
+            // TEMP -> template
+            vec4<T> columns[4];
+        };
+
+        constexpr mat4()
+        {
+            for (int32 i = 0; i < 4 * 4; i++)
+                elements[i] = T{};
+        }
+
+        explicit constexpr mat4(no_init)
+        {
+        }
+
+        constexpr mat4(T diagonal)
+        {
+            // Initialize all elements to 0
+            for (int32 i = 0; i < 4 * 4; i++)
+                elements[i] = T{};
+
+            // Set the diagonal
+            elements[0 + 0 * 4] = diagonal;
+            elements[1 + 1 * 4] = diagonal;
+            elements[2 + 2 * 4] = diagonal;
+            elements[3 + 3 * 4] = diagonal;
+        }
+
+        static constexpr mat4<T> identiy()
+        {
+            return mat4<T>(static_cast<T>(1));
+        }
+
+        // Matrix product, the result applies left first and then right: (left * right) * v == right * (left * v)
+        // Never aliases, left and right may be the same matrix
+        static constexpr mat4<T> product(const mat4<T>& left, const mat4<T>& right)
+        {
+            mat4<T> result(no_init{});
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    // result.columns[y] = sum of left.columns[e] * right.columns[y][e]
+                    __m128 c0 = _mm_load_ps(&left.elements[0]);
+                    __m128 c1 = _mm_load_ps(&left.elements[4]);
+                    __m128 c2 = _mm_load_ps(&left.elements[8]);
+                    __m128 c3 = _mm_load_ps(&left.elements[12]);
+
+                    for (int32 y = 0; y < 4; y++)
+                    {
+                        const float* b = &right.elements[y * 4];
+                        __m128 sum = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(b[0])), _mm_mul_ps(c1, _mm_set1_ps(b[1])));
+                        sum = _mm_add_ps(sum, _mm_mul_ps(c2, _mm_set1_ps(b[2])));
+                        _mm_store_ps(&result.elements[y * 4], _mm_add_ps(sum, _mm_mul_ps(c3, _mm_set1_ps(b[3]))));
+                    }
+
+                    return result;
+                }
+            }
+#endif
+#if defined(GEM_AVX2)
+            if constexpr (std::is_same_v<T, double>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    // Same as the float kernel with 4 doubles per register, mat4<double> is not over aligned
+                    __m256d c0 = _mm256_loadu_pd(&left.elements[0]);
+                    __m256d c1 = _mm256_loadu_pd(&left.elements[4]);
+                    __m256d c2 = _mm256_loadu_pd(&left.elements[8]);
+                    __m256d c3 = _mm256_loadu_pd(&left.elements[12]);
+
+                    for (int32 y = 0; y < 4; y++)
+                    {
+                        const double* b = &right.elements[y * 4];
+                        __m256d sum = _mm256_add_pd(_mm256_mul_pd(c0, _mm256_set1_pd(b[0])), _mm256_mul_pd(c1, _mm256_set1_pd(b[1])));
+                        sum = _mm256_add_pd(sum, _mm256_mul_pd(c2, _mm256_set1_pd(b[2])));
+                        _mm256_storeu_pd(&result.elements[y * 4], _mm256_add_pd(sum, _mm256_mul_pd(c3, _mm256_set1_pd(b[3]))));
+                    }
+
+                    return result;
+                }
+            }
+#endif
+            const T* a = left.elements;
+            for (int32 y = 0; y < 4; y++)
+            {
+                // One column of right is kept in registers while the four outputs are computed
+                const T b0 = right.elements[0 + y * 4];
+                const T b1 = right.elements[1 + y * 4];
+                const T b2 = right.elements[2 + y * 4];
+                const T b3 = right.elements[3 + y * 4];
+
+                result.elements[0 + y * 4] = a[0] * b0 + a[4] * b1 + a[8] * b2 + a[12] * b3;
+                result.elements[1 + y * 4] = a[1] * b0 + a[5] * b1 + a[9] * b2 + a[13] * b3;
+                result.elements[2 + y * 4] = a[2] * b0 + a[6] * b1 + a[10] * b2 + a[14] * b3;
+                result.elements[3 + y * 4] = a[3] * b0 + a[7] * b1 + a[11] * b2 + a[15] * b3;
+            }
+
+            return result;
+        }
+
+        // Folds any number of matrices left to right, concat(model, view, projection)
+        template<typename... Mats>
+        static constexpr mat4<T> concat(const mat4<T>& first, const mat4<T>& second, const Mats&... rest)
+        {
+            mat4<T> result = product(first, second);
+            ((result = product(result, rest)), ...);
+            return result;
+        }
+
+        // Same as concat, for a run time number of matrices, an empty span gives the identity
+        static constexpr mat4<T> multiply_chain(std::span<const mat4<T>> mats)
+        {
+            if (mats.empty())
+                return identiy();
+
+            mat4<T> result = mats[0];
+            for (std::size_t i = 1; i < mats.size(); i++)
+                result = product(result, mats[i]);
+
+            return result;
+        }
+
+        constexpr mat4<T>& multiply(const mat4<T>& other)
+        {
+            *this = product(*this, other);
+            return *this;
+        }
+
+        constexpr T determinant() const
+        {
+            T a = elements[0], b = elements[1], c = elements[2], d = elements[3];
+            T e = elements[4], f = elements[5], g = elements[6], h = elements[7];
+            T i = elements[8], j = elements[9], k = elements[10], l = elements[11];
+            T m = elements[12], n = elements[13], o = elements[14], p = elements[15];
+
+            T det = 
+                  a * f * k * p + a * g * l * n + a * h * j * o
+                - a * f * l * o - a * g * j * p - a * h * k * n
+                - b * e * k * p - b * g * l * m - b * h * i * o
+                + b * e * l * o + b * g * i * p + b * h * k * m
+                + c * e * j * p + c * f * l * m + c * h * i * n
+                - c * e * l * n - c * f * i * p - c * h * j * m
+                - d * e * j * o - d * f * k * m - d * g * i * n
+                + d * e * k * n + d * f * i * o + d * g * j * m;
+
+            return det;
+        }
+
+        constexpr mat4<T>& invert() // From sparky engine
+        {
+            T temp[16];
+
+            temp[0] = elements[5] * elements[10] * elements[15] -
+                elements[5] * elements[11] * elements[14] -
+                elements[9] * elements[6] * elements[15] +
+                elements[9] * elements[7] * elements[14] +
+                elements[13] * elements[6] * elements[11] -
+                elements[13] * elements[7] * elements[10];
+
+            temp[4] = -elements[4] * elements[10] * elements[15] +
+                elements[4] * elements[11] * elements[14] +
+                elements[8] * elements[6] * elements[15] -
+                elements[8] * elements[7] * elements[14] -
+                elements[12] * elements[6] * elements[11] +
+                elements[12] * elements[7] * elements[10];
+
+            temp[8] = elements[4] * elements[9] * elements[15] -
+                elements[4] * elements[11] * elements[13] -
+                elements[8] * elements[5] * elements[15] +
+                elements[8] * elements[7] * elements[13] +
+                elements[12] * elements[5] * elements[11] -
+                elements[12] * elements[7] * elements[9];
+
+            temp[12] = -elements[4] * elements[9] * elements[14] +
+                elements[4] * elements[10] * elements[13] +
+                elements[8] * elements[5] * elements[14] -
+                elements[8] * elements[6] * elements[13] -
+                elements[12] * elements[5] * elements[10] +
+                elements[12] * elements[6] * elements[9];
 
             temp[1] = -elements[1] * elements[10] * elements[15] +
                 elements[1] * elements[11] * elements[14] +
@@ -1308,7 +2169,7 @@ namespace gem {
                 elements[8] * elements[1] * elements[6] -
                 elements[8] * elements[2] * elements[5];
 
-            float determinant = elements[0] * temp[0] + elements[1] * temp[4] + elements[2] * temp[8] + elements[3] * temp[12];
+            T determinant = elements[0] * temp[0] + elements[1] * temp[4] + elements[2] * temp[8] + elements[3] * temp[12];
             determinant = ::gem::inverse(determinant);
 
             for (int32 i = 0; i < 4 * 4; i++)
@@ -1317,13 +2178,13 @@ namespace gem {
             return *this;
         }
 
-        mat4<T> inverse() const
+        constexpr mat4<T> inverse() const
         {
             mat4<T> mat = mat4::inverse(*this);
             return mat;
         }
 
-        static mat4<T> inverse(const mat4<T>& mat)
+        static constexpr mat4<T> inverse(const mat4<T>& mat)
         {
             mat4<T> result = mat;
             result.invert();
@@ -1331,22 +2192,90 @@ namespace gem {
         }
 
         // Operators
-        friend mat4<T>& operator*(mat4<T> left, const mat4<T>& right)
+        friend constexpr mat4<T> operator*(const mat4<T>& left, const mat4<T>& right)
+        {
+            return product(left, right);
+        }
+
+        friend constexpr bool operator==(const mat4<T>& left, const mat4<T>& right)
         {
-            left.multiply(right);
-            return left;
+            for (int32 i = 0; i < 4 * 4; i++)
+                if (left.elements[i] != right.elements[i])
+                    return false;
+            return true;
+        }
+
+        friend constexpr bool operator!=(const mat4<T>& left, const mat4<T>& right)
+        {
+            return !(left == right);
         }
 
-        mat4<T>& operator*=(const mat4<T>& other)
+        constexpr mat4<T>& operator*=(const mat4<T>& other)
         {
             this->multiply(other);
             return *this;
         }
 
+        // Transforms a vector, result[i] = dot(columns[i], vec)
+        constexpr vec4<T> multiply(const vec4<T>& vec) const
+        {
+            vec4<T> result;
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    __m128 c0 = _mm_load_ps(&elements[0]);
+                    __m128 c1 = _mm_load_ps(&elements[4]);
+                    __m128 c2 = _mm_load_ps(&elements[8]);
+                    __m128 c3 = _mm_load_ps(&elements[12]);
+                    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+                    __m128 v = _mm_load_ps(&vec.x);
+                    __m128 sum = _mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(v, v, 0x00)), _mm_mul_ps(c1, _mm_shuffle_ps(v, v, 0x55)));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, 0xAA)));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, 0xFF)));
+                    _mm_store_ps(&result.x, sum);
+                    return result;
+                }
+            }
+#endif
+#if defined(GEM_AVX2)
+            if constexpr (std::is_same_v<T, double>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    __m256d c0 = _mm256_loadu_pd(&elements[0]);
+                    __m256d c1 = _mm256_loadu_pd(&elements[4]);
+                    __m256d c2 = _mm256_loadu_pd(&elements[8]);
+                    __m256d c3 = _mm256_loadu_pd(&elements[12]);
+                    simd::transpose4(c0, c1, c2, c3);
+
+                    __m256d v = _mm256_loadu_pd(&vec.x);
+                    __m256d sum = _mm256_add_pd(_mm256_mul_pd(c0, _mm256_permute4x64_pd(v, 0x00)), _mm256_mul_pd(c1, _mm256_permute4x64_pd(v, 0x55)));
+                    sum = _mm256_add_pd(sum, _mm256_mul_pd(c2, _mm256_permute4x64_pd(v, 0xAA)));
+                    sum = _mm256_add_pd(sum, _mm256_mul_pd(c3, _mm256_permute4x64_pd(v, 0xFF)));
+                    _mm256_storeu_pd(&result.x, sum);
+                    return result;
+                }
+            }
+#endif
+            result.x = elements[0] * vec.x + elements[1] * vec.y + elements[2] * vec.z + elements[3] * vec.w;
+            result.y = elements[4] * vec.x + elements[5] * vec.y + elements[6] * vec.z + elements[7] * vec.w;
+            result.z = elements[8] * vec.x + elements[9] * vec.y + elements[10] * vec.z + elements[11] * vec.w;
+            result.w = elements[12] * vec.x + elements[13] * vec.y + elements[14] * vec.z + elements[15] * vec.w;
+            return result;
+        }
+
+        friend constexpr vec4<T> operator*(const mat4<T>& left, const vec4<T>& right)
+        {
+            return left.multiply(right);
+        }
+
         // Templates
-        static mat4<float> orthographic(float left, float right, float bottom, float top, float near = -1.0f, float far = 1.0f)
+        static constexpr mat4<T> orthographic(T left, T right, T bottom, T top, T near = -1, T far = 1)
         {
-            mat4<float> result(1.0f);
+            mat4<T> result(static_cast<T>(1));
             result.elements[0 + 0 * 4] = 2 / (right - left);
             result.elements[1 + 1 * 4] = 2 / (top - bottom);
             result.elements[2 + 2 * 4] = -2 / (far - near);
@@ -1359,28 +2288,28 @@ namespace gem {
         }
 
         // FOV in degrees
-        static mat4<float> perspective(float fov, float aspect_ratio, float zNear, float zFar)
+        static constexpr mat4<T> perspective(T fov, T aspect_ratio, T zNear, T zFar)
         {
-            float a = aspect_ratio * tan(to_radians(fov * 0.5f));
-            float b = tan(to_radians(fov * 0.5f));
+            T a = aspect_ratio * tan(to_radians(fov * static_cast<T>(0.5)));
+            T b = tan(to_radians(fov * static_cast<T>(0.5)));
 
-            float c = (-zNear - zFar) / (zNear - zFar);
-            float d = (2 * zNear * zFar) / (zNear - zFar);
+            T c = (-zNear - zFar) / (zNear - zFar);
+            T d = (2 * zNear * zFar) / (zNear - zFar);
 
-            mat4<float> result(0.0f);
+            mat4<T> result(static_cast<T>(0));
             result.elements[0 + 0 * 4] = ::gem::inverse(a);
             result.elements[1 + 1 * 4] = ::gem::inverse(b);
             result.elements[2 + 2 * 4] = c;
             result.elements[3 + 2 * 4] = d;
-            result.elements[2 + 3 * 4] = 1.0f;
+            result.elements[2 + 3 * 4] = 1;
 
             return result;
         }
 
         template<typename Type>
-        static mat4<Type> translate(const vec3<Type>& translation)
+        static constexpr mat4<Type> translate(const vec3<Type>& translation)
         {
-            mat4<Type> result(1.0f);
+            mat4<Type> result(static_cast<Type>(1));
             result.elements[3 + 0 * 4] = translation.x;
             result.elements[3 + 1 * 4] = translation.y;
             result.elements[3 + 2 * 4] = translation.z;
@@ -1389,18 +2318,18 @@ namespace gem {
         }
 
         template<typename Type>
-        static mat4<Type> rotation(const vec3<Type>& axis, float angle)
+        static constexpr mat4<Type> rotation(const vec3<Type>& axis, Type angle)
         {
             mat4<Type> result(static_cast<Type>(1));
 
-            float r = to_radians(angle);
-            float c = cos(r);
-            float s = sin(r);
-            float omc = 1.0f - c;
+            Type r = to_radians(angle);
+            Type c = cos(r);
+            Type s = sin(r);
+            Type omc = 1 - c;
 
-            float x = axis.x;
-            float y = axis.y;
-            float z = axis.z;
+            Type x = axis.x;
+            Type y = axis.y;
+            Type z = axis.z;
 
             result.elements[0 + 0 * 4] = x * x * omc + c;
             result.elements[0 + 1 * 4] = y * x * omc + z * s;
@@ -1417,9 +2346,9 @@ namespace gem {
             return result;
         }
 
-        static mat4<float> scale(const vec3<float>& scale)
+        static constexpr mat4<T> scale(const vec3<T>& scale)
         {
-            mat4<float> result(1.0f);
+            mat4<T> result(static_cast<T>(1));
             result.elements[0 + 0 * 4] = scale.x;
             result.elements[1 + 1 * 4] = scale.y;
             result.elements[2 + 2 * 4] = scale.z;
@@ -1427,26 +2356,351 @@ namespace gem {
             return result;
         }
 
-        std::string to_string() const
+    }; // mat4
+
+    // affine3
+    // 3x4 affine transform, the first three columns[] of a mat4 whose last one is (0, 0, 0, 1)
+    // Uses the same conventions as mat4, conversions in both directions are exact
+    template<typename T>
+    struct alignas(simd::alignment<T>) affine3
+    {
+        // Data
+        union
+        {
+            T elements[3 * 4];
+            vec4<T> columns[3];
+        };
+
+        constexpr affine3()
         {
-            return std::format("{}\n{}\n{}\n{}", columns[0].to_string(), columns[1].to_string(), columns[2].to_string(), columns[3].to_string());
+            for (int32 i = 0; i < 3 * 4; i++)
+                elements[i] = T{};
         }
 
-        friend std::ostream& operator<<(std::ostream& os, const mat4<T>& mat)
+        constexpr affine3(T diagonal)
         {
-            os << mat.to_string();
-            return os;
+            for (int32 i = 0; i < 3 * 4; i++)
+                elements[i] = T{};
+
+            elements[0 + 0 * 4] = diagonal;
+            elements[1 + 1 * 4] = diagonal;
+            elements[2 + 2 * 4] = diagonal;
         }
 
-    }; // mat4
+        explicit constexpr affine3(no_init)
+        {
+        }
+
+        // Drops the last column, which must be (0, 0, 0, 1) for the result to be exact
+        explicit constexpr affine3(const mat4<T>& mat)
+        {
+            for (int32 i = 0; i < 3 * 4; i++)
+                elements[i] = mat.elements[i];
+        }
+
+        static constexpr affine3<T> identiy()
+        {
+            return affine3<T>(static_cast<T>(1));
+        }
+
+        constexpr mat4<T> to_mat4() const
+        {
+            mat4<T> result(static_cast<T>(1));
+            for (int32 i = 0; i < 3 * 4; i++)
+                result.elements[i] = elements[i];
+
+            return result;
+        }
+
+        // Same convention as mat4::product, left is applied first
+        // Only the 3x3 part and the translation are combined: 36 multiplies instead of 64
+        static constexpr affine3<T> product(const affine3<T>& left, const affine3<T>& right)
+        {
+            const T* a = left.elements;
+            const T* b = right.elements;
+
+            affine3<T> result(no_init{});
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    __m128 c0 = _mm_load_ps(&a[0]);
+                    __m128 c1 = _mm_load_ps(&a[4]);
+                    __m128 c2 = _mm_load_ps(&a[8]);
+
+                    for (int32 i = 0; i < 3; i++)
+                    {
+                        const float* row = &b[i * 4];
+                        __m128 sum = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(row[0])), _mm_mul_ps(c1, _mm_set1_ps(row[1])));
+                        sum = _mm_add_ps(sum, _mm_mul_ps(c2, _mm_set1_ps(row[2])));
+                        sum = _mm_add_ps(sum, _mm_setr_ps(0.0f, 0.0f, 0.0f, row[3]));
+                        _mm_store_ps(&result.elements[i * 4], sum);
+                    }
+
+                    return result;
+                }
+            }
+#endif
+            for (int32 i = 0; i < 3; i++)
+            {
+                const T b0 = b[0 + i * 4];
+                const T b1 = b[1 + i * 4];
+                const T b2 = b[2 + i * 4];
+
+                result.elements[0 + i * 4] = a[0] * b0 + a[4] * b1 + a[8] * b2;
+                result.elements[1 + i * 4] = a[1] * b0 + a[5] * b1 + a[9] * b2;
+                result.elements[2 + i * 4] = a[2] * b0 + a[6] * b1 + a[10] * b2;
+                result.elements[3 + i * 4] = a[3] * b0 + a[7] * b1 + a[11] * b2 + b[3 + i * 4];
+            }
+
+            return result;
+        }
+
+        constexpr affine3<T>& multiply(const affine3<T>& other)
+        {
+            *this = product(*this, other);
+            return *this;
+        }
+
+        // Transforms a vector, w is carried through unchanged
+        constexpr vec4<T> multiply(const vec4<T>& vec) const
+        {
+            vec4<T> result;
+            result.x = elements[0] * vec.x + elements[1] * vec.y + elements[2] * vec.z + elements[3] * vec.w;
+            result.y = elements[4] * vec.x + elements[5] * vec.y + elements[6] * vec.z + elements[7] * vec.w;
+            result.z = elements[8] * vec.x + elements[9] * vec.y + elements[10] * vec.z + elements[11] * vec.w;
+            result.w = vec.w;
+            return result;
+        }
+
+        constexpr vec3<T> transform_point(const vec3<T>& point) const
+        {
+            return vec3<T>(
+                elements[0] * point.x + elements[1] * point.y + elements[2] * point.z + elements[3],
+                elements[4] * point.x + elements[5] * point.y + elements[6] * point.z + elements[7],
+                elements[8] * point.x + elements[9] * point.y + elements[10] * point.z + elements[11]);
+        }
+
+        constexpr vec3<T> transform_direction(const vec3<T>& direction) const
+        {
+            return vec3<T>(
+                elements[0] * direction.x + elements[1] * direction.y + elements[2] * direction.z,
+                elements[4] * direction.x + elements[5] * direction.y + elements[6] * direction.z,
+                elements[8] * direction.x + elements[9] * direction.y + elements[10] * direction.z);
+        }
+
+        constexpr vec3<T> translation() const
+        {
+            return vec3<T>(elements[3], elements[7], elements[11]);
+        }
+
+        constexpr T determinant() const
+        {
+            const T* e = elements;
+            return e[0] * (e[5] * e[10] - e[6] * e[9])
+                 - e[1] * (e[4] * e[10] - e[6] * e[8])
+                 + e[2] * (e[4] * e[9] - e[5] * e[8]);
+        }
+
+        // Any invertible affine transform, a 3x3 inverse plus the rotated translation
+        constexpr affine3<T>& invert()
+        {
+            const T* e = elements;
+            T r[9];
+            r[0] = e[5] * e[10] - e[6] * e[9];
+            r[1] = e[2] * e[9] - e[1] * e[10];
+            r[2] = e[1] * e[6] - e[2] * e[5];
+            r[3] = e[6] * e[8] - e[4] * e[10];
+            r[4] = e[0] * e[10] - e[2] * e[8];
+            r[5] = e[2] * e[4] - e[0] * e[6];
+            r[6] = e[4] * e[9] - e[5] * e[8];
+            r[7] = e[1] * e[8] - e[0] * e[9];
+            r[8] = e[0] * e[5] - e[1] * e[4];
+
+            T inv_det = static_cast<T>(1) / (e[0] * r[0] + e[1] * r[3] + e[2] * r[6]);
+            for (int32 i = 0; i < 9; i++)
+                r[i] *= inv_det;
+
+            set_inverse(r);
+            return *this;
+        }
+
+        // Rotation and translation only, the inverse is the transposed rotation
+        constexpr affine3<T>& invert_orthonormal()
+        {
+            const T* e = elements;
+            T r[9] = {
+                e[0], e[4], e[8],
+                e[1], e[5], e[9],
+                e[2], e[6], e[10],
+            };
+
+            set_inverse(r);
+            return *this;
+        }
+
+        // Rotation, per axis scale applied before the rotation and translation
+        // The 3x3 part has orthogonal columns, so the inverse is the transpose divided by the squared scales
+        constexpr affine3<T>& invert_scaled()
+        {
+            const T* e = elements;
+            T inv_sq[3];
+            for (int32 j = 0; j < 3; j++)
+                inv_sq[j] = static_cast<T>(1) / (e[j] * e[j] + e[j + 4] * e[j + 4] + e[j + 8] * e[j + 8]);
+
+            T r[9] = {
+                e[0] * inv_sq[0], e[4] * inv_sq[0], e[8] * inv_sq[0],
+                e[1] * inv_sq[1], e[5] * inv_sq[1], e[9] * inv_sq[1],
+                e[2] * inv_sq[2], e[6] * inv_sq[2], e[10] * inv_sq[2],
+            };
+
+            set_inverse(r);
+            return *this;
+        }
+
+        constexpr affine3<T> inverse() const
+        {
+            affine3<T> result = *this;
+            result.invert();
+            return result;
+        }
+
+        constexpr affine3<T> inverse_orthonormal() const
+        {
+            affine3<T> result = *this;
+            result.invert_orthonormal();
+            return result;
+        }
+
+        constexpr affine3<T> inverse_scaled() const
+        {
+            affine3<T> result = *this;
+            result.invert_scaled();
+            return result;
+        }
+
+        // Operators
+        friend constexpr affine3<T> operator*(const affine3<T>& left, const affine3<T>& right)
+        {
+            return product(left, right);
+        }
+
+        constexpr affine3<T>& operator*=(const affine3<T>& other)
+        {
+            this->multiply(other);
+            return *this;
+        }
+
+        friend constexpr vec4<T> operator*(const affine3<T>& left, const vec4<T>& right)
+        {
+            return left.multiply(right);
+        }
+
+        friend constexpr bool operator==(const affine3<T>& left, const affine3<T>& right)
+        {
+            for (int32 i = 0; i < 3 * 4; i++)
+                if (left.elements[i] != right.elements[i])
+                    return false;
+            return true;
+        }
+
+        friend constexpr bool operator!=(const affine3<T>& left, const affine3<T>& right)
+        {
+            return !(left == right);
+        }
+
+        // Same transforms as the mat4 builders, without the constant last column
+        static constexpr affine3<T> translate(const vec3<T>& translation)
+        {
+            affine3<T> result(static_cast<T>(1));
+            result.elements[3 + 0 * 4] = translation.x;
+            result.elements[3 + 1 * 4] = translation.y;
+            result.elements[3 + 2 * 4] = translation.z;
+
+            return result;
+        }
+
+        // Angle in degrees
+        static constexpr affine3<T> rotation(const vec3<T>& axis, T angle)
+        {
+            affine3<T> result(static_cast<T>(1));
+
+            T r = to_radians(angle);
+            T c = cos(r);
+            T s = sin(r);
+            T omc = 1 - c;
+
+            T x = axis.x;
+            T y = axis.y;
+            T z = axis.z;
+
+            result.elements[0 + 0 * 4] = x * x * omc + c;
+            result.elements[0 + 1 * 4] = y * x * omc + z * s;
+            result.elements[0 + 2 * 4] = x * z * omc - y * s;
+
+            result.elements[1 + 0 * 4] = x * y * omc - z * s;
+            result.elements[1 + 1 * 4] = y * y * omc + c;
+            result.elements[1 + 2 * 4] = y * z * omc + x * s;
+
+            result.elements[2 + 0 * 4] = x * z * omc + y * s;
+            result.elements[2 + 1 * 4] = y * z * omc - x * s;
+            result.elements[2 + 2 * 4] = z * z * omc + c;
+
+            return result;
+        }
+
+        static constexpr affine3<T> scale(const vec3<T>& scale)
+        {
+            affine3<T> result(static_cast<T>(1));
+            result.elements[0 + 0 * 4] = scale.x;
+            result.elements[1 + 1 * 4] = scale.y;
+            result.elements[2 + 2 * 4] = scale.z;
+
+            return result;
+        }
+
+    private:
+        // Writes the inverse 3x3 part r (row major) and the matching translation -r * t
+        constexpr void set_inverse(const T* r)
+        {
+            T tx = elements[3], ty = elements[7], tz = elements[11];
+            for (int32 i = 0; i < 3; i++)
+            {
+                elements[0 + i * 4] = r[0 + i * 3];
+                elements[1 + i * 4] = r[1 + i * 3];
+                elements[2 + i * 4] = r[2 + i * 3];
+                elements[3 + i * 4] = -(r[0 + i * 3] * tx + r[1 + i * 3] * ty + r[2 + i * 3] * tz);
+            }
+        }
+
+    }; // affine3
 
     // Quaternions
+    namespace detail {
+        // Weight for nlerp that makes it track slerp, d = |dot(a, b)|
+        // Polynomial fit from "Approximating slerp" (A. Kapoulkine), written over lane packs so the
+        // scalar and batched versions compute the same thing
+        template<typename P>
+        P slerp_fast_weight(P t, P d)
+        {
+            using V = typename P::value_type;
+            auto c = [](double value) { return P::broadcast(static_cast<V>(value)); };
+
+            P ka = c(1.0904) + d * (c(-3.2452) + d * (c(3.55645) - d * c(1.43519)));
+            P kb = c(0.848013) + d * (c(-1.06021) + d * c(0.215638));
+            P h = t - c(0.5);
+            P k = ka * h * h + kb;
+            return t + t * h * (t - c(1.0)) * k;
+        }
+    }
+
     template<typename T>
     struct quaternion
     {
         T x, y, z, w;
         
-        quaternion()
+        constexpr quaternion()
         {
             x = T{};
             y = T{};
@@ -1454,7 +2708,7 @@ namespace gem {
             w = T{};
         }
 
-        quaternion(T x, T y, T z, T w)
+        constexpr quaternion(T x, T y, T z, T w)
         {
             this->x = x;
             this->y = y;
@@ -1462,11 +2716,11 @@ namespace gem {
             this->w = w;
         }
 
-        quaternion(const vec3<T>& axis, float angle)
+        constexpr quaternion(const vec3<T>& axis, T angle)
         {
             // Calculate the sine and cosine of half the angle
-            float sin_half_angle = sin(angle * 0.5f);
-            float cos_half_angle = cos(angle * 0.5f);
+            T sin_half_angle = sin(angle * static_cast<T>(0.5));
+            T cos_half_angle = cos(angle * static_cast<T>(0.5));
 
             // Create a normalized quaternion from the axis of rotation and half-angle
             vec3<T> normalized_axis = axis.normalized();
@@ -1476,20 +2730,20 @@ namespace gem {
             this->w = cos_half_angle;
         }
 
-        quaternion(const vec3<T>& euler_angles)
+        constexpr quaternion(const vec3<T>& euler_angles)
         {
             // Compute half angles
-            float hx = euler_angles.x * 0.5f;
-            float hy = euler_angles.y * 0.5f;
-            float hz = euler_angles.z * 0.5f;
+            T hx = euler_angles.x * static_cast<T>(0.5);
+            T hy = euler_angles.y * static_cast<T>(0.5);
+            T hz = euler_angles.z * static_cast<T>(0.5);
 
             // Compute sin and cos of half angles
-            float cx = cos(hx);
-            float cy = cos(hy);
-            float cz = cos(hz);
-            float sx = sin(hx);
-            float sy = sin(hy);
-            float sz = sin(hz);
+            T cx = cos(hx);
+            T cy = cos(hy);
+            T cz = cos(hz);
+            T sx = sin(hx);
+            T sy = sin(hy);
+            T sz = sin(hz);
 
             // Compute the quaternion components
             this->x = sx * cy * cz - cx * sy * sz;
@@ -1498,20 +2752,20 @@ namespace gem {
             this->w = cx * cy * cz + sx * sy * sz;
         }
 
-        static quaternion<T> from_euler_angles(const vec3<T>& euler_angles)
+        static constexpr quaternion<T> from_euler_angles(const vec3<T>& euler_angles)
         {
             // Compute half angles
-            float hx = euler_angles.x * 0.5f;
-            float hy = euler_angles.y * 0.5f;
-            float hz = euler_angles.z * 0.5f;
+            T hx = euler_angles.x * static_cast<T>(0.5);
+            T hy = euler_angles.y * static_cast<T>(0.5);
+            T hz = euler_angles.z * static_cast<T>(0.5);
 
             // Compute sin and cos of half angles
-            float cx = cos(hx);
-            float cy = cos(hy);
-            float cz = cos(hz);
-            float sx = sin(hx);
-            float sy = sin(hy);
-            float sz = sin(hz);
+            T cx = cos(hx);
+            T cy = cos(hy);
+            T cz = cos(hz);
+            T sx = sin(hx);
+            T sy = sin(hy);
+            T sz = sin(hz);
 
             quaternion<T> q;
             // Compute the quaternion components
@@ -1522,25 +2776,43 @@ namespace gem {
             return q;
         }
 
-        static const quaternion<T> RotationX(float radians)
+        // from_euler_angles with the three half angles through one gem::fast::sincos4, not constexpr
+        template<fast::accuracy A = fast::accuracy::high>
+        static quaternion<T> from_euler_angles_fast(const vec3<T>& euler_angles)
         {
-            float angle = radians * 0.5f;
-            return quaternion<T>(sin(angle), 0.0f, 0.0f, cos(angle));
+            T half_angles[4] = { euler_angles.x * static_cast<T>(0.5), euler_angles.y * static_cast<T>(0.5), euler_angles.z * static_cast<T>(0.5), 0 };
+            T s[4], c[4];
+            fast::sincos4<A>(half_angles, s, c);
+            T sx = s[0], sy = s[1], sz = s[2];
+            T cx = c[0], cy = c[1], cz = c[2];
+
+            quaternion<T> q;
+            q.x = sx * cy * cz - cx * sy * sz;
+            q.y = cx * sy * cz + sx * cy * sz;
+            q.z = cx * cy * sz - sx * sy * cz;
+            q.w = cx * cy * cz + sx * sy * sz;
+            return q;
+        }
+
+        static constexpr const quaternion<T> RotationX(T radians)
+        {
+            T angle = radians * static_cast<T>(0.5);
+            return quaternion<T>(sin(angle), 0, 0, cos(angle));
         }
 
-        static const quaternion<T> RotationY(float radians)
+        static constexpr const quaternion<T> RotationY(T radians)
         {
-            float angle = radians * 0.5f;
-            return quaternion<T>(0.0f, sin(angle), 0.0f, cos(angle));
+            T angle = radians * static_cast<T>(0.5);
+            return quaternion<T>(0, sin(angle), 0, cos(angle));
         }
 
-        static const quaternion<T> RotationZ(float radians)
+        static constexpr const quaternion<T> RotationZ(T radians)
         {
-            float angle = radians * 0.5f;
-            return quaternion<T>(0.0f, 0.0f, sin(angle), cos(angle));
+            T angle = radians * static_cast<T>(0.5);
+            return quaternion<T>(0, 0, sin(angle), cos(angle));
         }
 
-        quaternion<T>& add(const quaternion<T>& other)
+        constexpr quaternion<T>& add(const quaternion<T>& other)
         {
             this->x += other.x;
             this->y += other.y;
@@ -1549,7 +2821,7 @@ namespace gem {
             return *this;
         }
 
-        quaternion<T>& substract(const quaternion<T>& other)
+        constexpr quaternion<T>& substract(const quaternion<T>& other)
         {
             this->x -= other.x;
             this->y -= other.y;
@@ -1558,28 +2830,61 @@ namespace gem {
             return *this;
         }
 
-        quaternion<T>& multiply(const quaternion<T>& other)
+        // Hamilton product, w is the real part: (*this * other) rotates by other first, then by *this
+        constexpr quaternion<T>& multiply(const quaternion<T>& other)
         {
-            this->x = x * other.x - y * other.y - z * other.z - w * other.w;
-            this->y = y * other.x + x * other.y - w * other.z + z * other.w;
-            this->z = z * other.x + w * other.y - x * other.z + y * other.w;
-            this->w = w * other.x + z * other.y - y * other.z + x * other.w;
-
+#if defined(GEM_SSE)
+            if constexpr (simd::enabled<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    // Each lane computes the scalar expression below, a - b is done as a + (-b)
+                    // which rounds the same, so both paths give identical results
+                    __m128 p = _mm_loadu_ps(&this->x);
+                    __m128 q = _mm_loadu_ps(&other.x);
+
+                    __m128 px = _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0));
+                    __m128 py = _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1));
+                    __m128 pz = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2));
+                    __m128 pw = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3));
+
+                    __m128 t1 = _mm_mul_ps(px, _mm_shuffle_ps(q, q, _MM_SHUFFLE(0, 1, 2, 3))); // qw qz qy qx
+                    __m128 t2 = _mm_mul_ps(py, _mm_shuffle_ps(q, q, _MM_SHUFFLE(1, 0, 3, 2))); // qz qw qx qy
+                    __m128 t3 = _mm_mul_ps(pz, _mm_shuffle_ps(q, q, _MM_SHUFFLE(2, 3, 0, 1))); // qy qx qw qz
+
+                    __m128 r = _mm_mul_ps(pw, q);
+                    r = _mm_add_ps(r, _mm_xor_ps(t1, _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f)));
+                    r = _mm_add_ps(r, _mm_xor_ps(t2, _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f)));
+                    r = _mm_add_ps(r, _mm_xor_ps(t3, _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f)));
+                    _mm_storeu_ps(&this->x, r);
+                    return *this;
+                }
+            }
+#endif
+            T rx = w * other.x + x * other.w + y * other.z - z * other.y;
+            T ry = w * other.y - x * other.z + y * other.w + z * other.x;
+            T rz = w * other.z + x * other.y - y * other.x + z * other.w;
+            T rw = w * other.w - x * other.x - y * other.y - z * other.z;
+
+            this->x = rx;
+            this->y = ry;
+            this->z = rz;
+            this->w = rw;
             return *this;
         }
 
-        float magnitude() const
+        constexpr T magnitude() const
         {
             return sqrt(x * x + y * y + z * z + w * w);
         }
 
         // Normalize the quaternion
-        quaternion<T>& normalize()
+        constexpr quaternion<T>& normalize()
         {
-            float mag = magnitude();
-            if (mag > 0.0f)
+            T mag = magnitude();
+            if (mag > 0)
             {
-                float inverse_magnitude = inverse(mag);
+                T inverse_magnitude = inverse(mag);
                 x *= inverse_magnitude;
                 y *= inverse_magnitude;
                 z *= inverse_magnitude;
@@ -1589,16 +2894,15 @@ namespace gem {
             return *this;
         }
 
-        quaternion<T> normalized() const
+        constexpr quaternion<T> normalized() const
         {
-            float mag = magnitude();
             quaternion<T> q(this->x, this->y, this->z, this->w);
             q.normalize();
 
             return q;
         }
 
-        quaternion<T>& conjugate()
+        constexpr quaternion<T>& conjugate()
         {
             x = -x;
             y = -y;
@@ -1607,45 +2911,98 @@ namespace gem {
             return *this;
         }
 
-        quaternion<T> conjugated() const
+        constexpr quaternion<T> conjugated() const
         {
             return quaternion<T>(-x, -y, -z, w);
         }
 
-        mat4<T> to_mat4() const
+        constexpr T dot(const quaternion<T>& other) const
         {
-            // Normalize the quaternion first
-            quaternion<T> q = *this;
-            q.normalize();
+            return x * other.x + y * other.y + z * other.z + w * other.w;
+        }
+
+        // Rotates a vector by a unit quaternion: v + w * t + cross(u, t), with u = (x, y, z) and t = 2 * cross(u, v)
+        constexpr vec3<T> rotate(const vec3<T>& vec) const
+        {
+            T tx = 2 * (y * vec.z - z * vec.y);
+            T ty = 2 * (z * vec.x - x * vec.z);
+            T tz = 2 * (x * vec.y - y * vec.x);
+
+            return vec3<T>(
+                vec.x + w * tx + (y * tz - z * ty),
+                vec.y + w * ty + (z * tx - x * tz),
+                vec.z + w * tz + (x * ty - y * tx));
+        }
+
+        // Interpolation between unit quaternions, always along the shortest path, results are normalized
+        // nlerp: cheapest, speed along the arc is not constant
+        static constexpr quaternion<T> nlerp(const quaternion<T>& a, const quaternion<T>& b, T t)
+        {
+            T sign = a.dot(b) < 0 ? static_cast<T>(-1) : static_cast<T>(1);
+            return blend(a, b, 1 - t, t * sign);
+        }
+
+        // slerp: exact, constant angular speed
+        static quaternion<T> slerp(const quaternion<T>& a, const quaternion<T>& b, T t)
+        {
+            T d = a.dot(b);
+            T sign = d < 0 ? static_cast<T>(-1) : static_cast<T>(1);
+            d = d * sign;
+
+            T wa = 1 - t;
+            T wb = t;
+            // Nearly parallel, sin(theta) is too small to divide by and nlerp is already exact enough
+            if (d < static_cast<T>(0.9995))
+            {
+                T theta = std::acos(d);
+                T inv_sin = 1 / std::sin(theta);
+                wa = std::sin(wa * theta) * inv_sin;
+                wb = std::sin(t * theta) * inv_sin;
+            }
+
+            return blend(a, b, wa, wb * sign);
+        }
 
-            // Extract the components of the quaternion
-            float x = q.x;
-            float y = q.y;
-            float z = q.z;
-            float w = q.w;
-
-            // Compute the elements of the matrix
-            float xx = x * x;
-            float xy = x * y;
-            float xz = x * z;
-            float xw = x * w;
-            float yy = y * y;
-            float yz = y * z;
-            float yw = y * w;
-            float zz = z * z;
-            float zw = z * w;
-
-            // Construct the matrix
-            mat4<T> mat(1.0f);
-            mat.elements[0 + 0 * 4] = 1 - 2 * (yy + zz);
-            mat.elements[0 + 1 * 4] = 2 * (xy - zw);
-            mat.elements[0 + 2 * 4] = 2 * (xz + yw);
-            mat.elements[1 + 0 * 4] = 2 * (xy + zw);
-            mat.elements[1 + 1 * 4] = 1 - 2 * (xx + zz);
-            mat.elements[1 + 2 * 4] = 2 * (yz - xw);
-            mat.elements[2 + 0 * 4] = 2 * (xz - yw);
-            mat.elements[2 + 1 * 4] = 2 * (yz + xw);
-            mat.elements[2 + 2 * 4] = 1 - 2 * (xx + yy);
+        // slerp_fast: nlerp with a corrected weight, no trigonometry, within 2e-3 rad of slerp (see bench/quaternion.cpp)
+        static quaternion<T> slerp_fast(const quaternion<T>& a, const quaternion<T>& b, T t)
+        {
+            T d = a.dot(b);
+            T sign = d < 0 ? static_cast<T>(-1) : static_cast<T>(1);
+            d = d * sign;
+
+            T ft = detail::slerp_fast_weight(simd::scalar<T>{ t }, simd::scalar<T>{ d }).v;
+            return blend(a, b, 1 - ft, ft * sign);
+        }
+
+        // Rotation matrix, same convention as mat4::rotation and rotate()
+        constexpr mat4<T> to_mat4() const
+        {
+            return normalized().to_mat4_unit();
+        }
+
+        // to_mat4 for quaternions already known to be unit, skips the normalization
+        constexpr mat4<T> to_mat4_unit() const
+        {
+            T xx = x * x;
+            T xy = x * y;
+            T xz = x * z;
+            T xw = x * w;
+            T yy = y * y;
+            T yz = y * z;
+            T yw = y * w;
+            T zz = z * z;
+            T zw = z * w;
+
+            mat4<T> mat(static_cast<T>(1));
+            mat.elements[0 * 4 + 0] = 1 - 2 * (yy + zz);
+            mat.elements[0 * 4 + 1] = 2 * (xy - zw);
+            mat.elements[0 * 4 + 2] = 2 * (xz + yw);
+            mat.elements[1 * 4 + 0] = 2 * (xy + zw);
+            mat.elements[1 * 4 + 1] = 1 - 2 * (xx + zz);
+            mat.elements[1 * 4 + 2] = 2 * (yz - xw);
+            mat.elements[2 * 4 + 0] = 2 * (xz - yw);
+            mat.elements[2 * 4 + 1] = 2 * (yz + xw);
+            mat.elements[2 * 4 + 2] = 1 - 2 * (xx + yy);
 
             return mat;
         }
@@ -1655,55 +3012,84 @@ namespace gem {
             vec3<T> euler;
 
             // roll (x-axis rotation)
-            float sinr_cosp = 2.0f * (w * x + y * z);
-            float cosr_cosp = 1.0f - 2.0f * (x * x + y * y);
+            T sinr_cosp = 2 * (w * x + y * z);
+            T cosr_cosp = 1 - 2 * (x * x + y * y);
             euler.x = std::atan2(sinr_cosp, cosr_cosp);
 
             // pitch (y-axis rotation)
-            float sinp = 2.0f * (w * y - z * x);
-            if (std::abs(sinp) >= 1.0f) {
-              euler.y = std::copysign(GEM_PI * 0.5f, sinp); // use 90 degrees if out of range
+            T sinp = 2 * (w * y - z * x);
+            if (std::abs(sinp) >= 1) {
+              euler.y = std::copysign(pi<T>() * static_cast<T>(0.5), sinp); // use 90 degrees if out of range
             } else {
                 euler.y = std::asin(sinp);
             }
 
             // yaw (z-axis rotation)
-            float siny_cosp = 2.0f * (w * z + x * y);
-            float cosy_cosp = 1.0f - 2.0f * (y * y + z * z);
+            T siny_cosp = 2 * (w * z + x * y);
+            T cosy_cosp = 1 - 2 * (y * y + z * z);
             euler.z = std::atan2(siny_cosp, cosy_cosp);
 
             return euler;
         }
 
         // Operators
-        friend quaternion<T> operator+(quaternion<T> left, const quaternion<T>& right)
+        friend constexpr quaternion<T> operator+(quaternion<T> left, const quaternion<T>& right)
         {
             return left.add(right);
         }
 
 
-        friend quaternion<T> operator-(quaternion<T> left, const quaternion<T>& right)
+        friend constexpr quaternion<T> operator-(quaternion<T> left, const quaternion<T>& right)
         {
             return left.substract(right);
         }
 
-        friend quaternion<T> operator*(quaternion left, const quaternion<T>& right)
+        friend constexpr quaternion<T> operator*(quaternion left, const quaternion<T>& right)
         {
             return left.multiply(right);
         }
 
-        std::string to_string() const
-        {
-            return std::format("({}, {}, {}, {})", this->x, this->y, this->z, this->w);
-        }
-
-        friend std::ostream& operator<<(std::ostream& os, const quaternion<T>& quat)
+    private:
+        // Normalized a * wa + b * wb, shared by the interpolations
+        static constexpr quaternion<T> blend(const quaternion<T>& a, const quaternion<T>& b, T wa, T wb)
         {
-            os << quat.to_string();
-            return os;
+            T rx = a.x * wa + b.x * wb;
+            T ry = a.y * wa + b.y * wb;
+            T rz = a.z * wa + b.z * wb;
+            T rw = a.w * wa + b.w * wb;
+            T inv = 1 / sqrt(rx * rx + ry * ry + rz * rz + rw * rw);
+            return quaternion<T>(rx * inv, ry * inv, rz * inv, rw * inv);
         }
     };
 
+    // Explicit instantiation
+    // Define GEM_IMPLEMENTATION in exactly one translation unit (see src/gem_math.cpp) to emit the
+    // float and double instantiations there, and GEM_EXTERN_TEMPLATES everywhere else so the other
+    // translation units reuse them instead of instantiating every member again
+#if defined(GEM_IMPLEMENTATION)
+    #define GEM_INSTANTIATE template
+#elif defined(GEM_EXTERN_TEMPLATES)
+    #define GEM_INSTANTIATE extern template
+#endif
+
+#ifdef GEM_INSTANTIATE
+    GEM_INSTANTIATE struct vec2<float>;
+    GEM_INSTANTIATE struct vec3<float>;
+    GEM_INSTANTIATE struct vec4<float>;
+    GEM_INSTANTIATE struct mat4<float>;
+    GEM_INSTANTIATE struct affine3<float>;
+    GEM_INSTANTIATE struct quaternion<float>;
+
+    GEM_INSTANTIATE struct vec2<double>;
+    GEM_INSTANTIATE struct vec3<double>;
+    GEM_INSTANTIATE struct vec4<double>;
+    GEM_INSTANTIATE struct mat4<double>;
+    GEM_INSTANTIATE struct affine3<double>;
+    GEM_INSTANTIATE struct quaternion<double>;
+
+    #undef GEM_INSTANTIATE
+#endif
+
 }
 
 #endif // GEM_MATH_HPP
@@ -0,0 +1,356 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_PARALLEL_HPP
+#define GEM_PARALLEL_HPP
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Job system
+// A pool of worker threads shared by every batch of gem (bulk, batch, color, culling and grid builds) and by
+// gem::parallel_for. Work is cut into chunks, each participant starts on its own contiguous run of chunks and
+// idle participants steal single chunks from the back of the others' runs, so uneven chunks still finish together.
+// Workers are started on first use, as many as the largest request so far asks for, and sleep between jobs.
+// One job runs at a time: a batch started while another thread's job is running, or from inside a job, runs on
+// its own thread. No function given to the job system may throw
+namespace gem {
+
+    // Execution policies, the trailing argument of every threaded batch
+    // seq runs on the calling thread. par and par_unseq split large batches over threads, up to threads of them
+    // (0 uses every hardware thread). The kernels are SIMD and call no user code per element, so both mean the same.
+    // Results never depend on the policy
+    namespace execution {
+
+        struct sequenced_policy
+        {
+        };
+
+        struct parallel_policy
+        {
+            std::uint32_t threads = 0;
+        };
+
+        struct parallel_unsequenced_policy
+        {
+            std::uint32_t threads = 0;
+        };
+
+        inline constexpr sequenced_policy seq{};
+        inline constexpr parallel_policy par{};
+        inline constexpr parallel_unsequenced_policy par_unseq{};
+
+        // Any policy as a thread budget, 1 for seq
+        struct policy
+        {
+            std::uint32_t threads = 1;
+
+            constexpr policy(sequenced_policy)
+            {
+            }
+
+            constexpr policy(parallel_policy p)
+                : threads(p.threads)
+            {
+            }
+
+            constexpr policy(parallel_unsequenced_policy p)
+                : threads(p.threads)
+            {
+            }
+        };
+
+    }
+
+    namespace detail {
+
+        // Chunks [begin, end) left to one participant, packed in 64 bits so both ends move with one compare exchange.
+        // The owner takes chunks from the front and thieves from the back, on separate cache lines per participant
+        struct alignas(64) job_queue
+        {
+            std::atomic<std::uint64_t> range{ 0 };
+
+            void reset(std::uint32_t begin, std::uint32_t end)
+            {
+                range.store((static_cast<std::uint64_t>(begin) << 32) | end, std::memory_order_relaxed);
+            }
+
+            bool pop_front(std::uint32_t& chunk)
+            {
+                std::uint64_t r = range.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    std::uint32_t begin = static_cast<std::uint32_t>(r >> 32), end = static_cast<std::uint32_t>(r);
+                    if (begin >= end)
+                        return false;
+                    if (range.compare_exchange_weak(r, (static_cast<std::uint64_t>(begin + 1) << 32) | end, std::memory_order_relaxed))
+                    {
+                        chunk = begin;
+                        return true;
+                    }
+                }
+            }
+
+            bool pop_back(std::uint32_t& chunk)
+            {
+                std::uint64_t r = range.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    std::uint32_t begin = static_cast<std::uint32_t>(r >> 32), end = static_cast<std::uint32_t>(r);
+                    if (begin >= end)
+                        return false;
+                    if (range.compare_exchange_weak(r, (static_cast<std::uint64_t>(begin) << 32) | (end - 1), std::memory_order_relaxed))
+                    {
+                        chunk = end - 1;
+                        return true;
+                    }
+                }
+            }
+        };
+
+        // One parallel loop, run(function, chunk) for every chunk in [0, chunks)
+        struct job
+        {
+            void (*run)(void* function, std::size_t chunk);
+            void* function;
+            std::uint32_t chunks;
+            std::uint32_t participants;
+            job_queue* queues = nullptr;
+            std::atomic<std::uint32_t> finished{ 0 };
+        };
+
+        class job_system
+        {
+        public:
+            // Most threads one job uses, the calling thread included
+            static constexpr std::uint32_t max_participants = 256;
+
+            static job_system& instance()
+            {
+                static job_system system;
+                return system;
+            }
+
+            static std::uint32_t hardware_threads()
+            {
+                static const std::uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+                return threads;
+            }
+
+            job_system(const job_system&) = delete;
+            job_system& operator=(const job_system&) = delete;
+
+            ~job_system()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stop = true;
+                }
+                m_wake.notify_all();
+                for (std::thread& worker : m_workers)
+                    worker.join();
+            }
+
+            // Returns once every chunk of work is done, the calling thread is participant 0
+            void run(job& work)
+            {
+                std::unique_lock<std::mutex> busy(m_busy, std::defer_lock);
+                if (t_in_job || work.participants <= 1 || !busy.try_lock())
+                {
+                    run_inline(work);
+                    return;
+                }
+
+                t_in_job = true;
+                reserve(work.participants - 1);
+                work.queues = m_queues.get();
+                for (std::uint32_t p = 0; p < work.participants; p++)
+                {
+                    std::uint32_t begin = static_cast<std::uint32_t>(static_cast<std::uint64_t>(work.chunks) * p / work.participants);
+                    std::uint32_t end = static_cast<std::uint32_t>(static_cast<std::uint64_t>(work.chunks) * (p + 1) / work.participants);
+                    work.queues[p].reset(begin, end);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_job = &work;
+                    m_generation++;
+                }
+                m_wake.notify_all();
+
+                participate(work, 0);
+                while (work.finished.load(std::memory_order_acquire) < work.chunks)
+                    std::this_thread::yield();
+
+                // No worker may still hold the job once it leaves this frame
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_job = nullptr;
+                }
+                while (m_active.load(std::memory_order_acquire) != 0)
+                    std::this_thread::yield();
+                t_in_job = false;
+            }
+
+        private:
+            job_system()
+                : m_queues(new job_queue[max_participants])
+            {
+            }
+
+            static void run_inline(job& work)
+            {
+                for (std::uint32_t chunk = 0; chunk < work.chunks; chunk++)
+                    work.run(work.function, chunk);
+            }
+
+            static void execute(job& work, std::uint32_t chunk)
+            {
+                work.run(work.function, chunk);
+                work.finished.fetch_add(1, std::memory_order_release);
+            }
+
+            // Own chunks first, then steal from the others, starting with the next participant
+            static void participate(job& work, std::uint32_t self)
+            {
+                std::uint32_t chunk;
+                while (work.queues[self].pop_front(chunk))
+                    execute(work, chunk);
+
+                for (std::uint32_t k = 1; k < work.participants;)
+                {
+                    if (work.queues[(self + k) % work.participants].pop_back(chunk))
+                        execute(work, chunk);
+                    else
+                        k++;
+                }
+            }
+
+            // Starts workers until there are at least count, only called between jobs
+            void reserve(std::uint32_t count)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                while (m_workers.size() < count)
+                {
+                    std::uint32_t index = static_cast<std::uint32_t>(m_workers.size()) + 1;
+                    m_workers.emplace_back([this, index, seen = m_generation] { work_loop(index, seen); });
+                }
+            }
+
+            void work_loop(std::uint32_t index, std::uint64_t seen)
+            {
+                // Batches started from inside a chunk run inline
+                t_in_job = true;
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                for (;;)
+                {
+                    m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+                    if (m_stop)
+                        return;
+
+                    seen = m_generation;
+                    job* work = m_job;
+                    if (!work || index >= work->participants)
+                        continue;
+
+                    m_active.fetch_add(1, std::memory_order_relaxed);
+                    lock.unlock();
+                    participate(*work, index);
+                    m_active.fetch_sub(1, std::memory_order_release);
+                    lock.lock();
+                }
+            }
+
+            static inline thread_local bool t_in_job = false;
+
+            std::mutex m_busy;                      // held by the thread whose job is running
+            std::mutex m_mutex;                     // guards m_job, m_generation, m_stop and m_workers
+            std::condition_variable m_wake;
+            job* m_job = nullptr;
+            std::uint64_t m_generation = 0;
+            bool m_stop = false;
+            std::atomic<std::uint32_t> m_active{ 0 }; // workers inside the current job
+            std::unique_ptr<job_queue[]> m_queues;
+            std::vector<std::thread> m_workers;
+        };
+
+        inline std::uint32_t thread_budget(execution::policy policy)
+        {
+            return policy.threads == 0 ? job_system::hardware_threads() : policy.threads;
+        }
+
+    }
+
+    // function(begin, end) on chunks of grain items covering [0, count), on the job system workers and the calling thread
+    // Every range starts at a multiple of grain. With one thread (seq, or a single chunk) function(0, count) is called once
+    template<typename Function>
+    void parallel_for(std::size_t count, std::size_t grain, Function&& function, execution::policy policy = execution::par)
+    {
+        // Chunk indices are 32-bit
+        constexpr std::size_t max_chunks = std::numeric_limits<std::uint32_t>::max();
+        grain = std::max<std::size_t>({ grain, 1, (count + max_chunks - 1) / max_chunks });
+        std::size_t chunks = (count + grain - 1) / grain;
+
+        std::size_t participants = std::min<std::size_t>({ detail::thread_budget(policy), chunks, detail::job_system::max_participants });
+        if (participants <= 1)
+        {
+            if (count != 0)
+                function(std::size_t(0), count);
+            return;
+        }
+
+        auto chunk_function = [&](std::size_t chunk) {
+            std::size_t begin = chunk * grain;
+            function(begin, std::min(count, begin + grain));
+        };
+        detail::job work{ [](void* f, std::size_t chunk) { (*static_cast<decltype(chunk_function)*>(f))(chunk); }, &chunk_function,
+                          static_cast<std::uint32_t>(chunks), static_cast<std::uint32_t>(participants) };
+        detail::job_system::instance().run(work);
+    }
+
+    namespace detail {
+
+        // Bytes of data per chunk of a batch, in and out together, small enough to stay in L2 while a thread works on it
+        inline constexpr std::size_t job_chunk_bytes = 1 << 16;
+
+        // Batches below this many bytes run on the calling thread, waking workers would cost more than it saves
+        inline constexpr std::size_t job_parallel_bytes = 1 << 20;
+
+        // Items per chunk of about job_chunk_bytes, a multiple of granularity
+        inline std::size_t chunk_items(std::size_t item_bytes, std::size_t granularity)
+        {
+            std::size_t grain = std::max<std::size_t>(1, job_chunk_bytes / std::max<std::size_t>(1, item_bytes));
+            return (grain + granularity - 1) / granularity * granularity;
+        }
+
+        inline bool worth_splitting(std::size_t count, std::size_t item_bytes)
+        {
+            return count * item_bytes >= job_parallel_bytes;
+        }
+
+        // function(begin, end) over chunks of chunk_items(item_bytes, granularity) items, item_bytes is the data
+        // read and written per item
+        template<typename Function>
+        void parallel_batch(std::size_t count, std::size_t item_bytes, std::size_t granularity, execution::policy policy, Function&& function)
+        {
+            if (!worth_splitting(count, item_bytes))
+                policy = execution::seq;
+            parallel_for(count, chunk_items(item_bytes, granularity), function, policy);
+        }
+
+    }
+
+}
+
+#endif // GEM_PARALLEL_HPP
@@ -0,0 +1,767 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_SIMD_HPP
+#define GEM_SIMD_HPP
+
+#include "gem_base.hpp"
+
+// std
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Helpers shared by the SIMD kernels
+namespace gem::simd {
+
+    // True when T has SIMD storage and kernels, vec4<T> and mat4<T> are then 16-byte aligned
+    template<typename T>
+    inline constexpr bool enabled =
+#if defined(GEM_SSE)
+        std::is_same_v<T, float>;
+#else
+        false;
+#endif
+
+    template<typename T>
+    inline constexpr std::size_t alignment = std::is_same_v<T, float> ? 16 : alignof(T);
+
+#if defined(GEM_SSE)
+    // Sums the 4 lanes as ((v0 + v1) + v2) + v3, the same order as the scalar code
+    inline float horizontal_add(__m128 v)
+    {
+        __m128 sum = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+        return _mm_cvtss_f32(sum);
+    }
+
+    // Loads 4 packed vec3<float> (12 floats) and splits them into x, y and z lanes
+    inline void load_vec3x4(const float* src, __m128& x, __m128& y, __m128& z)
+    {
+        __m128 a = _mm_loadu_ps(src + 0); // x0 y0 z0 x1
+        __m128 b = _mm_loadu_ps(src + 4); // y1 z1 x2 y2
+        __m128 c = _mm_loadu_ps(src + 8); // z2 x3 y3 z3
+
+        __m128 bc = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+        x = _mm_shuffle_ps(a, bc, _MM_SHUFFLE(2, 0, 3, 0));
+
+        __m128 ab = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+        bc = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+        y = _mm_shuffle_ps(ab, bc, _MM_SHUFFLE(2, 0, 2, 0));
+
+        ab = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+        z = _mm_shuffle_ps(ab, c, _MM_SHUFFLE(3, 0, 2, 0));
+    }
+
+    // Inverse of load_vec3x4, interleaves x, y and z lanes back into 4 packed vec3<float>
+    inline void store_vec3x4(float* dst, __m128 x, __m128 y, __m128 z)
+    {
+        __m128 t = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0));
+        __m128 u = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+        _mm_storeu_ps(dst + 0, _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0)));
+
+        t = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+        u = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+        _mm_storeu_ps(dst + 4, _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0)));
+
+        t = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+        u = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+        _mm_storeu_ps(dst + 8, _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+#endif
+
+#if defined(GEM_AVX2)
+    // Loads 4 packed vec3<double> (12 doubles) and splits them into x, y and z lanes
+    inline void load_vec3x4(const double* src, __m256d& x, __m256d& y, __m256d& z)
+    {
+        __m256d a = _mm256_loadu_pd(src + 0); // x0 y0 z0 x1
+        __m256d b = _mm256_loadu_pd(src + 4); // y1 z1 x2 y2
+        __m256d c = _mm256_loadu_pd(src + 8); // z2 x3 y3 z3
+
+        x = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(a, b, 0b0100), c, 0b0010), _MM_SHUFFLE(1, 2, 3, 0));
+        y = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(a, b, 0b1001), c, 0b0100), _MM_SHUFFLE(2, 3, 0, 1));
+        z = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(a, b, 0b0010), c, 0b1001), _MM_SHUFFLE(3, 0, 1, 2));
+    }
+
+    // Inverse of load_vec3x4
+    inline void store_vec3x4(double* dst, __m256d x, __m256d y, __m256d z)
+    {
+        __m256d px = _mm256_permute4x64_pd(x, _MM_SHUFFLE(1, 2, 3, 0)); // x0 x3 x2 x1
+        __m256d py = _mm256_permute4x64_pd(y, _MM_SHUFFLE(2, 3, 0, 1)); // y1 y0 y3 y2
+        __m256d pz = _mm256_permute4x64_pd(z, _MM_SHUFFLE(3, 0, 1, 2)); // z2 z1 z0 z3
+
+        _mm256_storeu_pd(dst + 0, _mm256_blend_pd(_mm256_blend_pd(px, py, 0b0010), pz, 0b0100));
+        _mm256_storeu_pd(dst + 4, _mm256_blend_pd(_mm256_blend_pd(px, py, 0b1001), pz, 0b0010));
+        _mm256_storeu_pd(dst + 8, _mm256_blend_pd(_mm256_blend_pd(px, py, 0b0100), pz, 0b1001));
+    }
+
+    // In place transpose of 4 rows of 4 doubles
+    inline void transpose4(__m256d& r0, __m256d& r1, __m256d& r2, __m256d& r3)
+    {
+        __m256d t0 = _mm256_unpacklo_pd(r0, r1); // r0[0] r1[0] r0[2] r1[2]
+        __m256d t1 = _mm256_unpackhi_pd(r0, r1); // r0[1] r1[1] r0[3] r1[3]
+        __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+        r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+        r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+        r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+        r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+    }
+#endif
+
+    // Bit trick 1 / sqrt(x) estimate refined by two Newton steps, relative error below 4.7e-6 for x > 0
+    // Used where no hardware estimate exists (double, or float without SSE)
+    template<typename T>
+    inline T rsqrt_bits(T x)
+    {
+        T y;
+        if constexpr (std::is_same_v<T, float>)
+            y = std::bit_cast<float>(0x5F375A86u - (std::bit_cast<std::uint32_t>(x) >> 1));
+        else
+            y = std::bit_cast<double>(0x5FE6EB50C7B537A9ull - (std::bit_cast<std::uint64_t>(x) >> 1));
+
+        T half = x * static_cast<T>(0.5);
+        y = y * (static_cast<T>(1.5) - half * y * y);
+        y = y * (static_cast<T>(1.5) - half * y * y);
+        return y;
+    }
+
+    // Bit trick 1 / x estimate refined by two Newton steps, relative error below 6.7e-6 for normal x with a normal
+    // reciprocal, of either sign. Used where no hardware estimate exists (double, or float without SSE)
+    template<typename T>
+    inline T rcp_bits(T x)
+    {
+        T y;
+        if constexpr (std::is_same_v<T, float>)
+        {
+            std::uint32_t b = std::bit_cast<std::uint32_t>(x);
+            y = std::bit_cast<float>((0x7EF311C3u - (b & 0x7FFFFFFFu)) | (b & 0x80000000u));
+        }
+        else
+        {
+            std::uint64_t b = std::bit_cast<std::uint64_t>(x);
+            y = std::bit_cast<double>((0x7FDE623822FC16E6ull - (b & 0x7FFFFFFFFFFFFFFFull)) | (b & 0x8000000000000000ull));
+        }
+
+        y = y * (static_cast<T>(2) - x * y);
+        y = y * (static_cast<T>(2) - x * y);
+        return y;
+    }
+
+    // Exponent and mantissa fields, for log2 and exp2 kernels
+    // exponent_bits and mantissa_bits split a positive normal x into 2^e * m with m in [1, 2),
+    // pow2_bits builds 2^n for an integer valued n in the normal exponent range
+    template<typename T>
+    inline T exponent_bits(T x)
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return static_cast<T>(static_cast<int32>(std::bit_cast<std::uint32_t>(x) >> 23) - 127);
+        else
+            return static_cast<T>(static_cast<int32>(std::bit_cast<std::uint64_t>(x) >> 52) - 1023);
+    }
+
+    template<typename T>
+    inline T mantissa_bits(T x)
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return std::bit_cast<float>((std::bit_cast<std::uint32_t>(x) & 0x007FFFFFu) | 0x3F800000u);
+        else
+            return std::bit_cast<double>((std::bit_cast<std::uint64_t>(x) & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull);
+    }
+
+    template<typename T>
+    inline T pow2_bits(T n)
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return std::bit_cast<float>(static_cast<std::uint32_t>(static_cast<int32>(n) + 127) << 23);
+        else
+            return std::bit_cast<double>(static_cast<std::uint64_t>(static_cast<int32>(n) + 1023) << 52);
+    }
+
+    // Lane packs
+    // scalar<T>, f32x4 / f64x2 (SSE) and f32x8 / f64x4 (AVX2) share one interface, so a batch kernel is written once
+    // as a template over the pack type and runs both the SIMD body and the scalar tail. No FMA is used,
+    // every width gives the same results for the same operations
+    struct scalar_mask
+    {
+        bool v;
+        // No short circuit, masks of data dependent compares would turn into branches
+        friend scalar_mask operator&(scalar_mask a, scalar_mask b) { return { (a.v & b.v) != 0 }; }
+        friend scalar_mask operator|(scalar_mask a, scalar_mask b) { return { (a.v | b.v) != 0 }; }
+        friend int32 bits(scalar_mask mask) { return mask.v ? 1 : 0; }
+    };
+
+    template<typename T>
+    struct scalar
+    {
+        using value_type = T;
+        using mask_type = scalar_mask;
+        static constexpr std::size_t width = 1;
+
+        T v;
+
+        static scalar load(const T* src) { return { *src }; }
+        static scalar broadcast(T value) { return { value }; }
+        void store(T* dst) const { *dst = v; }
+
+        friend scalar operator+(scalar a, scalar b) { return { a.v + b.v }; }
+        friend scalar operator-(scalar a, scalar b) { return { a.v - b.v }; }
+        friend scalar operator*(scalar a, scalar b) { return { a.v * b.v }; }
+        friend scalar operator/(scalar a, scalar b) { return { a.v / b.v }; }
+        friend scalar operator-(scalar a) { return { -a.v }; }
+
+        friend scalar_mask operator<(scalar a, scalar b) { return { a.v < b.v }; }
+        friend scalar_mask operator<=(scalar a, scalar b) { return { a.v <= b.v }; }
+        friend scalar_mask operator>(scalar a, scalar b) { return { a.v > b.v }; }
+        friend scalar_mask operator>=(scalar a, scalar b) { return { a.v >= b.v }; }
+
+        friend scalar min(scalar a, scalar b) { return { a.v < b.v ? a.v : b.v }; }
+        friend scalar max(scalar a, scalar b) { return { a.v > b.v ? a.v : b.v }; }
+        friend scalar sqrt(scalar a) { return { std::sqrt(a.v) }; }
+        friend scalar abs(scalar a) { return { std::abs(a.v) }; }
+        // Bitwise blend for floating point, like the SIMD packs, so selecting on data dependent masks does not branch
+        friend scalar select(scalar_mask mask, scalar a, scalar b)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                using U = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+                U m = U(0) - static_cast<U>(mask.v);
+                return { std::bit_cast<T>((std::bit_cast<U>(a.v) & m) | (std::bit_cast<U>(b.v) & ~m)) };
+            }
+            else
+            {
+                return mask.v ? a : b;
+            }
+        }
+
+        // 1 / sqrt(a) estimate, same value as the matching SIMD pack lane
+        friend scalar rsqrt_estimate(scalar a)
+        {
+#if defined(GEM_SSE)
+            if constexpr (std::is_same_v<T, float>)
+                return { _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(a.v))) };
+#endif
+            return { rsqrt_bits(a.v) };
+        }
+
+        // 1 / a estimate, same value as the matching SIMD pack lane
+        friend scalar rcp_estimate(scalar a)
+        {
+#if defined(GEM_SSE)
+            if constexpr (std::is_same_v<T, float>)
+                return { _mm_cvtss_f32(_mm_rcp_ss(_mm_set_ss(a.v))) };
+#endif
+            return { rcp_bits(a.v) };
+        }
+
+        // See exponent_bits, mantissa_bits and pow2_bits
+        friend scalar exponent(scalar a) { return { exponent_bits(a.v) }; }
+        friend scalar mantissa(scalar a) { return { mantissa_bits(a.v) }; }
+        friend scalar pow2(scalar n) { return { pow2_bits(n.v) }; }
+
+        // Writes (a, b, c, d) of lane l to dst + l * stride, turns 4 SoA streams into AoS records
+        static void store_interleaved4(T* dst, std::size_t, scalar a, scalar b, scalar c, scalar d)
+        {
+            dst[0] = a.v;
+            dst[1] = b.v;
+            dst[2] = c.v;
+            dst[3] = d.v;
+        }
+
+        // Reads lane l of (a, b, c, d) from src + l * stride, the inverse of store_interleaved4
+        static void load_interleaved4(const T* src, std::size_t, scalar& a, scalar& b, scalar& c, scalar& d)
+        {
+            a.v = src[0];
+            b.v = src[1];
+            c.v = src[2];
+            d.v = src[3];
+        }
+
+        // Packed records of 2 and 3 components (vec2 and vec3 arrays), width records from src or to dst
+        static void load_interleaved2(const T* src, scalar& a, scalar& b)
+        {
+            a.v = src[0];
+            b.v = src[1];
+        }
+
+        static void store_interleaved2(T* dst, scalar a, scalar b)
+        {
+            dst[0] = a.v;
+            dst[1] = b.v;
+        }
+
+        static void load_interleaved3(const T* src, scalar& a, scalar& b, scalar& c)
+        {
+            a.v = src[0];
+            b.v = src[1];
+            c.v = src[2];
+        }
+
+        static void store_interleaved3(T* dst, scalar a, scalar b, scalar c)
+        {
+            dst[0] = a.v;
+            dst[1] = b.v;
+            dst[2] = c.v;
+        }
+    };
+
+#if defined(GEM_SSE)
+    struct f32x4
+    {
+        using value_type = float;
+        struct mask_type
+        {
+            __m128 v;
+            friend mask_type operator&(mask_type a, mask_type b) { return { _mm_and_ps(a.v, b.v) }; }
+            friend mask_type operator|(mask_type a, mask_type b) { return { _mm_or_ps(a.v, b.v) }; }
+        };
+        static constexpr std::size_t width = 4;
+
+        __m128 v;
+
+        static f32x4 load(const float* src) { return { _mm_loadu_ps(src) }; }
+        static f32x4 broadcast(float value) { return { _mm_set1_ps(value) }; }
+        void store(float* dst) const { _mm_storeu_ps(dst, v); }
+
+        friend f32x4 operator+(f32x4 a, f32x4 b) { return { _mm_add_ps(a.v, b.v) }; }
+        friend f32x4 operator-(f32x4 a, f32x4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+        friend f32x4 operator*(f32x4 a, f32x4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+        friend f32x4 operator/(f32x4 a, f32x4 b) { return { _mm_div_ps(a.v, b.v) }; }
+        friend f32x4 operator-(f32x4 a) { return { _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)) }; }
+
+        friend mask_type operator<(f32x4 a, f32x4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+        friend mask_type operator<=(f32x4 a, f32x4 b) { return { _mm_cmple_ps(a.v, b.v) }; }
+        friend mask_type operator>(f32x4 a, f32x4 b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+        friend mask_type operator>=(f32x4 a, f32x4 b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+
+        friend f32x4 min(f32x4 a, f32x4 b) { return { _mm_min_ps(a.v, b.v) }; }
+        friend f32x4 max(f32x4 a, f32x4 b) { return { _mm_max_ps(a.v, b.v) }; }
+        friend f32x4 sqrt(f32x4 a) { return { _mm_sqrt_ps(a.v) }; }
+        friend f32x4 abs(f32x4 a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+        friend f32x4 select(mask_type mask, f32x4 a, f32x4 b) { return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) }; }
+        friend f32x4 rsqrt_estimate(f32x4 a) { return { _mm_rsqrt_ps(a.v) }; }
+        friend f32x4 rcp_estimate(f32x4 a) { return { _mm_rcp_ps(a.v) }; }
+        friend int32 bits(mask_type mask) { return _mm_movemask_ps(mask.v); }
+        friend f32x4 exponent(f32x4 a) { return { _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(a.v), 23), _mm_set1_epi32(127))) }; }
+        friend f32x4 mantissa(f32x4 a) { return { _mm_or_ps(_mm_and_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(0x007FFFFF))), _mm_set1_ps(1.0f)) }; }
+        friend f32x4 pow2(f32x4 n) { return { _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n.v), _mm_set1_epi32(127)), 23)) }; }
+
+        static void store_interleaved4(float* dst, std::size_t stride, f32x4 a, f32x4 b, f32x4 c, f32x4 d)
+        {
+            _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+            _mm_storeu_ps(dst, a.v);
+            _mm_storeu_ps(dst + stride, b.v);
+            _mm_storeu_ps(dst + 2 * stride, c.v);
+            _mm_storeu_ps(dst + 3 * stride, d.v);
+        }
+
+        static void load_interleaved4(const float* src, std::size_t stride, f32x4& a, f32x4& b, f32x4& c, f32x4& d)
+        {
+            a.v = _mm_loadu_ps(src);
+            b.v = _mm_loadu_ps(src + stride);
+            c.v = _mm_loadu_ps(src + 2 * stride);
+            d.v = _mm_loadu_ps(src + 3 * stride);
+            _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+        }
+
+        static void load_interleaved2(const float* src, f32x4& a, f32x4& b)
+        {
+            __m128 r0 = _mm_loadu_ps(src), r1 = _mm_loadu_ps(src + 4); // a0 b0 a1 b1, a2 b2 a3 b3
+            a.v = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(2, 0, 2, 0));
+            b.v = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+
+        static void store_interleaved2(float* dst, f32x4 a, f32x4 b)
+        {
+            _mm_storeu_ps(dst, _mm_unpacklo_ps(a.v, b.v));
+            _mm_storeu_ps(dst + 4, _mm_unpackhi_ps(a.v, b.v));
+        }
+
+        static void load_interleaved3(const float* src, f32x4& a, f32x4& b, f32x4& c)
+        {
+            load_vec3x4(src, a.v, b.v, c.v);
+        }
+
+        static void store_interleaved3(float* dst, f32x4 a, f32x4 b, f32x4 c)
+        {
+            store_vec3x4(dst, a.v, b.v, c.v);
+        }
+    };
+#endif
+
+#if defined(GEM_AVX2)
+    struct f32x8
+    {
+        using value_type = float;
+        struct mask_type
+        {
+            __m256 v;
+            friend mask_type operator&(mask_type a, mask_type b) { return { _mm256_and_ps(a.v, b.v) }; }
+            friend mask_type operator|(mask_type a, mask_type b) { return { _mm256_or_ps(a.v, b.v) }; }
+        };
+        static constexpr std::size_t width = 8;
+
+        __m256 v;
+
+        static f32x8 load(const float* src) { return { _mm256_loadu_ps(src) }; }
+        static f32x8 broadcast(float value) { return { _mm256_set1_ps(value) }; }
+        void store(float* dst) const { _mm256_storeu_ps(dst, v); }
+
+        friend f32x8 operator+(f32x8 a, f32x8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+        friend f32x8 operator-(f32x8 a, f32x8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+        friend f32x8 operator*(f32x8 a, f32x8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+        friend f32x8 operator/(f32x8 a, f32x8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+        friend f32x8 operator-(f32x8 a) { return { _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)) }; }
+
+        friend mask_type operator<(f32x8 a, f32x8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+        friend mask_type operator<=(f32x8 a, f32x8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+        friend mask_type operator>(f32x8 a, f32x8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+        friend mask_type operator>=(f32x8 a, f32x8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+
+        friend f32x8 min(f32x8 a, f32x8 b) { return { _mm256_min_ps(a.v, b.v) }; }
+        friend f32x8 max(f32x8 a, f32x8 b) { return { _mm256_max_ps(a.v, b.v) }; }
+        friend f32x8 sqrt(f32x8 a) { return { _mm256_sqrt_ps(a.v) }; }
+        friend f32x8 abs(f32x8 a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) }; }
+        friend f32x8 select(mask_type mask, f32x8 a, f32x8 b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+        friend f32x8 rsqrt_estimate(f32x8 a) { return { _mm256_rsqrt_ps(a.v) }; }
+        friend f32x8 rcp_estimate(f32x8 a) { return { _mm256_rcp_ps(a.v) }; }
+        friend int32 bits(mask_type mask) { return _mm256_movemask_ps(mask.v); }
+        friend f32x8 exponent(f32x8 a) { return { _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(a.v), 23), _mm256_set1_epi32(127))) }; }
+        friend f32x8 mantissa(f32x8 a) { return { _mm256_or_ps(_mm256_and_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(0x007FFFFF))), _mm256_set1_ps(1.0f)) }; }
+        friend f32x8 pow2(f32x8 n) { return { _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n.v), _mm256_set1_epi32(127)), 23)) }; }
+
+        static void store_interleaved4(float* dst, std::size_t stride, f32x8 a, f32x8 b, f32x8 c, f32x8 d)
+        {
+            f32x4::store_interleaved4(dst, stride, { _mm256_castps256_ps128(a.v) }, { _mm256_castps256_ps128(b.v) },
+                                      { _mm256_castps256_ps128(c.v) }, { _mm256_castps256_ps128(d.v) });
+            f32x4::store_interleaved4(dst + 4 * stride, stride, { _mm256_extractf128_ps(a.v, 1) }, { _mm256_extractf128_ps(b.v, 1) },
+                                      { _mm256_extractf128_ps(c.v, 1) }, { _mm256_extractf128_ps(d.v, 1) });
+        }
+
+        static void load_interleaved4(const float* src, std::size_t stride, f32x8& a, f32x8& b, f32x8& c, f32x8& d)
+        {
+            // Records l and l + 4 share a register, then a 4x4 transpose inside each 128-bit half
+            __m256 r[4];
+            for (int32 l = 0; l < 4; l++)
+                r[l] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + l * stride)), _mm_loadu_ps(src + (l + 4) * stride), 1);
+
+            __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+            __m256 t1 = _mm256_unpacklo_ps(r[2], r[3]);
+            __m256 t2 = _mm256_unpackhi_ps(r[0], r[1]);
+            __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+            a.v = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+            b.v = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+            c.v = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            d.v = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+
+        // Lanes of each 128-bit half hold records (0, 1, 4, 5) and (2, 3, 6, 7) after the shuffles,
+        // the 64-bit permute puts them back in order
+        static void load_interleaved2(const float* src, f32x8& a, f32x8& b)
+        {
+            __m256 r0 = _mm256_loadu_ps(src), r1 = _mm256_loadu_ps(src + 8);
+            a.v = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(r0, r1, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+            b.v = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+
+        static void store_interleaved2(float* dst, f32x8 a, f32x8 b)
+        {
+            __m256 pa = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(a.v), _MM_SHUFFLE(3, 1, 2, 0)));
+            __m256 pb = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(b.v), _MM_SHUFFLE(3, 1, 2, 0)));
+            _mm256_storeu_ps(dst, _mm256_unpacklo_ps(pa, pb));
+            _mm256_storeu_ps(dst + 8, _mm256_unpackhi_ps(pa, pb));
+        }
+
+        static void load_interleaved3(const float* src, f32x8& a, f32x8& b, f32x8& c)
+        {
+            __m128 a0, b0, c0, a1, b1, c1;
+            load_vec3x4(src, a0, b0, c0);
+            load_vec3x4(src + 12, a1, b1, c1);
+            a.v = _mm256_set_m128(a1, a0);
+            b.v = _mm256_set_m128(b1, b0);
+            c.v = _mm256_set_m128(c1, c0);
+        }
+
+        static void store_interleaved3(float* dst, f32x8 a, f32x8 b, f32x8 c)
+        {
+            store_vec3x4(dst, _mm256_castps256_ps128(a.v), _mm256_castps256_ps128(b.v), _mm256_castps256_ps128(c.v));
+            store_vec3x4(dst + 12, _mm256_extractf128_ps(a.v, 1), _mm256_extractf128_ps(b.v, 1), _mm256_extractf128_ps(c.v, 1));
+        }
+    };
+#endif
+
+#if defined(GEM_SSE)
+    struct f64x2
+    {
+        using value_type = double;
+        struct mask_type
+        {
+            __m128d v;
+            friend mask_type operator&(mask_type a, mask_type b) { return { _mm_and_pd(a.v, b.v) }; }
+            friend mask_type operator|(mask_type a, mask_type b) { return { _mm_or_pd(a.v, b.v) }; }
+        };
+        static constexpr std::size_t width = 2;
+
+        __m128d v;
+
+        static f64x2 load(const double* src) { return { _mm_loadu_pd(src) }; }
+        static f64x2 broadcast(double value) { return { _mm_set1_pd(value) }; }
+        void store(double* dst) const { _mm_storeu_pd(dst, v); }
+
+        friend f64x2 operator+(f64x2 a, f64x2 b) { return { _mm_add_pd(a.v, b.v) }; }
+        friend f64x2 operator-(f64x2 a, f64x2 b) { return { _mm_sub_pd(a.v, b.v) }; }
+        friend f64x2 operator*(f64x2 a, f64x2 b) { return { _mm_mul_pd(a.v, b.v) }; }
+        friend f64x2 operator/(f64x2 a, f64x2 b) { return { _mm_div_pd(a.v, b.v) }; }
+        friend f64x2 operator-(f64x2 a) { return { _mm_xor_pd(a.v, _mm_set1_pd(-0.0)) }; }
+
+        friend mask_type operator<(f64x2 a, f64x2 b) { return { _mm_cmplt_pd(a.v, b.v) }; }
+        friend mask_type operator<=(f64x2 a, f64x2 b) { return { _mm_cmple_pd(a.v, b.v) }; }
+        friend mask_type operator>(f64x2 a, f64x2 b) { return { _mm_cmpgt_pd(a.v, b.v) }; }
+        friend mask_type operator>=(f64x2 a, f64x2 b) { return { _mm_cmpge_pd(a.v, b.v) }; }
+
+        friend f64x2 min(f64x2 a, f64x2 b) { return { _mm_min_pd(a.v, b.v) }; }
+        friend f64x2 max(f64x2 a, f64x2 b) { return { _mm_max_pd(a.v, b.v) }; }
+        friend f64x2 sqrt(f64x2 a) { return { _mm_sqrt_pd(a.v) }; }
+        friend f64x2 abs(f64x2 a) { return { _mm_andnot_pd(_mm_set1_pd(-0.0), a.v) }; }
+        friend f64x2 select(mask_type mask, f64x2 a, f64x2 b) { return { _mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v)) }; }
+        friend int32 bits(mask_type mask) { return _mm_movemask_pd(mask.v); }
+
+        // The 64-bit exponent fields are small, their low halves go through the 32-bit conversions
+        friend f64x2 exponent(f64x2 a)
+        {
+            __m128i e = _mm_shuffle_epi32(_mm_srli_epi64(_mm_castpd_si128(a.v), 52), _MM_SHUFFLE(3, 1, 2, 0));
+            return { _mm_sub_pd(_mm_cvtepi32_pd(e), _mm_set1_pd(1023.0)) };
+        }
+        friend f64x2 mantissa(f64x2 a) { return { _mm_or_pd(_mm_and_pd(a.v, _mm_castsi128_pd(_mm_set1_epi64x(0x000FFFFFFFFFFFFFll))), _mm_set1_pd(1.0)) }; }
+        friend f64x2 pow2(f64x2 n)
+        {
+            __m128i e = _mm_add_epi32(_mm_cvtpd_epi32(n.v), _mm_set1_epi32(1023));
+            return { _mm_castsi128_pd(_mm_slli_epi64(_mm_unpacklo_epi32(e, _mm_setzero_si128()), 52)) };
+        }
+
+        // Same steps as rsqrt_bits
+        friend f64x2 rsqrt_estimate(f64x2 a)
+        {
+            f64x2 y = { _mm_castsi128_pd(_mm_sub_epi64(_mm_set1_epi64x(0x5FE6EB50C7B537A9ll), _mm_srli_epi64(_mm_castpd_si128(a.v), 1))) };
+            f64x2 half = a * broadcast(0.5), three_halves = broadcast(1.5);
+            y = y * (three_halves - half * y * y);
+            y = y * (three_halves - half * y * y);
+            return y;
+        }
+
+        // Same steps as rcp_bits
+        friend f64x2 rcp_estimate(f64x2 a)
+        {
+            __m128i sign = _mm_castpd_si128(_mm_and_pd(a.v, _mm_set1_pd(-0.0)));
+            __m128i magnitude = _mm_castpd_si128(_mm_andnot_pd(_mm_set1_pd(-0.0), a.v));
+            f64x2 y = { _mm_castsi128_pd(_mm_or_si128(_mm_sub_epi64(_mm_set1_epi64x(0x7FDE623822FC16E6ll), magnitude), sign)) };
+            f64x2 two = broadcast(2.0);
+            y = y * (two - a * y);
+            y = y * (two - a * y);
+            return y;
+        }
+
+        static void store_interleaved4(double* dst, std::size_t stride, f64x2 a, f64x2 b, f64x2 c, f64x2 d)
+        {
+            _mm_storeu_pd(dst, _mm_unpacklo_pd(a.v, b.v));
+            _mm_storeu_pd(dst + 2, _mm_unpacklo_pd(c.v, d.v));
+            _mm_storeu_pd(dst + stride, _mm_unpackhi_pd(a.v, b.v));
+            _mm_storeu_pd(dst + stride + 2, _mm_unpackhi_pd(c.v, d.v));
+        }
+
+        static void load_interleaved4(const double* src, std::size_t stride, f64x2& a, f64x2& b, f64x2& c, f64x2& d)
+        {
+            __m128d xy0 = _mm_loadu_pd(src), zw0 = _mm_loadu_pd(src + 2);
+            __m128d xy1 = _mm_loadu_pd(src + stride), zw1 = _mm_loadu_pd(src + stride + 2);
+            a.v = _mm_unpacklo_pd(xy0, xy1);
+            b.v = _mm_unpackhi_pd(xy0, xy1);
+            c.v = _mm_unpacklo_pd(zw0, zw1);
+            d.v = _mm_unpackhi_pd(zw0, zw1);
+        }
+
+        static void load_interleaved2(const double* src, f64x2& a, f64x2& b)
+        {
+            __m128d r0 = _mm_loadu_pd(src), r1 = _mm_loadu_pd(src + 2);
+            a.v = _mm_unpacklo_pd(r0, r1);
+            b.v = _mm_unpackhi_pd(r0, r1);
+        }
+
+        static void store_interleaved2(double* dst, f64x2 a, f64x2 b)
+        {
+            _mm_storeu_pd(dst, _mm_unpacklo_pd(a.v, b.v));
+            _mm_storeu_pd(dst + 2, _mm_unpackhi_pd(a.v, b.v));
+        }
+
+        static void load_interleaved3(const double* src, f64x2& a, f64x2& b, f64x2& c)
+        {
+            __m128d r0 = _mm_loadu_pd(src), r1 = _mm_loadu_pd(src + 2), r2 = _mm_loadu_pd(src + 4); // a0 b0, c0 a1, b1 c1
+            a.v = _mm_shuffle_pd(r0, r1, 0b10);
+            b.v = _mm_shuffle_pd(r0, r2, 0b01);
+            c.v = _mm_shuffle_pd(r1, r2, 0b10);
+        }
+
+        static void store_interleaved3(double* dst, f64x2 a, f64x2 b, f64x2 c)
+        {
+            _mm_storeu_pd(dst, _mm_shuffle_pd(a.v, b.v, 0b00));
+            _mm_storeu_pd(dst + 2, _mm_shuffle_pd(c.v, a.v, 0b10));
+            _mm_storeu_pd(dst + 4, _mm_shuffle_pd(b.v, c.v, 0b11));
+        }
+    };
+#endif
+
+#if defined(GEM_AVX2)
+    struct f64x4
+    {
+        using value_type = double;
+        struct mask_type
+        {
+            __m256d v;
+            friend mask_type operator&(mask_type a, mask_type b) { return { _mm256_and_pd(a.v, b.v) }; }
+            friend mask_type operator|(mask_type a, mask_type b) { return { _mm256_or_pd(a.v, b.v) }; }
+        };
+        static constexpr std::size_t width = 4;
+
+        __m256d v;
+
+        static f64x4 load(const double* src) { return { _mm256_loadu_pd(src) }; }
+        static f64x4 broadcast(double value) { return { _mm256_set1_pd(value) }; }
+        void store(double* dst) const { _mm256_storeu_pd(dst, v); }
+
+        friend f64x4 operator+(f64x4 a, f64x4 b) { return { _mm256_add_pd(a.v, b.v) }; }
+        friend f64x4 operator-(f64x4 a, f64x4 b) { return { _mm256_sub_pd(a.v, b.v) }; }
+        friend f64x4 operator*(f64x4 a, f64x4 b) { return { _mm256_mul_pd(a.v, b.v) }; }
+        friend f64x4 operator/(f64x4 a, f64x4 b) { return { _mm256_div_pd(a.v, b.v) }; }
+        friend f64x4 operator-(f64x4 a) { return { _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)) }; }
+
+        friend mask_type operator<(f64x4 a, f64x4 b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ) }; }
+        friend mask_type operator<=(f64x4 a, f64x4 b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ) }; }
+        friend mask_type operator>(f64x4 a, f64x4 b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ) }; }
+        friend mask_type operator>=(f64x4 a, f64x4 b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ) }; }
+
+        friend f64x4 min(f64x4 a, f64x4 b) { return { _mm256_min_pd(a.v, b.v) }; }
+        friend f64x4 max(f64x4 a, f64x4 b) { return { _mm256_max_pd(a.v, b.v) }; }
+        friend f64x4 sqrt(f64x4 a) { return { _mm256_sqrt_pd(a.v) }; }
+        friend f64x4 abs(f64x4 a) { return { _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v) }; }
+        friend f64x4 select(mask_type mask, f64x4 a, f64x4 b) { return { _mm256_blendv_pd(b.v, a.v, mask.v) }; }
+        friend int32 bits(mask_type mask) { return _mm256_movemask_pd(mask.v); }
+
+        // The 64-bit exponent fields are small, their low halves go through the 32-bit conversions
+        friend f64x4 exponent(f64x4 a)
+        {
+            __m256i e = _mm256_permutevar8x32_epi32(_mm256_srli_epi64(_mm256_castpd_si256(a.v), 52), _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+            return { _mm256_sub_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(e)), _mm256_set1_pd(1023.0)) };
+        }
+        friend f64x4 mantissa(f64x4 a) { return { _mm256_or_pd(_mm256_and_pd(a.v, _mm256_castsi256_pd(_mm256_set1_epi64x(0x000FFFFFFFFFFFFFll))), _mm256_set1_pd(1.0)) }; }
+        friend f64x4 pow2(f64x4 n)
+        {
+            __m128i e = _mm_add_epi32(_mm256_cvtpd_epi32(n.v), _mm_set1_epi32(1023));
+            return { _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepi32_epi64(e), 52)) };
+        }
+
+        // Same steps as rsqrt_bits
+        friend f64x4 rsqrt_estimate(f64x4 a)
+        {
+            f64x4 y = { _mm256_castsi256_pd(_mm256_sub_epi64(_mm256_set1_epi64x(0x5FE6EB50C7B537A9ll), _mm256_srli_epi64(_mm256_castpd_si256(a.v), 1))) };
+            f64x4 half = a * broadcast(0.5), three_halves = broadcast(1.5);
+            y = y * (three_halves - half * y * y);
+            y = y * (three_halves - half * y * y);
+            return y;
+        }
+
+        // Same steps as rcp_bits
+        friend f64x4 rcp_estimate(f64x4 a)
+        {
+            __m256i sign = _mm256_castpd_si256(_mm256_and_pd(a.v, _mm256_set1_pd(-0.0)));
+            __m256i magnitude = _mm256_castpd_si256(_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v));
+            f64x4 y = { _mm256_castsi256_pd(_mm256_or_si256(_mm256_sub_epi64(_mm256_set1_epi64x(0x7FDE623822FC16E6ll), magnitude), sign)) };
+            f64x4 two = broadcast(2.0);
+            y = y * (two - a * y);
+            y = y * (two - a * y);
+            return y;
+        }
+
+        static void store_interleaved4(double* dst, std::size_t stride, f64x4 a, f64x4 b, f64x4 c, f64x4 d)
+        {
+            transpose4(a.v, b.v, c.v, d.v);
+            _mm256_storeu_pd(dst, a.v);
+            _mm256_storeu_pd(dst + stride, b.v);
+            _mm256_storeu_pd(dst + 2 * stride, c.v);
+            _mm256_storeu_pd(dst + 3 * stride, d.v);
+        }
+
+        static void load_interleaved4(const double* src, std::size_t stride, f64x4& a, f64x4& b, f64x4& c, f64x4& d)
+        {
+            a.v = _mm256_loadu_pd(src);
+            b.v = _mm256_loadu_pd(src + stride);
+            c.v = _mm256_loadu_pd(src + 2 * stride);
+            d.v = _mm256_loadu_pd(src + 3 * stride);
+            transpose4(a.v, b.v, c.v, d.v);
+        }
+
+        static void load_interleaved2(const double* src, f64x4& a, f64x4& b)
+        {
+            __m256d r0 = _mm256_loadu_pd(src), r1 = _mm256_loadu_pd(src + 4);
+            a.v = _mm256_permute4x64_pd(_mm256_unpacklo_pd(r0, r1), _MM_SHUFFLE(3, 1, 2, 0));
+            b.v = _mm256_permute4x64_pd(_mm256_unpackhi_pd(r0, r1), _MM_SHUFFLE(3, 1, 2, 0));
+        }
+
+        static void store_interleaved2(double* dst, f64x4 a, f64x4 b)
+        {
+            __m256d pa = _mm256_permute4x64_pd(a.v, _MM_SHUFFLE(3, 1, 2, 0));
+            __m256d pb = _mm256_permute4x64_pd(b.v, _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_pd(dst, _mm256_unpacklo_pd(pa, pb));
+            _mm256_storeu_pd(dst + 4, _mm256_unpackhi_pd(pa, pb));
+        }
+
+        static void load_interleaved3(const double* src, f64x4& a, f64x4& b, f64x4& c)
+        {
+            load_vec3x4(src, a.v, b.v, c.v);
+        }
+
+        static void store_interleaved3(double* dst, f64x4 a, f64x4 b, f64x4 c)
+        {
+            store_vec3x4(dst, a.v, b.v, c.v);
+        }
+    };
+#endif
+
+    // Widest pack for T, float and double get the SIMD packs and every other type runs scalar
+#if defined(GEM_AVX2)
+    using f32xN = f32x8;
+    using f64xN = f64x4;
+#elif defined(GEM_SSE)
+    using f32xN = f32x4;
+    using f64xN = f64x2;
+#else
+    using f32xN = scalar<float>;
+    using f64xN = scalar<double>;
+#endif
+
+    template<typename T>
+    using pack = std::conditional_t<std::is_same_v<T, float>, f32xN, std::conditional_t<std::is_same_v<T, double>, f64xN, scalar<T>>>;
+
+    // Calls kernel.template operator()<pack<T>>(i) for each full block of pack<T>::width elements
+    // and kernel.template operator()<scalar<T>>(i) for every remaining element
+    template<typename T, typename Kernel>
+    void for_each_block(std::size_t count, Kernel&& kernel)
+    {
+        using P = pack<T>;
+        std::size_t i = 0;
+
+        if constexpr (P::width > 1)
+        {
+            for (; i + P::width <= count; i += P::width)
+                kernel.template operator()<P>(i);
+        }
+
+        for (; i < count; i++)
+            kernel.template operator()<scalar<T>>(i);
+    }
+
+}
+
+#endif // GEM_SIMD_HPP
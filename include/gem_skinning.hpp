@@ -0,0 +1,109 @@
+/*
+    made by griush
+*/
+
+#ifndef GEM_SKINNING_HPP
+#define GEM_SKINNING_HPP
+
+#include "gem_math.hpp"
+#include "gem_batch.hpp"
+#include "gem_parallel.hpp"
+#include "gem_simd.hpp"
+
+// std
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+// Skinning palettes
+// Turns a local pose (translation, rotation and scale per joint) into world and skinning matrices
+// in one linear pass over the joints, without allocating
+namespace gem {
+
+    // Local pose of a skeleton as structure of arrays views, one element per joint
+    // Rotations must be unit quaternions
+    template<typename T>
+    struct joint_pose
+    {
+        soa3<const T> translation;
+        soa4<const T> rotation;
+        soa3<const T> scale;
+    };
+
+    namespace detail {
+
+        // Local matrices of a block of joints, scale then rotation then translation:
+        // rows are (R[r][0] * sx, R[r][1] * sy, R[r][2] * sz, t[r]) with R from quaternion::to_mat4_unit
+        template<typename P, typename T>
+        void local_matrices(const joint_pose<T>& pose, std::size_t i, mat4<T>* out)
+        {
+            P x = P::load(pose.rotation.x + i), y = P::load(pose.rotation.y + i);
+            P z = P::load(pose.rotation.z + i), w = P::load(pose.rotation.w + i);
+            P sx = P::load(pose.scale.x + i), sy = P::load(pose.scale.y + i), sz = P::load(pose.scale.z + i);
+
+            P one = P::broadcast(1), two = P::broadcast(2), zero = P::broadcast(0);
+            P xx = x * x, xy = x * y, xz = x * z, xw = x * w;
+            P yy = y * y, yz = y * z, yw = y * w;
+            P zz = z * z, zw = z * w;
+
+            T* first = out->elements;
+            P::store_interleaved4(first + 0, 16, (one - two * (yy + zz)) * sx, (two * (xy - zw)) * sy, (two * (xz + yw)) * sz, P::load(pose.translation.x + i));
+            P::store_interleaved4(first + 4, 16, (two * (xy + zw)) * sx, (one - two * (xx + zz)) * sy, (two * (yz - xw)) * sz, P::load(pose.translation.y + i));
+            P::store_interleaved4(first + 8, 16, (two * (xz - yw)) * sx, (two * (yz + xw)) * sy, (one - two * (xx + yy)) * sz, P::load(pose.translation.z + i));
+            P::store_interleaved4(first + 12, 16, zero, zero, zero, one);
+        }
+
+    }
+
+    // Builds the matrix palette of a skeleton
+    // parents[i] is the parent of joint i, -1 for roots, and must be less than i (joints sorted parents first)
+    // world[i] = local[i] then world[parents[i]], skinning[i] = inverse_bind[i] then world[i]
+    // world must hold parents.size() matrices, skinning is skipped when empty
+    // Under par the local matrices and the skinning products of large skeletons are split over threads, the parent
+    // chain between them is composed on the calling thread. Results never depend on the policy
+    template<typename T>
+    void build_palette(const joint_pose<T>& pose, std::span<const int32> parents, std::type_identity_t<std::span<const mat4<T>>> inverse_bind,
+                       std::type_identity_t<std::span<mat4<T>>> world, std::type_identity_t<std::span<mat4<T>>> skinning = {},
+                       execution::policy policy = execution::par)
+    {
+        std::size_t count = parents.size();
+        std::size_t local_bytes = 10 * sizeof(T) + sizeof(mat4<T>);
+        if (detail::thread_budget(policy) > 1 && detail::worth_splitting(count, local_bytes))
+        {
+            detail::batch_blocks<T>(count, local_bytes, policy, [&]<typename P>(std::size_t i) {
+                detail::local_matrices<P>(pose, i, &world[i]);
+            });
+
+            for (std::size_t j = 0; j < count; j++)
+            {
+                if (parents[j] >= 0)
+                    world[j] = mat4<T>::product(world[j], world[parents[j]]);
+            }
+
+            if (!skinning.empty())
+            {
+                detail::batch_for(count, 3 * sizeof(mat4<T>), policy, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t j = begin; j < end; j++)
+                        skinning[j] = mat4<T>::product(inverse_bind[j], world[j]);
+                });
+            }
+            return;
+        }
+
+        // Locals are written into world a block at a time and then composed in place, a parent
+        // always comes before its children so world[parents[j]] is final when joint j is reached
+        simd::for_each_block<T>(count, [&]<typename P>(std::size_t i) {
+            detail::local_matrices<P>(pose, i, &world[i]);
+
+            for (std::size_t j = i; j < i + P::width; j++)
+            {
+                if (parents[j] >= 0)
+                    world[j] = mat4<T>::product(world[j], world[parents[j]]);
+                if (!skinning.empty())
+                    skinning[j] = mat4<T>::product(inverse_bind[j], world[j]);
+            }
+        });
+    }
+}
+
+#endif // GEM_SKINNING_HPP
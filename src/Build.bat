@@ -0,0 +1,8 @@
+@echo off
+if not exist bin\ (
+    mkdir bin 
+)
+pushd ..
+clang++ -std=c++20 -O2 -c -o src/bin/gem_math.o src/gem_math.cpp -Iinclude
+llvm-ar rcs src/bin/gem.lib src/bin/gem_math.o
+popd
@@ -0,0 +1,4 @@
+// Explicit instantiations of the gem math types for float and double
+// Link this translation unit and define GEM_EXTERN_TEMPLATES in every other one that includes gem_math.hpp
+#define GEM_IMPLEMENTATION
+#include <gem_math.hpp>
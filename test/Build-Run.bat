@@ -3,4 +3,6 @@ call Build.bat
 pause
 pushd bin
 gem-test.exe
+gem-test-properties.exe
+gem-test-properties-scalar.exe
 popd
\ No newline at end of file
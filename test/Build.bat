@@ -3,5 +3,7 @@ if not exist bin\ (
     mkdir bin 
 )
 pushd ..
-clang++ -std=c++20 -o test/bin/gem-test.exe test/main.cpp -Iinclude
+clang++ -std=c++20 -DGEM_EXTERN_TEMPLATES -o test/bin/gem-test.exe test/main.cpp src/gem_math.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -o test/bin/gem-test-properties.exe test/properties.cpp -Iinclude
+clang++ -std=c++20 -O2 -march=native -DGEM_NO_SIMD -o test/bin/gem-test-properties-scalar.exe test/properties.cpp -Iinclude
 popd
\ No newline at end of file
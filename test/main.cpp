@@ -1,13 +1,82 @@
-// define GEM_DOUBLE to get double precission vecs and mats
-// By default uses floats
+// define GEM_DOUBLE to make precision_type (the non template helpers) double
+// By default uses floats, vec3<double>, mat4<double>, ... are always double
 // #define GEM_DOUBLE
 // #define GEM_DISABLE_ALIASES
 #include <gem_math.hpp>
+#include <gem_io.hpp>
 #include <iostream>
 
 // TODO: Make proper example
 #define MATH_TEST 1
 
+// Compile time evaluation, this file does not build if any of these fail
+namespace constexpr_test {
+
+    constexpr bool near(double a, double b, double epsilon = 1e-6)
+    {
+        return (a > b ? a - b : b - a) <= epsilon;
+    }
+
+    static_assert(gem::pi<float>() == 3.14159265358979f);
+    static_assert(near(gem::to_radians(180.0f), gem::pi<float>()));
+    static_assert(gem::min(1.0f, 2.0f, -3.0f) == -3.0f);
+    static_assert(gem::clamp(5.0f, 0.0f, 1.0f) == 1.0f);
+
+    static_assert(near(gem::sqrt(2.0), 1.4142135623730951, 1e-15));
+    static_assert(near(gem::sin(gem::pi<double>() / 6.0), 0.5, 1e-15));
+    static_assert(near(gem::cos(10.0), -0.8390715290764524, 1e-14));
+
+    constexpr gem::vec3<float> v = gem::vec3<float>(1.0f, 2.0f, 3.0f) + gem::vec3<float>(1.0f);
+    static_assert(v == gem::vec3<float>(2.0f, 3.0f, 4.0f));
+    static_assert(gem::dot(v, v) == 29.0f);
+    static_assert(gem::vec3<float>(3.0f, 4.0f, 0.0f).magnitude() == 5.0f);
+    static_assert(gem::vec4<float>(0.0f, 3.0f, 0.0f, 4.0f).normalized() == gem::vec4<float>(0.0f, 0.6f, 0.0f, 0.8f));
+
+    constexpr gem::mat4<float> ortho = gem::mat4<float>::orthographic(-1.6f, 1.6f, -0.9f, 0.9f);
+    static_assert(ortho.elements[0] == 2.0f / 3.2f);
+
+    constexpr gem::mat4<float> translation = gem::mat4<float>::translate<float>({ 1.0f, 2.5f, -3.0f });
+    static_assert(translation * gem::vec4<float>(0.0f, 0.0f, 0.0f, 1.0f) == gem::vec4<float>(1.0f, 2.5f, -3.0f, 1.0f));
+    static_assert(translation.inverse() * translation == gem::mat4<float>::identiy());
+    static_assert(gem::mat4<float>::scale({ 2.0f, 3.0f, 4.0f }).determinant() == 24.0f);
+
+    constexpr gem::mat4<float> perspective = gem::mat4<float>::perspective(90.0f, 1.0f, 0.1f, 100.0f);
+    static_assert(near(perspective.elements[0], 1.0));
+
+    constexpr gem::mat4<float> rotation = gem::mat4<float>::rotation<float>({ 0.0f, 0.0f, 1.0f }, 90.0f);
+    static_assert(near(rotation.elements[0], 0.0) && near(rotation.elements[4], 1.0));
+
+    constexpr gem::affine3<float> affine = gem::affine3<float>::scale({ 2.0f, 2.0f, 2.0f }) * gem::affine3<float>::translate({ 1.0f, 0.0f, 0.0f });
+    static_assert(affine.transform_point({ 1.0f, 1.0f, 1.0f }) == gem::vec3<float>(3.0f, 2.0f, 2.0f));
+    static_assert(affine.inverse().transform_point({ 3.0f, 2.0f, 2.0f }) == gem::vec3<float>(1.0f, 1.0f, 1.0f));
+    static_assert(affine.inverse_scaled().transform_point({ 3.0f, 2.0f, 2.0f }) == gem::vec3<float>(1.0f, 1.0f, 1.0f));
+    static_assert(gem::affine3<double>::translate({ 1.0, 2.0, 3.0 }).inverse_orthonormal().transform_point({ 1.0, 2.0, 3.0 }) == gem::vec3<double>(0.0));
+
+    constexpr gem::quaternion<float> q = gem::quaternion<float>::from_euler_angles({ 0.0f, 0.0f, 0.0f });
+    static_assert(q.w == 1.0f && q.to_mat4() == gem::mat4<float>::identiy());
+
+    constexpr gem::quaternion<float> k = gem::quaternion<float>(1.0f, 0.0f, 0.0f, 0.0f) * gem::quaternion<float>(0.0f, 1.0f, 0.0f, 0.0f);
+    static_assert(k.x == 0.0f && k.y == 0.0f && k.z == 1.0f && k.w == 0.0f);
+
+    constexpr gem::mat4<float> quat_rotation = gem::quaternion<float>::RotationZ(gem::to_radians(90.0f)).to_mat4_unit();
+    static_assert(near(quat_rotation.elements[0], 0.0) && near(quat_rotation.elements[4], 1.0));
+
+    constexpr float box_hit = [] {
+        float t = -1.0f;
+        gem::raycast(gem::ray({ -5.0f, 0.5f, 0.5f }, { 2.0f, 0.1f, 0.1f }), gem::aabb{ { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } }, t);
+        return t;
+    }();
+    static_assert(box_hit == 2.0f);
+    static_assert(gem::sphere_in_capsule({ 1.0f, { 0.0f, 1.5f, 0.0f } }, { { -1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, 1.0f }));
+    static_assert(!gem::sphere_in_capsule({ 1.0f, { 0.0f, 2.5f, 0.0f } }, { { -1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, 1.0f }));
+
+    // Double precision templates compute in double end to end
+    static_assert(std::is_same_v<decltype(gem::vec3<double>().magnitude()), double>);
+    static_assert(gem::dot(gem::vec4<double>(1.0 + 1e-12, 0.0, 0.0, 0.0), gem::vec4<double>(1.0, 0.0, 0.0, 0.0)) == 1.0 + 1e-12);
+    static_assert(gem::mat4<double>::scale({ 1.0 + 1e-12, 1.0, 1.0 }).determinant() == 1.0 + 1e-12);
+
+}
+
 int main()
 {
 #if MATH_TEST
@@ -0,0 +1,454 @@
+// Property tests against a long double oracle
+// Fuzzes the mat4, quaternion and normalization functions with random inputs in float and double, computes the same
+// results in long double and reports the max and mean error in ULP of T. Fails when an error goes over its bound, so
+// any SIMD or fast path that changes results beyond the documented accuracy breaks the build in ctest
+//   gem-test-properties [--samples count] [--seed value]
+// Componentwise ULP is meaningless where a result cancels to near zero, so every property measures the error in ULP
+// of the largest magnitude its result can have (the scale, 1 for unit quaternions and vectors). The aliasing
+// properties compare in place operations against their out of place versions and must be exact
+#include <gem_math.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+    using real = long double;
+    using real_mat4 = std::array<real, 16>;
+
+    // 53 random bits, so double inputs use their whole mantissa
+    struct lcg
+    {
+        std::uint64_t state;
+        // Uniform in [-1, 1]
+        real next()
+        {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            return static_cast<real>(state >> 11) / 4503599627370496.0L - 1.0L;
+        }
+    };
+
+    // Spacing of T at value (> 0)
+    template<typename T>
+    real ulp(real value)
+    {
+        return std::ldexp(1.0L, std::ilogb(value) - (std::numeric_limits<T>::digits - 1));
+    }
+
+    // Largest error of the components in ULP of max(|reference|, scale)
+    template<typename T>
+    double error(const T* got, const real* reference, int count, real scale)
+    {
+        real worst = 0.0L;
+        for (int i = 0; i < count; i++)
+        {
+            real difference = std::abs(static_cast<real>(got[i]) - reference[i]);
+            worst = std::max(worst, difference / ulp<T>(std::max(std::abs(reference[i]), scale)));
+            if (std::isnan(got[i]) != std::isnan(reference[i]))
+                return std::numeric_limits<double>::infinity();
+        }
+        return static_cast<double>(worst);
+    }
+
+    struct property
+    {
+        std::string name;
+        double bound;
+        double max = 0.0;
+        double sum = 0.0;
+        std::size_t samples = 0;
+        std::size_t failures = 0;
+
+        void add(double ulps)
+        {
+            max = std::max(max, ulps);
+            sum += ulps;
+            samples++;
+            failures += !(ulps <= bound);
+        }
+    };
+
+    // Oracle
+
+    template<typename T>
+    real_mat4 to_real(const gem::mat4<T>& m)
+    {
+        real_mat4 r;
+        std::copy(m.elements, m.elements + 16, r.begin());
+        return r;
+    }
+
+    real_mat4 absolute(real_mat4 m)
+    {
+        for (real& e : m)
+            e = std::abs(e);
+        return m;
+    }
+
+    // Same element order as mat4::product
+    real_mat4 product(const real_mat4& a, const real_mat4& b)
+    {
+        real_mat4 r;
+        for (int y = 0; y < 4; y++)
+            for (int x = 0; x < 4; x++)
+            {
+                real sum = 0.0L;
+                for (int e = 0; e < 4; e++)
+                    sum += a[x + e * 4] * b[e + y * 4];
+                r[x + y * 4] = sum;
+            }
+        return r;
+    }
+
+    // Gauss-Jordan elimination with partial pivoting
+    real_mat4 inverse(real_mat4 m)
+    {
+        real_mat4 r{};
+        for (int i = 0; i < 4; i++)
+            r[i * 5] = 1.0L;
+
+        for (int column = 0; column < 4; column++)
+        {
+            int pivot = column;
+            for (int row = column + 1; row < 4; row++)
+                if (std::abs(m[row * 4 + column]) > std::abs(m[pivot * 4 + column]))
+                    pivot = row;
+            for (int k = 0; k < 4; k++)
+            {
+                std::swap(m[column * 4 + k], m[pivot * 4 + k]);
+                std::swap(r[column * 4 + k], r[pivot * 4 + k]);
+            }
+
+            real inv = 1.0L / m[column * 4 + column];
+            for (int k = 0; k < 4; k++)
+            {
+                m[column * 4 + k] *= inv;
+                r[column * 4 + k] *= inv;
+            }
+            for (int row = 0; row < 4; row++)
+            {
+                if (row == column)
+                    continue;
+                real factor = m[row * 4 + column];
+                for (int k = 0; k < 4; k++)
+                {
+                    m[row * 4 + k] -= factor * m[column * 4 + k];
+                    r[row * 4 + k] -= factor * r[column * 4 + k];
+                }
+            }
+        }
+        return r;
+    }
+
+    // Laplace expansion, terms holds the sum of the absolute values of the 24 products (the scale of the result)
+    real determinant(const real_mat4& m, real& terms)
+    {
+        static const int permutations[24][4] = {
+            { 0, 1, 2, 3 }, { 0, 1, 3, 2 }, { 0, 2, 1, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 0, 3, 2, 1 },
+            { 1, 0, 2, 3 }, { 1, 0, 3, 2 }, { 1, 2, 0, 3 }, { 1, 2, 3, 0 }, { 1, 3, 0, 2 }, { 1, 3, 2, 0 },
+            { 2, 0, 1, 3 }, { 2, 0, 3, 1 }, { 2, 1, 0, 3 }, { 2, 1, 3, 0 }, { 2, 3, 0, 1 }, { 2, 3, 1, 0 },
+            { 3, 0, 1, 2 }, { 3, 0, 2, 1 }, { 3, 1, 0, 2 }, { 3, 1, 2, 0 }, { 3, 2, 0, 1 }, { 3, 2, 1, 0 },
+        };
+        real det = 0.0L;
+        terms = 0.0L;
+        for (const auto& p : permutations)
+        {
+            int inversions = 0;
+            for (int i = 0; i < 4; i++)
+                for (int j = i + 1; j < 4; j++)
+                    inversions += p[i] > p[j];
+            real term = m[0 * 4 + p[0]] * m[1 * 4 + p[1]] * m[2 * 4 + p[2]] * m[3 * 4 + p[3]];
+            det += inversions % 2 == 0 ? term : -term;
+            terms += std::abs(term);
+        }
+        return det;
+    }
+
+    // Hamilton product (x, y, z, w), w real
+    std::array<real, 4> hamilton(const std::array<real, 4>& p, const std::array<real, 4>& q)
+    {
+        return { p[3] * q[0] + p[0] * q[3] + p[1] * q[2] - p[2] * q[1],
+                 p[3] * q[1] - p[0] * q[2] + p[1] * q[3] + p[2] * q[0],
+                 p[3] * q[2] + p[0] * q[1] - p[1] * q[0] + p[2] * q[3],
+                 p[3] * q[3] - p[0] * q[0] - p[1] * q[1] - p[2] * q[2] };
+    }
+
+    template<typename T>
+    std::array<real, 4> to_real(const gem::quaternion<T>& q)
+    {
+        return { q.x, q.y, q.z, q.w };
+    }
+
+    // Rotation matrix of the normalized quaternion, same layout as quaternion::to_mat4_unit
+    real_mat4 rotation(std::array<real, 4> q)
+    {
+        real length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        real x = q[0] / length, y = q[1] / length, z = q[2] / length, w = q[3] / length;
+        return { 1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w), 0,
+                 2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w), 0,
+                 2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y), 0,
+                 0, 0, 0, 1 };
+    }
+
+    std::array<real, 4> from_euler_angles(real ex, real ey, real ez)
+    {
+        real cx = std::cos(ex / 2), cy = std::cos(ey / 2), cz = std::cos(ez / 2);
+        real sx = std::sin(ex / 2), sy = std::sin(ey / 2), sz = std::sin(ez / 2);
+        return { sx * cy * cz - cx * sy * sz, cx * sy * cz + sx * cy * sz, cx * cy * sz - sx * sy * cz, cx * cy * cz + sx * sy * sz };
+    }
+
+    std::array<real, 3> to_euler_angles(const std::array<real, 4>& q)
+    {
+        real x = q[0], y = q[1], z = q[2], w = q[3];
+        real sinp = std::clamp(2 * (w * y - z * x), -1.0L, 1.0L);
+        return { std::atan2(2 * (w * x + y * z), 1 - 2 * (x * x + y * y)), std::asin(sinp), std::atan2(2 * (w * z + x * y), 1 - 2 * (y * y + z * z)) };
+    }
+
+    template<int N>
+    std::array<real, N> normalized(const std::array<real, N>& v)
+    {
+        real length = 0.0L;
+        for (real c : v)
+            length += c * c;
+        length = std::sqrt(length);
+        std::array<real, N> r;
+        for (int i = 0; i < N; i++)
+            r[i] = v[i] / length;
+        return r;
+    }
+
+    // Inputs
+
+    // translate * rotate * scale with scales in [0.5, 2], well conditioned like the transforms the library is used for
+    template<typename T>
+    gem::mat4<T> random_transform(lcg& rng)
+    {
+        gem::vec3<T> axis = gem::vec3<T>(static_cast<T>(rng.next()), static_cast<T>(rng.next()), static_cast<T>(rng.next())).normalized();
+        gem::vec3<T> scale(static_cast<T>(std::exp2(rng.next())), static_cast<T>(std::exp2(rng.next())), static_cast<T>(std::exp2(rng.next())));
+        gem::vec3<T> translation = gem::vec3<T>(static_cast<T>(rng.next()), static_cast<T>(rng.next()), static_cast<T>(rng.next())) * static_cast<T>(10);
+        return gem::mat4<T>::translate(translation) * gem::mat4<T>::rotation(axis, static_cast<T>(rng.next() * 180)) * gem::mat4<T>::scale(scale);
+    }
+
+    // Every element in [-1, 1]
+    template<typename T>
+    gem::mat4<T> random_matrix(lcg& rng)
+    {
+        gem::mat4<T> m;
+        for (T& e : m.elements)
+            e = static_cast<T>(rng.next());
+        return m;
+    }
+
+    template<typename T>
+    gem::quaternion<T> random_quaternion(lcg& rng)
+    {
+        return gem::quaternion<T>(static_cast<T>(rng.next()), static_cast<T>(rng.next()), static_cast<T>(rng.next()), static_cast<T>(rng.next()));
+    }
+
+    template<typename T>
+    std::vector<property> run(const char* type, std::size_t samples, std::uint32_t seed)
+    {
+        using gem::mat4;
+        using gem::quaternion;
+        using gem::vec2;
+        using gem::vec3;
+        using gem::vec4;
+
+        // Bounds in ULP of T, a few times the measured maximum
+        std::vector<property> properties = {
+            { "mat4 * mat4", 4 },
+            { "mat4 * vec4", 4 },
+            { "mat4::determinant", 16 },
+            { "mat4::inverse (transforms)", 16 },
+            { "mat4::multiply aliasing", 0 },
+            { "mat4::invert in place", 0 },
+            { "quaternion * quaternion", 4 },
+            { "quaternion::multiply aliasing", 0 },
+            { "quaternion::to_mat4", 8 },
+            { "quaternion::to_euler_angles", 16 },
+            { "quaternion::from_euler_angles", 8 },
+            { "quaternion::from_euler_angles_fast", 16 },
+            { "euler angles round trip", 32 },
+            { "quaternion::normalized", 4 },
+            { "vec2::normalized", 4 },
+            { "vec3::normalized", 4 },
+            { "vec4::normalized", 4 },
+            { "normalize_fast vec3", 8 },
+        };
+        for (property& p : properties)
+            p.name = std::string(type) + " " + p.name;
+        property* next = properties.data();
+
+        lcg rng{ seed };
+        for (std::size_t s = 0; s < samples; s++)
+        {
+            property* p = next;
+            mat4<T> a = s % 2 == 0 ? random_transform<T>(rng) : random_matrix<T>(rng);
+            mat4<T> b = random_matrix<T>(rng);
+            mat4<T> transform = random_transform<T>(rng);
+            real_mat4 ra = to_real(a), rb = to_real(b);
+
+            // Products, scaled by the largest possible term: sum of |a| * |b| for each element
+            {
+                mat4<T> got = a * b;
+                real_mat4 reference = product(ra, rb);
+                real_mat4 magnitude = product(absolute(ra), absolute(rb));
+                double worst = 0.0;
+                for (int i = 0; i < 16; i++)
+                    worst = std::max(worst, error(&got.elements[i], &reference[i], 1, magnitude[i]));
+                (p++)->add(worst);
+
+                vec4<T> v(static_cast<T>(rng.next()), static_cast<T>(rng.next()), static_cast<T>(rng.next()), static_cast<T>(rng.next()));
+                vec4<T> transformed = a * v;
+                real rv[4] = { v.x, v.y, v.z, v.w }, rt[4], rm[4];
+                for (int i = 0; i < 4; i++)
+                {
+                    rt[i] = rm[i] = 0.0L;
+                    for (int j = 0; j < 4; j++)
+                    {
+                        rt[i] += ra[i * 4 + j] * rv[j];
+                        rm[i] += std::abs(ra[i * 4 + j] * rv[j]);
+                    }
+                }
+                worst = 0.0;
+                for (int i = 0; i < 4; i++)
+                    worst = std::max(worst, error(&transformed.x + i, &rt[i], 1, rm[i]));
+                (p++)->add(worst);
+            }
+
+            {
+                real terms;
+                real reference = determinant(ra, terms);
+                T got = a.determinant();
+                (p++)->add(error(&got, &reference, 1, terms));
+            }
+
+            {
+                mat4<T> got = transform.inverse();
+                real_mat4 reference = inverse(to_real(transform));
+                real scale = 0.0L;
+                for (real e : reference)
+                    scale = std::max(scale, std::abs(e));
+                (p++)->add(error(got.elements, reference.data(), 16, scale));
+
+                // In place versions must equal the out of place ones exactly
+                mat4<T> squared = a;
+                squared.multiply(squared);
+                mat4<T> expected = a * a;
+                real_mat4 exact = to_real(expected);
+                (p++)->add(error(squared.elements, exact.data(), 16, std::numeric_limits<T>::min()));
+
+                mat4<T> inverted = transform;
+                inverted.invert();
+                exact = to_real(got);
+                (p++)->add(error(inverted.elements, exact.data(), 16, std::numeric_limits<T>::min()));
+            }
+
+            quaternion<T> q = random_quaternion<T>(rng), r = random_quaternion<T>(rng);
+            std::array<real, 4> rq = to_real(q), rr = to_real(r);
+            {
+                quaternion<T> got = q * r;
+                std::array<real, 4> reference = hamilton(rq, rr);
+                real scale = std::sqrt(rq[0] * rq[0] + rq[1] * rq[1] + rq[2] * rq[2] + rq[3] * rq[3]) *
+                             std::sqrt(rr[0] * rr[0] + rr[1] * rr[1] + rr[2] * rr[2] + rr[3] * rr[3]);
+                (p++)->add(error(&got.x, reference.data(), 4, scale));
+
+                quaternion<T> squared = q;
+                squared.multiply(squared);
+                std::array<real, 4> exact = to_real(q * q);
+                (p++)->add(error(&squared.x, exact.data(), 4, std::numeric_limits<T>::min()));
+            }
+
+            {
+                mat4<T> got = q.to_mat4();
+                real_mat4 reference = rotation(rq);
+                (p++)->add(error(got.elements, reference.data(), 16, 1.0L));
+            }
+
+            // Pitch within 80 degrees, asin loses the input precision near the poles
+            real ex = rng.next() * 3.14159265358979323846L, ey = rng.next() * 1.39626340159546366L, ez = rng.next() * 3.14159265358979323846L;
+            vec3<T> euler(static_cast<T>(ex), static_cast<T>(ey), static_cast<T>(ez));
+            ex = euler.x, ey = euler.y, ez = euler.z;
+            {
+                quaternion<T> unit = quaternion<T>::from_euler_angles(euler);
+                vec3<T> got = unit.to_euler_angles();
+                std::array<real, 3> reference = to_euler_angles(to_real(unit));
+                (p++)->add(error(&got.x, reference.data(), 3, 1.0L));
+
+                std::array<real, 4> rotation = from_euler_angles(ex, ey, ez);
+                (p++)->add(error(&unit.x, rotation.data(), 4, 1.0L));
+                quaternion<T> fast = quaternion<T>::from_euler_angles_fast(euler);
+                (p++)->add(error(&fast.x, rotation.data(), 4, 1.0L));
+
+                real angles[3] = { ex, ey, ez };
+                (p++)->add(error(&got.x, angles, 3, 1.0L));
+            }
+
+            {
+                quaternion<T> got = q.normalized();
+                std::array<real, 4> reference = normalized<4>(rq);
+                (p++)->add(error(&got.x, reference.data(), 4, 1.0L));
+
+                vec2<T> v2(static_cast<T>(rng.next()), static_cast<T>(rng.next()));
+                vec3<T> v3(static_cast<T>(rng.next()), static_cast<T>(rng.next()), static_cast<T>(rng.next()));
+                vec4<T> v4(static_cast<T>(rng.next()), static_cast<T>(rng.next()), static_cast<T>(rng.next()), static_cast<T>(rng.next()));
+                vec2<T> n2 = v2.normalized();
+                vec3<T> n3 = v3.normalized();
+                vec4<T> n4 = v4.normalized();
+                std::array<real, 2> r2 = normalized<2>({ v2.x, v2.y });
+                std::array<real, 3> r3 = normalized<3>({ v3.x, v3.y, v3.z });
+                std::array<real, 4> r4 = normalized<4>({ v4.x, v4.y, v4.z, v4.w });
+                (p++)->add(error(&n2.x, r2.data(), 2, 1.0L));
+                (p++)->add(error(&n3.x, r3.data(), 3, 1.0L));
+                (p++)->add(error(&n4.x, r4.data(), 4, 1.0L));
+
+                vec3<T> fast = gem::normalize_fast(v3);
+                (p++)->add(error(&fast.x, r3.data(), 3, 1.0L));
+            }
+        }
+        return properties;
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t samples = 100000;
+    std::uint32_t seed = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+            samples = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--samples count] [--seed value]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<property> properties = run<float>("float", samples, seed);
+    std::vector<property> doubles = run<double>("double", samples, seed);
+    properties.insert(properties.end(), doubles.begin(), doubles.end());
+
+    std::size_t failed = 0;
+    std::printf("%-48s %12s %12s %8s\n", "property", "max ulp", "mean ulp", "bound");
+    for (const property& p : properties)
+    {
+        std::printf("%-48s %12.3f %12.4f %8g%s\n", p.name.c_str(), p.max, p.sum / static_cast<double>(p.samples), p.bound,
+                    p.failures ? "  FAILED" : "");
+        failed += p.failures > 0;
+    }
+    std::printf("%zu samples per property, seed %u, %zu properties failed\n", samples, seed, failed);
+
+    return failed == 0 ? 0 : 1;
+}